@@ -108,6 +108,47 @@ static void ParseCommandLine(int argc, char** argv)
 			gCommandLine.msaa = 8;
 		else if (argument == "--msaa16x")
 			gCommandLine.msaa = 16;
+		else if (argument == "--gpu-skinning")
+			gCommandLine.gpuSkinning = true;
+		else if (argument == "--bench-skinning")
+			gCommandLine.benchmarkSkinning = true;
+		else if (argument == "--eager-terrain-lods")
+			gCommandLine.eagerTerrainLODs = true;
+		else if (argument == "--bake-terrain")
+			gCommandLine.bakeTerrain = true;
+		else if (argument == "--check-collision-grid")
+			gCommandLine.checkCollisionGrid = true;
+		else if (argument == "--max-fps")
+		{
+			GAME_ASSERT_MESSAGE(i + 1 < argc, "max fps unspecified");
+			gCommandLine.maxFPS = atoi(argv[i + 1]);
+			i += 1;
+		}
+		else if (argument == "--fixed-timestep")
+		{
+			GAME_ASSERT_MESSAGE(i + 1 < argc, "fixed timestep rate unspecified");
+			gCommandLine.fixedTimestepHz = atoi(argv[i + 1]);
+			i += 1;
+		}
+		else if (argument == "--no-present")
+			gCommandLine.noPresent = true;
+		else if (argument == "--record-input" || argument == "--benchmark")
+		{
+			GAME_ASSERT_MESSAGE(i + 2 < argc, "level & input file unspecified");
+			int level = atoi(argv[i + 1]);
+			GAME_ASSERT_MESSAGE(level >= 1 && level <= NUM_LEVELS, "level number out of range");
+			gCommandLine.recordedSessionLevel = level - 1;
+			if (argument == "--benchmark")
+			{
+				gCommandLine.benchmarkInputFile = argv[i + 2];
+				gCommandLine.vsync = 0;
+			}
+			else
+			{
+				gCommandLine.recordInputFile = argv[i + 2];
+			}
+			i += 2;
+		}
 		else if (argument == "--fullscreen-resolution")
 		{
 			GAME_ASSERT_MESSAGE(i + 2 < argc, "fullscreen width & height unspecified");
@@ -261,32 +261,7 @@ void UpdateEnemy(ObjNode *theNode)
 
 ObjNode *FindClosestEnemy(TQ3Point3D *pt, float *dist)
 {
-ObjNode		*thisNodePtr,*best = nil;
-float	d,minDist = 10000000;
-
-			
-	thisNodePtr = gFirstNodePtr;
-	
-	do
-	{
-		if (thisNodePtr->Slot >= SLOT_OF_DUMB)					// see if reach end of usable list
-			break;
-	
-		if (thisNodePtr->CType & CTYPE_ENEMY)
-		{
-			d = CalcQuickDistance(pt->x,pt->z,thisNodePtr->Coord.x, thisNodePtr->Coord.z);
-			if (d < minDist)
-			{
-				minDist = d;
-				best = thisNodePtr;
-			}
-		}	
-		thisNodePtr = (ObjNode *)thisNodePtr->NextNode;		// next node
-	}
-	while (thisNodePtr != nil);
-
-	*dist = minDist;
-	return(best);
+	return(FindClosestObjectOfType(pt, CTYPE_ENEMY, dist));		// uses the collision grid
 }
 
 
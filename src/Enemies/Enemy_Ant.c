@@ -56,6 +56,7 @@ static void MoveAntRock(ObjNode *theNode);
 
 #define ANT_TURN_SPEED			2.4f
 #define ANT_WALK_SPEED			400.0f
+#define ANT_SPLINE_SPEED		100.0f
 #define	ANT_KNOCKDOWN_SPEED		1400.0f					// speed ball needs to go to knock this down
 
 #define	ANT_DAMAGE				0.1f
@@ -861,6 +862,7 @@ float			x,z,placement;
 			/* ADD SPLINE OBJECT TO SPLINE OBJECT LIST */
 			
 	AddToSplineObjectList(newObj);
+	SetSplineObjectDormantSpeed(newObj, ANT_SPLINE_SPEED);
 
 
 			/* DETACH FROM LINKED LIST */
@@ -883,7 +885,7 @@ Boolean isVisible;
 
 		/* MOVE ALONG THE SPLINE */
 
-	IncreaseSplineIndex(theNode, 100);
+	IncreaseSplineIndex(theNode, ANT_SPLINE_SPEED);
 	GetObjectCoordOnSpline(theNode, &theNode->Coord.x, &theNode->Coord.z);
 
 
@@ -446,6 +446,7 @@ float			x,z,placement;
 			/* ADD SPLINE OBJECT TO SPLINE OBJECT LIST */
 			
 	AddToSplineObjectList(newObj);
+	SetSplineObjectDormantSpeed(newObj, BOXERFLY_SPLINE_SPEED);
 
 	return(true);
 }
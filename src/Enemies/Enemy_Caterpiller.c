@@ -99,6 +99,7 @@ float			x,z,placement;
 			/* ADD SPLINE OBJECT TO SPLINE OBJECT LIST */
 			
 	AddToSplineObjectList(newObj);
+	SetSplineObjectDormantSpeed(newObj, CATERPILLER_SPEED);
 	return(true);
 }
 
@@ -47,6 +47,7 @@ static void UpdateFireAnt(ObjNode *theNode, Boolean updateFlame);
 #define FIREANT_TURN_SPEED			2.4f
 #define FIREANT_WALK_SPEED			400.0f
 #define FIREANT_FLY_SPEED			200.0f
+#define FIREANT_SPLINE_SPEED		100.0f
 #define	FIREANT_KNOCKDOWN_SPEED		1400.0f					// speed ball needs to go to knock this down
 
 #define	FIREANT_DAMAGE				0.2f
@@ -555,6 +556,7 @@ float			x,z,placement;
 			/* ADD SPLINE OBJECT TO SPLINE OBJECT LIST */
 			
 	AddToSplineObjectList(newObj);
+	SetSplineObjectDormantSpeed(newObj, FIREANT_SPLINE_SPEED);
 
 	return(true);
 }
@@ -570,7 +572,7 @@ Boolean isVisible;
 
 		/* MOVE ALONG THE SPLINE */
 
-	IncreaseSplineIndex(theNode, 100);
+	IncreaseSplineIndex(theNode, FIREANT_SPLINE_SPEED);
 	GetObjectCoordOnSpline(theNode, &theNode->Coord.x, &theNode->Coord.z);
 
 
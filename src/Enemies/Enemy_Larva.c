@@ -294,6 +294,7 @@ float			x,z,placement;
 			/* ADD SPLINE OBJECT TO SPLINE OBJECT LIST */
 			
 	AddToSplineObjectList(newObj);
+	SetSplineObjectDormantSpeed(newObj, LARVA_SPLINE_SPEED);
 
 	return(true);
 }
@@ -566,6 +566,7 @@ float			x,z,placement;
 			/* ADD SPLINE OBJECT TO SPLINE OBJECT LIST */
 			
 	AddToSplineObjectList(newObj);
+	SetSplineObjectDormantSpeed(newObj, MOSQUITO_SPLINE_SPEED);
 
 	return(true);
 }
@@ -43,6 +43,7 @@ static void  MoveRoach_OnButt(ObjNode *theNode);
 
 #define ROACH_TURN_SPEED			2.4f
 #define ROACH_WALK_SPEED			300.0f
+#define ROACH_SPLINE_SPEED			60.0f
 
 #define	ROACH_FOOT_OFFSET			0.0f
 
@@ -381,6 +382,7 @@ float			x,z,placement;
 			/* ADD SPLINE OBJECT TO SPLINE OBJECT LIST */
 			
 	AddToSplineObjectList(newObj);
+	SetSplineObjectDormantSpeed(newObj, ROACH_SPLINE_SPEED);
 
 	return(true);
 }
@@ -396,7 +398,7 @@ Boolean isVisible;
 
 		/* MOVE ALONG THE SPLINE */
 
-	IncreaseSplineIndex(theNode, 60);
+	IncreaseSplineIndex(theNode, ROACH_SPLINE_SPEED);
 	GetObjectCoordOnSpline(theNode, &theNode->Coord.x, &theNode->Coord.z);
 
 
@@ -267,6 +267,7 @@ float			x,z,placement;
 			/* ADD SPLINE OBJECT TO SPLINE OBJECT LIST */
 			
 	AddToSplineObjectList(newObj);
+	SetSplineObjectDormantSpeed(newObj, SKIPPY_SPLINE_SPEED);
 
 	return(true);
 }
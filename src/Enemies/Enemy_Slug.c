@@ -30,6 +30,7 @@ static void SetSlugCollisionInfo(ObjNode *theNode);
 
 #define	SLUG_SCALE		3.0f
 #define SLUG_STRETCH	30
+#define SLUG_SPLINE_SPEED	90.0f
 
 enum
 {
@@ -100,6 +101,7 @@ float			x,z,placement;
 			/* ADD SPLINE OBJECT TO SPLINE OBJECT LIST */
 			
 	AddToSplineObjectList(newObj);
+	SetSplineObjectDormantSpeed(newObj, SLUG_SPLINE_SPEED);
 	return(true);
 }
 
@@ -131,7 +133,7 @@ Boolean isVisible;
 
 		/* MOVE ALONG THE SPLINE */
 
-	IncreaseSplineIndex(theNode, 90);
+	IncreaseSplineIndex(theNode, SLUG_SPLINE_SPEED);
 
 	GetObjectCoordOnSpline(theNode, &theNode->Coord.x, &theNode->Coord.z);
 
@@ -231,5 +233,7 @@ void SetCrawlingEnemyJointTransforms(
 		*undulatePhase -= gFramesPerSecondFrac * .8f;
 		undulateScale += sin(*undulatePhase + (float)jointNum*1.6f) * .3f;
 	}
+
+	UpdateObjectCollisionGrid(theNode);				// boxes moved
 }
 
@@ -889,6 +889,7 @@ float			x,z,placement;
 			/* ADD SPLINE OBJECT TO SPLINE OBJECT LIST */
 			
 	AddToSplineObjectList(newObj);
+	SetSplineObjectDormantSpeed(newObj, SPIDER_SPLINE_SPEED);
 
 	return(true);
 }
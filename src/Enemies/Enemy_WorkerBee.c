@@ -519,6 +519,7 @@ float			x,z,placement;
 			/* ADD SPLINE OBJECT TO SPLINE OBJECT LIST */
 			
 	AddToSplineObjectList(newObj);
+	SetSplineObjectDormantSpeed(newObj, WORKERBEE_SPLINE_SPEED);
 
 
 			/* DETACH FROM LINKED LIST */
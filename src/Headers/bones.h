@@ -8,6 +8,12 @@
 extern	void LoadBonesReferenceModel(const FSSpec	*inSpec, SkeletonDefType *skeleton);
 extern	void UpdateSkinnedGeometry(ObjNode *theNode);
 extern	void PrimeBoneData(SkeletonDefType *skeleton);
+extern	void BenchmarkSkinning(void);
+extern	void PrepareGPUSkinning(SkeletonDefType *skeleton);
+extern	void DisposeGPUSkinning(SkeletonDefType *skeleton);
+extern	Boolean IsGPUSkinningAvailable(const ObjNode *theNode);
+extern	void SubmitGPUSkinnedGeometry(ObjNode *theNode);
+extern	void SubmitCPUSkinnedGeometry(ObjNode *theNode);
 
 
 
@@ -32,3 +32,10 @@ Boolean DoSimpleBoxCollisionAgainstPlayer(float top, float bottom, float left, f
 										float front, float back);
 Boolean DoSimpleBoxCollisionAgainstObject(float top, float bottom, float left, float right,
 										float front, float back, ObjNode *targetNode);
+
+void InitCollisionGrid(void);
+void DisposeCollisionGrid(void);
+void UpdateObjectCollisionGrid(ObjNode *theNode);
+void SetObjectCollisionGridLoose(ObjNode *theNode);
+void RemoveObjectFromCollisionGrid(ObjNode *theNode);
+ObjNode *FindClosestObjectOfType(TQ3Point3D *pt, u_long cType, float *dist);
@@ -71,6 +71,7 @@ void InitPrefsFolder(bool createIt);
 OSErr MakePrefsFSSpec(const char* filename, bool createFolder, FSSpec* spec);
 
 extern	SkeletonDefType *LoadSkeletonFile(short skeletonType);
+const char* GetSkeletonName(short skeletonType);
 short OpenGameFile(const char* filename);
 extern	OSErr LoadPrefs(PrefsType *prefBlock);
 extern	void SavePrefs(PrefsType *prefs);
@@ -60,6 +60,7 @@ extern "C"
 #include "tween.h"
 #include "mousesmoothing.h"
 #include "frustumculling.h"
+#include "profiler.h"
 #include "structformats.h"
 
 extern	Boolean						gAreaCompleted;
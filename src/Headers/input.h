@@ -75,6 +75,15 @@ enum
 //============================================================================================
 
 
+#define INPUT_RECORDING_FPS		60		// recorded sessions always run at this frame time
+
+enum
+{
+	INPUT_RECORDING_OFF,
+	INPUT_RECORDING_RECORD,
+	INPUT_RECORDING_REPLAY,
+};
+
 void UpdateInput(void);
 Boolean GetNewKeyState(unsigned short key);
 Boolean GetKeyState_SDL(unsigned short sdlScanCode);
@@ -83,6 +92,8 @@ Boolean GetNewKeyState_SDL(unsigned short sdlScanCode);
 Boolean GetSkipScreenInput(void);
 Boolean IsCmdQPressed(void);
 void ResetInputState(void);
+void AgeInputState(void);
+void MuteNewKeyStates(Boolean mute);
 void UpdateKeyMap(void);
 
 Boolean FlushMouseButtonPress(void);
@@ -103,3 +114,9 @@ bool IsAnalogCursorClicked(void);
 void WarpMouseToCenter(void);
 
 void SetMacLinearMouse(int linear);
+
+void InputRecording_StartRecording(const char* path, int level);
+void InputRecording_StartReplay(const char* path, int level);
+Boolean InputRecording_DoFrame(void);
+void InputRecording_Finish(void);
+int InputRecording_GetMode(void);
@@ -57,6 +57,9 @@ extern	void CreateBaseGroup(ObjNode *theNode);
 extern	void UpdateObjectTransforms(ObjNode *theNode);
 extern	void MakeObjectTransparent(ObjNode *theNode, float transPercent);
 void AttachObject(ObjNode *theNode);
+void SaveObjectStepCoords(void);
+void ApplyObjectInterpolation(float alpha);
+void RemoveObjectInterpolation(void);
 
 extern	void MoveStaticObject(ObjNode *theNode);
 
@@ -71,6 +74,8 @@ extern	void CalcObjectBoxFromGlobal(ObjNode *theNode);
 extern	void SetObjectCollisionBounds(ObjNode *theNode, short top, short bottom, short left,
 							 short right, short front, short back);
 extern	void UpdateShadow(ObjNode *theNode);
+void UpdateShadows(void);
+void CancelShadowUpdate(ObjNode *theNode);
 extern	void CheckAllObjectsInConeOfVision(void);
 ObjNode	*AttachShadowToObject(ObjNode *theNode, float scaleX, float scaleZ, Boolean checkBlockers);
 ObjNode	*AttachGlowShadowToObject(ObjNode *theNode, float scaleX, float scaleZ, Boolean checkBlockers);
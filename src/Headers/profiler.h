@@ -0,0 +1,29 @@
+#pragma once
+
+enum
+{
+	PROFILER_ZONE_INPUT,
+	PROFILER_ZONE_MOVE_OBJECTS,
+	PROFILER_ZONE_PARTICLES,
+	PROFILER_ZONE_CAMERA,
+	PROFILER_ZONE_TERRAIN_UPDATE,
+	PROFILER_ZONE_DRAW_TERRAIN,
+	PROFILER_ZONE_DRAW_OBJECTS,
+	PROFILER_ZONE_FLUSH_QUEUE,
+	PROFILER_ZONE_SWAP,
+	NUM_PROFILER_ZONES
+};
+
+void Profiler_BeginZone(int zone);
+
+void Profiler_EndZone(int zone);
+
+void Profiler_EndFrame(void);
+
+void Profiler_GetStatsText(char* buf, size_t bufSize);
+
+void Profiler_StartTrace(void);
+
+void Profiler_StartRun(void);
+
+void Profiler_EndRun(void);
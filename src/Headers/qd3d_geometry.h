@@ -14,16 +14,6 @@ enum
 
 #define	MAX_SHARDS			80
 
-typedef struct
-{
-	TQ3Vector3D				rot,rotDelta;
-	TQ3Point3D				coord,coordDelta;
-	float					decaySpeed,scale;
-	Byte					mode;
-	TQ3Matrix4x4			matrix;
-	TQ3TriMeshData			*mesh;
-}ShardType;
-
 void QD3D_CalcObjectBoundingBox(int numMeshes, TQ3TriMeshData** meshList, TQ3BoundingBox* boundingBox);
 void QD3D_CalcObjectBoundingSphere(int numMeshes, TQ3TriMeshData** meshList, TQ3BoundingSphere* boundingSphere);
 void QD3D_ExplodeGeometry(ObjNode *theNode, float boomForce, Byte shardMode, int shardDensity, float shardDecaySpeed);
@@ -21,8 +21,19 @@ typedef struct RenderStats
 	int			triangles;
 	int			meshesPass1;
 	int			meshesPass2;
+	int			drawCalls;
+	int			stateChanges;		// GL state/binding changes actually issued
+	int			batchedMeshes;		// meshes that were merged into a shared draw call
+	int			queueCapacity;		// current size of the mesh queue storage
+	int			queueHighWaterMark;	// most meshes ever queued at once since launch
 } RenderStats;
 
+typedef struct RenderInstance
+{
+	const TQ3Matrix4x4*		transform;
+	const TQ3Point3D*		centerCoord;
+} RenderInstance;
+
 typedef struct RenderModifiers
 {
 	// Copy of the status bits from ObjNode.
@@ -137,6 +148,20 @@ void Render_UpdateTexture(
 // outTextureNames is an array with enough capacity to hold `metaFile->numTextures` texture names.
 void Render_Load3DMFTextures(TQ3MetaFile* metaFile, GLuint* outTextureNames, bool forceClampUVs);
 
+// Keeps a copy of a mesh's vertex & index data in GPU buffer objects so the renderer
+// doesn't have to stream it from client memory every frame.
+// Does nothing if buffer objects aren't available; the mesh is then drawn from client arrays.
+// Requires an OpenGL context to be active.
+void Render_UploadStaticMesh(const TQ3TriMeshData* mesh);
+
+// Call this after modifying the contents of a mesh that was passed to Render_UploadStaticMesh.
+// The GPU copy will be refreshed the next time the mesh is submitted.
+void Render_InvalidateStaticMesh(const TQ3TriMeshData* mesh);
+
+// Frees the GPU copy of a mesh. Call this BEFORE disposing of the mesh itself.
+// Does nothing if the mesh was never uploaded.
+void Render_ReleaseStaticMesh(const TQ3TriMeshData* mesh);
+
 #pragma mark -
 
 // Instructs the renderer to get ready to draw a new frame.
@@ -177,6 +202,38 @@ void Render_SubmitMesh(
 		const RenderModifiers* mods,
 		const TQ3Point3D* centerCoord);
 
+// Returns true if the skinning shader is up and running (requires --gpu-skinning).
+bool Render_IsGPUSkinningEnabled(void);
+
+// Submits bind-pose meshes of a skeleton, to be skinned by the GPU.
+// Each vertex is attached to exactly one bone: boneIndices[i] holds one bone index per vertex of bindPoseMeshes[i].
+// bonePalette holds 3 rows of 4 floats per bone (the transposed upper 4x3 part of each joint's matrix).
+// Only valid if Render_IsGPUSkinningEnabled().
+// IMPORTANT: the pointers (including the palette) must remain valid until Render_FlushQueue().
+void Render_SubmitSkinnedMeshList(
+		int numMeshes,
+		TQ3TriMeshData** bindPoseMeshes,
+		GLfloat** boneIndices,
+		int numBones,
+		const GLfloat* bonePalette,
+		const RenderModifiers* mods,
+		const TQ3Point3D* centerCoord);
+
+// Submits several copies of the same list of trimeshes, each with its own transform.
+// All instances share the same modifiers.
+// Opaque instances are queued as a single batch per mesh: GL state and vertex arrays are set up
+// once, then all instances are drawn in one glDrawElementsInstanced call, with their matrices
+// fed from a buffer object that is refilled at every flush. Without shader/instancing support,
+// each instance in the batch gets its own draw call instead. Transparent meshes fall back to
+// one Render_SubmitMeshList call per instance.
+// IMPORTANT: the pointers (including the instance array) must remain valid until Render_FlushQueue().
+void Render_SubmitMeshListInstanced(
+		int numMeshes,
+		TQ3TriMeshData** meshList,
+		const RenderModifiers* mods,
+		int numInstances,
+		const RenderInstance* instances);
+
 #pragma mark -
 
 void Render_Enter2D_Full640x480(void);
@@ -0,0 +1,68 @@
+//
+// simd4.h
+//
+// 4-wide float ops so that the SIMD kernels (skinning, particles...) read the same
+// on SSE2, NEON and plain C. Each op is a separate mul/add (no FMA) so that every
+// lane rounds exactly like the equivalent scalar code.
+//
+// SIMD4_SSE2 / SIMD4_NEON tell which backend is in use, for code that needs
+// intrinsics beyond these wrappers.
+//
+
+#pragma once
+
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define SIMD4_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#include <arm_neon.h>
+	#define SIMD4_NEON 1
+#endif
+
+#if SIMD4_SSE2
+typedef __m128 Vec4;
+static inline Vec4 V4Load(const float* p)			{ return _mm_loadu_ps(p); }
+static inline void V4Store(float* p, Vec4 v)		{ _mm_storeu_ps(p, v); }
+static inline Vec4 V4Splat(float f)					{ return _mm_set1_ps(f); }
+static inline Vec4 V4Add(Vec4 a, Vec4 b)			{ return _mm_add_ps(a, b); }
+static inline Vec4 V4Sub(Vec4 a, Vec4 b)			{ return _mm_sub_ps(a, b); }
+static inline Vec4 V4Mul(Vec4 a, Vec4 b)			{ return _mm_mul_ps(a, b); }
+static inline Vec4 V4Div(Vec4 a, Vec4 b)			{ return _mm_div_ps(a, b); }
+static inline Vec4 V4Min(Vec4 a, Vec4 b)			{ return _mm_min_ps(a, b); }
+static inline Vec4 V4Max(Vec4 a, Vec4 b)			{ return _mm_max_ps(a, b); }
+static inline Vec4 V4Sqrt(Vec4 a)					{ return _mm_sqrt_ps(a); }
+static inline float V4Sum(Vec4 a)					{ float f[4]; _mm_storeu_ps(f, a); return (f[0] + f[1]) + (f[2] + f[3]); }
+#elif SIMD4_NEON
+typedef float32x4_t Vec4;
+static inline Vec4 V4Load(const float* p)			{ return vld1q_f32(p); }
+static inline void V4Store(float* p, Vec4 v)		{ vst1q_f32(p, v); }
+static inline Vec4 V4Splat(float f)					{ return vdupq_n_f32(f); }
+static inline Vec4 V4Add(Vec4 a, Vec4 b)			{ return vaddq_f32(a, b); }
+static inline Vec4 V4Sub(Vec4 a, Vec4 b)			{ return vsubq_f32(a, b); }
+static inline Vec4 V4Mul(Vec4 a, Vec4 b)			{ return vmulq_f32(a, b); }
+static inline Vec4 V4Min(Vec4 a, Vec4 b)			{ return vminq_f32(a, b); }
+static inline Vec4 V4Max(Vec4 a, Vec4 b)			{ return vmaxq_f32(a, b); }
+static inline float V4Sum(Vec4 a)					{ float f[4]; vst1q_f32(f, a); return (f[0] + f[1]) + (f[2] + f[3]); }
+#if defined(__aarch64__) || defined(_M_ARM64)
+static inline Vec4 V4Div(Vec4 a, Vec4 b)			{ return vdivq_f32(a, b); }
+static inline Vec4 V4Sqrt(Vec4 a)					{ return vsqrtq_f32(a); }
+#else		// 32-bit NEON has no exact divide or square root
+static inline Vec4 V4Div(Vec4 a, Vec4 b)			{ float fa[4], fb[4]; vst1q_f32(fa, a); vst1q_f32(fb, b); for (int i = 0; i < 4; i++) fa[i] /= fb[i]; return vld1q_f32(fa); }
+static inline Vec4 V4Sqrt(Vec4 a)					{ float fa[4]; vst1q_f32(fa, a); for (int i = 0; i < 4; i++) fa[i] = sqrtf(fa[i]); return vld1q_f32(fa); }
+#endif
+#else
+typedef struct { float v[4]; } Vec4;
+static inline Vec4 V4Load(const float* p)			{ Vec4 r; for (int i = 0; i < 4; i++) r.v[i] = p[i]; return r; }
+static inline void V4Store(float* p, Vec4 a)		{ for (int i = 0; i < 4; i++) p[i] = a.v[i]; }
+static inline Vec4 V4Splat(float f)					{ Vec4 r; for (int i = 0; i < 4; i++) r.v[i] = f; return r; }
+static inline Vec4 V4Add(Vec4 a, Vec4 b)			{ Vec4 r; for (int i = 0; i < 4; i++) r.v[i] = a.v[i] + b.v[i]; return r; }
+static inline Vec4 V4Sub(Vec4 a, Vec4 b)			{ Vec4 r; for (int i = 0; i < 4; i++) r.v[i] = a.v[i] - b.v[i]; return r; }
+static inline Vec4 V4Mul(Vec4 a, Vec4 b)			{ Vec4 r; for (int i = 0; i < 4; i++) r.v[i] = a.v[i] * b.v[i]; return r; }
+static inline Vec4 V4Div(Vec4 a, Vec4 b)			{ Vec4 r; for (int i = 0; i < 4; i++) r.v[i] = a.v[i] / b.v[i]; return r; }
+static inline Vec4 V4Min(Vec4 a, Vec4 b)			{ Vec4 r; for (int i = 0; i < 4; i++) r.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i]; return r; }
+static inline Vec4 V4Max(Vec4 a, Vec4 b)			{ Vec4 r; for (int i = 0; i < 4; i++) r.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i]; return r; }
+static inline Vec4 V4Sqrt(Vec4 a)					{ Vec4 r; for (int i = 0; i < 4; i++) r.v[i] = sqrtf(a.v[i]); return r; }
+static inline float V4Sum(Vec4 a)					{ return (a.v[0] + a.v[1]) + (a.v[2] + a.v[3]); }
+#endif
@@ -43,6 +43,7 @@ enum
 extern	void UpdateSkeletonAnimation(ObjNode *theNode);
 extern	void SetSkeletonAnim(SkeletonObjDataType *skeleton, long animNum);
 extern	void GetModelCurrentPosition(SkeletonObjDataType *skeleton);
+extern	void RefreshSkeletonJoints(SkeletonObjDataType *skeleton);
 extern	void MorphToSkeletonAnim(SkeletonObjDataType *skeleton, long animNum, float speed);
 extern	void CalcAccelerationSplineCurve(void);
 
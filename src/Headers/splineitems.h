@@ -10,6 +10,7 @@ int GetObjectCoordOnSpline(ObjNode* theNode, float* x, float* z);
 
 Boolean IsSplineItemVisible(ObjNode *theNode);
 void AddToSplineObjectList(ObjNode *theNode);
+void SetSplineObjectDormantSpeed(ObjNode *theNode, float speed);
 void MoveSplineObjects(void);
 Boolean RemoveFromSplineObjectList(ObjNode *theNode);
 void EmptySplineObjectList(void);
@@ -18,3 +19,4 @@ float IncreaseSplineIndexZigZag(ObjNode *theNode, float speed);
 void DrawSplines(void);
 
 void PatchSplineLoop(SplineDefType* spline);
+void DisposeSplineSupertileGrid(void);
@@ -144,6 +144,29 @@ typedef struct
 }AnimEventType;
 
 
+			/* SKINNING STREAMS */
+			//
+			// Built by PrimeBoneData so that UpdateSkinnedGeometry can transform
+			// each bone's points and normals in batches of 4 (SIMD), then scatter
+			// the results into the trimeshes in one separate pass.
+			//
+
+typedef struct
+{
+	u_short		offset;							// index of this bone's first x in the SoA array; y's start at offset+stride, z's at offset+2*stride
+	u_short		count;							// # points (or normals) attached to the bone
+	u_short		stride;							// count rounded up to a multiple of 4 (padded with copies of the last element)
+}SkinSpanType;
+
+typedef struct
+{
+	Byte		whichTriMesh;					// destination trimesh
+	u_short		whichPoint;						// destination vertex in that trimesh
+	u_short		pointSrc, pointStride;			// where to read the vertex's transformed point in the SoA output
+	u_short		normalSrc, normalStride;		// where to read the vertex's transformed normal in the SoA output
+}SkinScatterType;
+
+
 			/* SKELETON INFO */
 		
 typedef struct
@@ -173,6 +196,19 @@ typedef struct
 
 	long				numTextures;
 	GLuint				*textureNames;
+
+	Byte				bonePreorder[MAX_JOINTS];		// bones in depth-first order (parents before children)
+	SkinSpanType		skinPointSpans[MAX_JOINTS];		// each bone's points in skinPointsSoA
+	SkinSpanType		skinNormalSpans[MAX_JOINTS];	// each bone's normals in skinNormalsSoA
+	long				skinPointsSoASize;
+	long				skinNormalsSoASize;
+	float				*skinPointsSoA;					// bone-relative points, grouped by bone, as xxxx...yyyy...zzzz...
+	float				*skinNormalsSoA;				// untransformed normals, grouped by bone, same layout
+	long				numSkinScatters;
+	SkinScatterType		*skinScatterList;				// one entry per trimesh vertex
+
+	TQ3TriMeshData		**gpuSkinMeshes;				// bind-pose copies of decomposedTriMeshPtrs (bone-relative points), only with GPU skinning
+	float				**gpuSkinBoneIndices;			// for each of the above, the bone that each vertex is attached to
 }SkeletonDefType;
 
 
@@ -204,6 +240,14 @@ typedef struct
 	Boolean			AnimHasStopped;					// flag gets set when anim has reached end of sequence (looping anims don't set this!)
 
 	TQ3Matrix4x4	jointTransformMatrix[MAX_JOINTS];	// holds matrix xform for each joint
+	Boolean			JointsAreStale;					// anim clock moved on but jointTransformMatrix wasn't recomputed (see RefreshSkeletonJoints)
+	Boolean			ReuseSkinnedGeometry;			// anim LOD: pose hasn't changed, draw the trimeshes skinned on a previous frame
+	Boolean			GeometryIsSkinned;				// trimeshes were skinned since the last full pose update (so they may be reused)
+	Byte			AnimLODCountdown;				// # frames until next full pose update
+	TQ3Matrix4x4	SkinnedBaseTransform;			// BaseTransformMatrix that the local trimeshes were last skinned with
+	TQ3Matrix4x4	SkinReuseTransform;				// brings trimeshes skinned with SkinnedBaseTransform to the current BaseTransformMatrix
+
+	float			gpuSkinPalette[MAX_JOINTS][3][4];	// concatenated joint matrices in shader-friendly layout (GPU skinning only)
 
 	SkeletonDefType	*skeletonDefinition;						// point to skeleton's common/shared data	
 }SkeletonObjDataType;
@@ -235,6 +279,7 @@ struct ObjNode
 	struct ObjNode	*ChainHead;			// a chain's head (link back to 1st obj in chain)
 
 	struct	ObjNode	*ShadowNode;		// ptr to node's shadow (if any)
+	bool			ShadowUpdatePending;	// queued for UpdateShadows
 
 	uint16_t		Slot;				// sort value
 	Byte			Genre;				// obj genre (skeleton, display_group, custom, event)
@@ -248,6 +293,9 @@ struct ObjNode
 	TQ3Point3D		Coord;				// coord of object
 	TQ3Point3D		OldCoord;			// coord @ previous frame
 	TQ3Point3D		InitCoord;			// coord where was created
+	TQ3Point3D		StepStartCoord;		// coord at start of last fixed simulation step (for render interpolation)
+	TQ3Vector3D		InterpSavedTranslation;	// BaseTransformMatrix translation while an interpolated one is being drawn
+	bool			InterpApplied;
 	TQ3Vector3D		Delta;				// delta velocity of object
 	TQ3Vector3D		Rot;				// rotation of object
 	TQ3Vector2D		AccelVector;		// current acceleration vector
@@ -262,6 +310,10 @@ struct ObjNode
 	CollisionBoxType	*CollisionBoxes;// Ptr to array of collision rectangles
 	CollisionBoxType	*OldCollisionBoxes;
 	short			LeftOff,RightOff,FrontOff,BackOff,TopOff,BottomOff;		// box offsets (only used by simple objects with 1 collision box)
+	int32_t			CollisionGridCell;	// cell in collision broadphase grid (-1 = not in grid)
+	struct ObjNode	*CollisionGridPrev;	// links in that cell's list
+	struct ObjNode	*CollisionGridNext;
+	uint32_t		AttachSerial;		// order of attachment among nodes in the same slot
 	
 	struct ObjNode	*MPlatform;			// current moving platform
 		
@@ -296,6 +348,7 @@ struct ObjNode
 	u_char				SplineNum;				// which spline this spline item is on
 	float				SplinePlacement;		// 0.0->.9999 for placement on spline
 	short				SplineObjectIndex;		// index into gSplineObjectList of this ObjNode
+	float				SplineDormantSpeed;		// if !=0, spline speed to use instead of SplineMoveCall while nowhere near the player
 
 	short				EffectChannel;			// effect sound channel index (-1 = none)
 	int32_t				ParticleGroup;
@@ -342,4 +395,15 @@ typedef struct
 	int		fullscreenRefreshRate;
 	int		msaa;
 	int		vsync;
+	bool	gpuSkinning;
+	bool	benchmarkSkinning;
+	bool	eagerTerrainLODs;
+	bool	bakeTerrain;
+	bool	checkCollisionGrid;
+	int		fixedTimestepHz;
+	int		maxFPS;
+	int		recordedSessionLevel;
+	const char*	recordInputFile;
+	const char*	benchmarkInputFile;
+	bool	noPresent;
 } CommandLineOptions;
@@ -24,7 +24,8 @@ enum
 enum
 {
 	SUPERTILE_MODE_FREE,
-	SUPERTILE_MODE_USED
+	SUPERTILE_MODE_USED,
+	SUPERTILE_MODE_PREFETCHED								// built ahead of scrolling by the builder thread, not in scroll buffer yet
 };
 
 		/* SUPER TILE TEXTURE LODs */
@@ -80,7 +81,8 @@ enum
 
 #define	SUPERTILE_DIST_WIDE		(SUPERTILE_ACTIVE_RANGE*2)
 #define	SUPERTILE_DIST_DEEP		(SUPERTILE_ACTIVE_RANGE*2)
-#define	MAX_SUPERTILES			(MAX_SUPERTILE_ACTIVE_RANGE*2 * MAX_SUPERTILE_ACTIVE_RANGE*2)
+#define	SUPERTILE_PREFETCH_SLOTS	(SUPERTILE_DIST_WIDE + SUPERTILE_DIST_DEEP + 1)	// extra supertiles for the leading row + column (+ corner) built ahead of scrolling
+#define	MAX_SUPERTILES			(MAX_SUPERTILE_ACTIVE_RANGE*2 * MAX_SUPERTILE_ACTIVE_RANGE*2 + MAX_SUPERTILE_ACTIVE_RANGE*4 + 1)
 
 
 #define	MAX_TERRAIN_TILES		((300*3)+1)										// 10x15 * 3pages + 1 blank/black
@@ -102,10 +104,14 @@ struct SuperTileMemoryType
 	Byte				mode;									// free, used, etc.
 	Byte				hasLOD[MAX_LODS];						// flag set when LOD exists
 	Byte				hiccupTimer;							// timer to delay drawing to avoid hiccup of texture upload
+	Byte				prefetchDone;							// builder thread is done with this supertile (guarded by job mutex)
+	long				tileCol,tileRow;						// map coords of back/left tile
 	TQ3Point3D			coord[MAX_LAYERS];						// world coords of supertile center (y for floor & ceiling)
 	long				left,back;								// integer coords of back/left corner
 	uint32_t			glTextureName[MAX_LAYERS][MAX_LODS];	// OpenGL texture name for floor & ceiling at all LODs
 	uint16_t*			textureData[MAX_LAYERS][MAX_LODS];		// pixel data for floor & ceiling at all LODs
+	u_short				atlasCol[MAX_LAYERS];					// cell in supertile texture atlas (floor & ceiling)
+	u_short				atlasRow[MAX_LAYERS];
 	TQ3TriMeshData*		triMeshDataPtrs[MAX_LAYERS];			// trimesh's data for the supertile (floor & ceiling)
 	float				radius[MAX_LAYERS];						// radius of this supertile (floor & ceiling)
 };
@@ -164,6 +170,7 @@ extern	void GetSuperTileInfo(long x, long z, long *superCol, long *superRow, lon
 extern	void InitTerrainManager(void);
 extern	void ClearScrollBuffer(void);
 float	GetTerrainHeightAtCoord(float x, float z, long layer);
+void GetTerrainHeightsAtCoords(const float *x, const float *z, float *outY, TQ3Vector3D *outNormals, int count, long layer);
 void InitCurrentScrollSettings(void);
 
 
@@ -185,6 +192,13 @@ extern	void DoMyTerrainUpdate(void);
 void CalcTileNormals(long layer, long row, long col, TQ3Vector3D *n1, TQ3Vector3D *n2);
 
 void CalculateSplitModeMatrix(void);
+void BuildTerrainPlaneCache(void);
+void DisposeTerrainPlaneCache(void);
+
+void BuildTileTextureCache(void);
+void LoadOrBakeTerrain(const FSSpec *terrainSpec);
+void DisposeTileTextureCache(void);
+void GetTileTextureCacheStats(int *numImages, int *numKB, float *buildMS, float *savedMS);
 
 void DoItemShadowCasting(void);
 
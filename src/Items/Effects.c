@@ -12,6 +12,8 @@
 
 #include "game.h"
 
+#include "simd4.h"
+
 
 /****************************/
 /*    PROTOTYPES            */
@@ -31,12 +33,19 @@ static void MoveRipple(ObjNode *theNode);
 #define	NUM_PARTICLE_TEXTURES	8
 
 _Static_assert(MAX_PARTICLES <= 255, "rewrite ParticleGroupType to support > 255 particles");
+_Static_assert(MAX_PARTICLES % 4 == 0, "particle arrays must hold whole 4-wide vectors");
 _Static_assert(MAX_PARTICLE_GROUPS <= 255, "particle group IDs currently assume the group index will fit in 8 bits");
 
+		/* PARTICLE GROUP */
+		//
+		// Particles are stored as structure-of-arrays, packed at the front of the arrays:
+		// a dead particle is replaced by the last one, so the live ones are always 0...numParticles-1.
+		//
+
 typedef struct
 {
 	int32_t			magicNum;
-	Pool			*pool;
+	int				numParticles;
 	Byte			type;
 	uint8_t			flags;
 	Byte			particleTextureNum;
@@ -46,10 +55,14 @@ typedef struct
 	float			decayRate;			// shrink speed
 	float			fadeRate;
 	
-	float			alpha[MAX_PARTICLES];
+	float			x[MAX_PARTICLES];
+	float			y[MAX_PARTICLES];
+	float			z[MAX_PARTICLES];
+	float			dx[MAX_PARTICLES];
+	float			dy[MAX_PARTICLES];
+	float			dz[MAX_PARTICLES];
 	float			scale[MAX_PARTICLES];
-	TQ3Point3D		coord[MAX_PARTICLES];
-	TQ3Vector3D		delta[MAX_PARTICLES];
+	float			alpha[MAX_PARTICLES];
 	TQ3TriMeshData	*mesh;
 }ParticleGroupType;
 
@@ -68,8 +81,6 @@ static int32_t				gParticleGroupMagicAllocator = 0;
 static GLuint				gParticleTextureNames[NUM_PARTICLE_TEXTURES];
 static bool					gParticleTexturesLoaded = false;
 
-static float	gGravitoidDistBuffer[MAX_PARTICLES][MAX_PARTICLES];
-
 static RenderModifiers kParticleGroupRenderingMods;
 
 
@@ -143,8 +154,6 @@ static void InitParticleGroup(ParticleGroupType* pg)
 
 	memset(pg, 0, sizeof(ParticleGroupType));
 
-	pg->pool = Pool_New(MAX_PARTICLES);
-
 			/* INIT THE GROUP'S TRIMESH STRUCTURE */
 
 	pg->mesh = Q3TriMeshData_New(MAX_PARTICLES*2, MAX_PARTICLES*4, kQ3TriMeshDataFeatureVertexUVs | kQ3TriMeshDataFeatureVertexColors);
@@ -234,10 +243,6 @@ void DeleteAllParticleGroups(void)
 				Q3TriMeshData_Dispose(gParticleGroups[i].mesh);
 				gParticleGroups[i].mesh = nil;
 			}
-
-			// Free particle pool
-			Pool_Free(gParticleGroups[i].pool);
-			gParticleGroups[i].pool = NULL;
 		}
 
 		// Free particle group pool
@@ -295,6 +300,7 @@ int32_t NewParticleGroup(
 
 			/* INITIALIZE THE GROUP */
 
+	pg->numParticles = 0;
 	pg->type = type;
 	pg->flags = flags;
 	pg->gravity = gravity;
@@ -345,257 +351,366 @@ bool AddParticleToGroup(int32_t groupID, TQ3Point3D *where, TQ3Vector3D *delta,
 	}
 
 
-			/* SCAN FOR FREE SLOT */
-
-	int p = Pool_AllocateIndex(pg->pool);
-
 			/* NO FREE SLOTS */
 
-	if (p < 0)
+	if (pg->numParticles >= MAX_PARTICLES)
 		return true;
 
 			/* INIT PARAMETERS */
 
-	pg->alpha[p] = alpha;
+	int p = pg->numParticles++;
+
+	pg->x[p] = where->x;
+	pg->y[p] = where->y;
+	pg->z[p] = where->z;
+	pg->dx[p] = delta->x;
+	pg->dy[p] = delta->y;
+	pg->dz[p] = delta->z;
 	pg->scale[p] = scale;
-	pg->coord[p] = *where;
-	pg->delta[p] = *delta;
+	pg->alpha[p] = alpha;
 
 	return(false);
 }
 
 
-/****************** MOVE PARTICLE GROUPS *********************/
+/******************** PARTICLE KERNELS *********************/
+//
+// The particle arrays hold whole vectors (MAX_PARTICLES is a multiple of 4),
+// so these run up to numParticles rounded up to 4. Lanes past numParticles are scratch.
+//
 
-void MoveParticleGroups(void)
+static inline int RoundUpToVectors(int n)
 {
-Byte		flags;
-float		fps = gFramesPerSecondFrac;
-float		y,baseScale,oneOverBaseScaleSquared,gravity;
-float		decayRate,magnetism,fadeRate;
-TQ3Point3D	*coord;
-TQ3Vector3D	*delta;
+	return (n + 3) & ~3;
+}
 
-	if (!gParticleGroupsInitialized)
-		return;
+static void ParticleKernel_AddConstant(float* a, float c, int n)			// a += c
+{
+	Vec4 vc = V4Splat(c);
 
-	int g = Pool_First(gParticleGroupPool);
-	while (g >= 0)
+	for (int i = 0; i < n; i += 4)
+		V4Store(a + i, V4Add(V4Load(a + i), vc));
+}
+
+static void ParticleKernel_AddScaled(float* a, const float* b, float s, int n)	// a += b * s
+{
+	Vec4 vs = V4Splat(s);
+
+	for (int i = 0; i < n; i += 4)
+		V4Store(a + i, V4Add(V4Load(a + i), V4Mul(V4Load(b + i), vs)));
+}
+
+
+/******************** PARTICLE KERNEL: GRAVITOID PULL *********************/
+//
+// Every particle has gravity pull on every other particle, falling off with 1/dist^2
+// (capped at 1/baseScale^2 so they don't slingshot each other when they get really close).
+// Returns the sum of the pulls on particle p from where the others are right now.
+//
+// The particle's own lane comes out as a zero pull, so there's no need to skip it.
+//
+
+static void ParticleKernel_GravitoidPull(const ParticleGroupType* pg, int p, float* outX, float* outY, float* outZ)
+{
+	const int	n = pg->numParticles;
+	const float	maxPull = 1.0f / (pg->baseScale * pg->baseScale);
+	const float	px = pg->x[p];
+	const float	py = pg->y[p];
+	const float	pz = pg->z[p];
+	float		sumX, sumY, sumZ;
+	int			q = 0;
+
+			/* 4 AT A TIME */
+
+	Vec4 vpx = V4Splat(px), vpy = V4Splat(py), vpz = V4Splat(pz);
+	Vec4 vMaxPull = V4Splat(maxPull);
+	Vec4 vOne = V4Splat(1.0f);
+	Vec4 vFltMin = V4Splat(FLT_MIN);
+	Vec4 accX = V4Splat(0), accY = V4Splat(0), accZ = V4Splat(0);
+
+	for (; q + 4 <= n; q += 4)
 	{
-		GAME_ASSERT(Pool_IsUsed(gParticleGroupPool, g));
+		Vec4 dx = V4Sub(V4Load(pg->x + q), vpx);						// vector to other particle
+		Vec4 dy = V4Sub(V4Load(pg->y + q), vpy);
+		Vec4 dz = V4Sub(V4Load(pg->z + q), vpz);
 
-		ParticleGroupType* pg = &gParticleGroups[g];
+		Vec4 dist = V4Sqrt(V4Add(V4Add(V4Mul(dx, dx), V4Mul(dy, dy)), V4Mul(dz, dz)));
+		Vec4 pull = V4Min(V4Div(vOne, V4Mul(dist, dist)), vMaxPull);	// 1/dist^2, capped (dist 0 gives the cap, but a zero vector below)
+		Vec4 invMag = V4Div(vOne, V4Add(dist, vFltMin));				// normalize like FastNormalizeVector
 
-		int nextGroupIndex = Pool_Next(gParticleGroupPool, g);
+		accX = V4Add(accX, V4Mul(V4Mul(dx, invMag), pull));
+		accY = V4Add(accY, V4Mul(V4Mul(dy, invMag), pull));
+		accZ = V4Add(accZ, V4Mul(V4Mul(dz, invMag), pull));
+	}
 
-		baseScale 	= pg->baseScale;					// get base scale
-		oneOverBaseScaleSquared = 1.0f/(baseScale*baseScale);
-		gravity 	= pg->gravity;						// get gravity
-		decayRate 	= pg->decayRate;					// get decay rate
-		fadeRate 	= pg->fadeRate;						// get fade rate
-		magnetism 	= pg->magnetism;					// get magnetism
-		flags 		= pg->flags;
-
-		int n = 0;										// init counter
-		int p = Pool_First(pg->pool);
-		while (p >= 0)
-		{
-			GAME_ASSERT(Pool_IsUsed(pg->pool, p));
-			int nextParticleIndex = Pool_Next(pg->pool, p);
+	sumX = V4Sum(accX);
+	sumY = V4Sum(accY);
+	sumZ = V4Sum(accZ);
 
-			n++;										// inc counter
-			delta = &pg->delta[p];						// get ptr to deltas
-			coord = &pg->coord[p];						// get ptr to coords
+			/* LEFTOVERS */
 
-							/* ADD GRAVITY */
+	for (; q < n; q++)
+	{
+		float dx = pg->x[q] - px;
+		float dy = pg->y[q] - py;
+		float dz = pg->z[q] - pz;
+
+		float dist = sqrtf(dx*dx + dy*dy + dz*dz);
+		float pull = 1.0f / (dist*dist);
+		if (pull > maxPull)
+			pull = maxPull;
+		float invMag = 1.0f / (dist + FLT_MIN);
+
+		sumX += (dx * invMag) * pull;
+		sumY += (dy * invMag) * pull;
+		sumZ += (dz * invMag) * pull;
+	}
 
-			delta->y -= gravity * fps;									// add gravity
+	*outX = sumX;
+	*outY = sumY;
+	*outZ = sumZ;
+}
 
-			switch (pg->type)
-			{
-							/* FALLING SPARKS */
-
-				case	PARTICLE_TYPE_FALLINGSPARKS:
-						coord->x += delta->x * fps;						// move it
-						coord->y += delta->y * fps;
-						coord->z += delta->z * fps;
-						break;
-
-
-							/* GRAVITOIDS */
-							//
-							// Every particle has gravity pull on other particle
-							//
-
-				case	PARTICLE_TYPE_GRAVITOIDS:
-						for (int q = Pool_Last(pg->pool); q >= 0; q = Pool_Prev(pg->pool, q))
-						{
-							GAME_ASSERT(Pool_IsUsed(pg->pool, q));
-
-							float		dist;
-							float		x,z;
-							TQ3Vector3D	v;
-
-							if (p == q)									// don't check against self
-								continue;
-
-							x = pg->coord[q].x;
-							y = pg->coord[q].y;
-							z = pg->coord[q].z;
-
-									/* calc 1/(dist2) */
-
-							if (p < q)									// see if calc or get from buffer
-							{
-								float dx = coord->x - x;
-								float dy = coord->y - y;
-								float dz = coord->z - z;
-								dist = sqrtf(dx*dx + dy*dy + dz*dz);
-								if (dist != 0.0f)
-									dist = 1.0f / (dist*dist);
-
-								if (dist > oneOverBaseScaleSquared)		// adjust if closer than radius
-									dist = oneOverBaseScaleSquared;
-
-								gGravitoidDistBuffer[p][q] = dist;		// remember it
-							}
-							else
-							{
-								dist = gGravitoidDistBuffer[q][p];		// use from buffer
-							}
-
-										/* calc vector to particle */
-
-							if (dist != 0.0f)
-							{
-								x = x - coord->x;
-								y = y - coord->y;
-								z = z - coord->z;
-								FastNormalizeVector(x, y, z, &v);
-							}
-							else
-							{
-								v.x = v.y = v.z = 0;
-							}
-
-							delta->x += v.x * (dist * magnetism * fps);		// apply gravity to particle
-							delta->y += v.y * (dist * magnetism * fps);
-							delta->z += v.z * (dist * magnetism * fps);
-						}
-
-						coord->x += delta->x * fps;						// move it
-						coord->y += delta->y * fps;
-						coord->z += delta->z * fps;
-						break;
-			}
 
+/******************** DELETE PARTICLE *********************/
+//
+// The particle is replaced by the last particle in the group.
+//
 
-			if (gFloorMap)					// only do these checks if there's a terrain floor
-			{
-					/*****************/
-					/* SEE IF BOUNCE */
-					/*****************/
+static void DeleteParticle(ParticleGroupType* pg, int p)
+{
+	int n = --pg->numParticles;
+
+	pg->x[p]		= pg->x[n];
+	pg->y[p]		= pg->y[n];
+	pg->z[p]		= pg->z[n];
+	pg->dx[p]		= pg->dx[n];
+	pg->dy[p]		= pg->dy[n];
+	pg->dz[p]		= pg->dz[n];
+	pg->scale[p]	= pg->scale[n];
+	pg->alpha[p]	= pg->alpha[n];
+}
+
+
+/******************** IS PARTICLE GONE *********************/
+
+static inline bool IsParticleGone(const ParticleGroupType* pg, int p)
+{
+	return pg->scale[p] <= 0.0f || pg->alpha[p] <= 0.0f;
+}
 
-				if (flags & PARTICLE_FLAGS_BOUNCE)
+
+/******************** COLLIDE PARTICLE *********************/
+//
+// Bounces the particle off the floor & ceiling and hurts the player, as per the group's flags.
+//
+
+static void CollideParticle(ParticleGroupType* pg, int p)
+{
+Byte	flags = pg->flags;
+float	y;
+
+	if (gFloorMap)					// only do these checks if there's a terrain floor
+	{
+			/*****************/
+			/* SEE IF BOUNCE */
+			/*****************/
+
+		if (flags & PARTICLE_FLAGS_BOUNCE)
+		{
+			if (pg->dy[p] < 0.0f)							// if moving down, see if hit floor
+			{
+				y = GetTerrainHeightAtCoord(pg->x[p], pg->z[p], FLOOR)+10.0f;	// see if hit floor
+				if (pg->y[p] < y)
 				{
-					if (delta->y < 0.0f)							// if moving down, see if hit floor
-					{
-						y = GetTerrainHeightAtCoord(coord->x, coord->z, FLOOR)+10.0f;	// see if hit floor
-						if (coord->y < y)
-						{
-							coord->y = y;
-							delta->y *= -.4f;
-
-							delta->x += gRecentTerrainNormal[FLOOR].x * 300.0f;	// reflect off of surface
-							delta->z += gRecentTerrainNormal[FLOOR].z * 300.0f;
-						}
-					}
+					pg->y[p] = y;
+					pg->dy[p] *= -.4f;
+
+					pg->dx[p] += gRecentTerrainNormal[FLOOR].x * 300.0f;	// reflect off of surface
+					pg->dz[p] += gRecentTerrainNormal[FLOOR].z * 300.0f;
 				}
+			}
+		}
 
 
-					/**********************/
-					/* SEE IF HURT PLAYER */
-					/**********************/
+			/**********************/
+			/* SEE IF HURT PLAYER */
+			/**********************/
 
-				if (flags & PARTICLE_FLAGS_HURTPLAYER)
+		if (flags & PARTICLE_FLAGS_HURTPLAYER)
+		{
+			if (DoSimpleBoxCollisionAgainstPlayer(pg->y[p]+30.0f,pg->y[p]-30.0f,
+												pg->x[p]-30.0f, pg->x[p]+30.0f,
+												pg->z[p]+30.0f, pg->z[p]-30.0f))
+			{
+				if (flags & PARTICLE_FLAGS_HURTPLAYERBAD)					// hurt really bad!
+				{
+					PlayerGotHurt(nil, 1.0, false, false, false,.5);		// hurt enough to kill!
+					if (gPlayerGotKilledFlag)
+						gTorchPlayer = true;
+				}
+				else														// normal hurt
 				{
-					if (DoSimpleBoxCollisionAgainstPlayer(coord->y+30.0f,coord->y-30.0f,
-														coord->x-30.0f, coord->x+30.0f,
-														coord->z+30.0f, coord->z-30.0f))
-					{
-						if (flags & PARTICLE_FLAGS_HURTPLAYERBAD)					// hurt really bad!
-						{
-							PlayerGotHurt(nil, 1.0, false, false, false,.5);		// hurt enough to kill!
-							if (gPlayerGotKilledFlag)
-								gTorchPlayer = true;
-						}
-						else														// normal hurt
-						{
-							if (gPlayerMode == PLAYER_MODE_BALL)					// ball gets hurt less
-								PlayerGotHurt(nil, .1, false, false, false,1.2);
-							else
-								PlayerGotHurt(nil, .15, false, false, false,1.2);
-						}
-					}
+					if (gPlayerMode == PLAYER_MODE_BALL)					// ball gets hurt less
+						PlayerGotHurt(nil, .1, false, false, false,1.2);
+					else
+						PlayerGotHurt(nil, .15, false, false, false,1.2);
 				}
 			}
+		}
+	}
 
-			if (gCeilingMap)
-			{
-						/* SEE IF HIT CEILING */
+	if (gCeilingMap)
+	{
+				/* SEE IF HIT CEILING */
 
-				if (flags & PARTICLE_FLAGS_ROOF)
+		if (flags & PARTICLE_FLAGS_ROOF)
+		{
+			if (pg->dy[p] > 0.0f)							// if moving up, see if hit ceiling
+			{
+				y = GetTerrainHeightAtCoord(pg->x[p], pg->z[p], CEILING)-10.0f;	// see if hit ceiling
+				if (pg->y[p] > y)
 				{
-					if (delta->y > 0.0f)							// if moving up, see if hit ceiling
-					{
-						y = GetTerrainHeightAtCoord(coord->x, coord->z, CEILING)-10.0f;	// see if hit ceiling
-						if (coord->y > y)
-						{
-							coord->y = y;
-							delta->x += gRecentTerrainNormal[FLOOR].x * 1000.0f;	// reflect off of surface
-							delta->z += gRecentTerrainNormal[FLOOR].z * 1000.0f;
-						}
-					}
+					pg->y[p] = y;
+					pg->dx[p] += gRecentTerrainNormal[FLOOR].x * 1000.0f;	// reflect off of surface
+					pg->dz[p] += gRecentTerrainNormal[FLOOR].z * 1000.0f;
 				}
 			}
+		}
+	}
+}
 
-				/***************/
-				/* SEE IF GONE */
-				/***************/
 
-					/* DO SCALE */
+/****************** MOVE FALLING SPARKS *********************/
+//
+// The particles don't affect each other, so each step is done for the whole group at once.
+//
 
-			pg->scale[p] -= decayRate * fps;			// shrink it
-			if (pg->scale[p] <= 0.0f)					// see if gone
-				goto deleteParticle;
+static void MoveFallingSparks(ParticleGroupType* pg, float fps)
+{
+	const int n = pg->numParticles;
+	const int nVec = RoundUpToVectors(n);
+	const Byte flags = pg->flags;
 
-					/* DO FADE */
+					/* ADD GRAVITY */
 
-			pg->alpha[p] -= fadeRate * fps;				// fade it
-			if (pg->alpha[p] <= 0.0f)					// see if gone
-				goto deleteParticle;
+	ParticleKernel_AddConstant(pg->dy, -(pg->gravity * fps), nVec);
 
+					/* MOVE THEM */
 
-			goto nextParticle;
+	ParticleKernel_AddScaled(pg->x, pg->dx, fps, nVec);
+	ParticleKernel_AddScaled(pg->y, pg->dy, fps, nVec);
+	ParticleKernel_AddScaled(pg->z, pg->dz, fps, nVec);
 
-					/* IF GONE RELEASE INDEX */
+	if ((gFloorMap && (flags & (PARTICLE_FLAGS_BOUNCE | PARTICLE_FLAGS_HURTPLAYER)))
+		|| (gCeilingMap && (flags & PARTICLE_FLAGS_ROOF)))
+	{
+		for (int p = 0; p < n; p++)
+			CollideParticle(pg, p);
+	}
 
-deleteParticle:
-			Pool_ReleaseIndex(pg->pool, p);
+			/***************/
+			/* SEE IF GONE */
+			/***************/
 
+	ParticleKernel_AddConstant(pg->scale, -(pg->decayRate * fps), nVec);	// shrink them
+	ParticleKernel_AddConstant(pg->alpha, -(pg->fadeRate * fps), nVec);	// fade them
 
-nextParticle:
-			p = nextParticleIndex;
-		}
+	for (int p = 0; p < pg->numParticles; )
+	{
+		if (IsParticleGone(pg, p))
+			DeleteParticle(pg, p);			// p now holds the last particle, so look at it again
+		else
+			p++;
+	}
+}
+
+
+/****************** MOVE GRAVITOIDS *********************/
+//
+// Like the original, each particle is moved all the way (and deleted if it's gone)
+// before the next one is pulled towards the others, so later particles feel the
+// pull from where earlier ones have already moved to, and dead ones stop pulling at once.
+// Only the pull sum over the other particles is vectorized.
+//
+
+static void MoveGravitoids(ParticleGroupType* pg, float fps)
+{
+	const float gravity = pg->gravity * fps;
+	const float k = pg->magnetism * fps;
+	const float decay = pg->decayRate * fps;
+	const float fade = pg->fadeRate * fps;
+
+	for (int p = 0; p < pg->numParticles; )
+	{
+		float pullX, pullY, pullZ;
 
+		pg->dy[p] -= gravity;										// add gravity
+
+		ParticleKernel_GravitoidPull(pg, p, &pullX, &pullY, &pullZ);
+		pg->dx[p] += pullX * k;										// apply pull of other particles
+		pg->dy[p] += pullY * k;
+		pg->dz[p] += pullZ * k;
+
+		pg->x[p] += pg->dx[p] * fps;								// move it
+		pg->y[p] += pg->dy[p] * fps;
+		pg->z[p] += pg->dz[p] * fps;
+
+		CollideParticle(pg, p);
+
+		pg->scale[p] -= decay;										// shrink it
+		pg->alpha[p] -= fade;										// fade it
+
+		if (IsParticleGone(pg, p))
+			DeleteParticle(pg, p);			// p now holds the last particle, which hasn't moved yet
+		else
+			p++;
+	}
+}
+
+
+/****************** MOVE PARTICLE GROUPS *********************/
+
+void MoveParticleGroups(void)
+{
+float		fps = gFramesPerSecondFrac;
+
+	if (!gParticleGroupsInitialized)
+		return;
+
+	int g = Pool_First(gParticleGroupPool);
+	while (g >= 0)
+	{
+		GAME_ASSERT(Pool_IsUsed(gParticleGroupPool, g));
+
+		ParticleGroupType* pg = &gParticleGroups[g];
+
+		int nextGroupIndex = Pool_Next(gParticleGroupPool, g);
 
 				/* SEE IF GROUP WAS EMPTY, THEN DELETE */
 
-		if (n == 0)
+		if (pg->numParticles == 0)
 		{
 			Pool_ReleaseIndex(gParticleGroupPool, g);
+			g = nextGroupIndex;
+			continue;
 		}
 
+		switch (pg->type)
+		{
+						/* FALLING SPARKS */
+
+			case	PARTICLE_TYPE_FALLINGSPARKS:
+					MoveFallingSparks(pg, fps);
+					break;
+
+
+						/* GRAVITOIDS */
+
+			case	PARTICLE_TYPE_GRAVITOIDS:
+					MoveGravitoids(pg, fps);
+					break;
+		}
 
 		g = nextGroupIndex;
 	}
@@ -603,78 +718,154 @@ nextParticle:
 
 
 /**************** DRAW PARTICLE GROUPS *********************/
+//
+// Particles are billboards: quads that stand upright in the world (the up vector is always +y)
+// and turn to face the camera.
+//
+// The original built a look-at matrix per particle to face the camera position. Now every
+// quad faces the camera's view direction, so the quad's x-axis is worked out once per frame
+// from the view matrix, and each corner is just the particle's position +/- the scaled axes.
+// (Like the original, the x-axis isn't renormalized, so quads get narrower as you look down on them.)
+//
 
 void DrawParticleGroup(const QD3DSetupOutputType *setupInfo)
 {
-float			baseScale;
 TQ3TriMeshData	*tm;
-TQ3Point3D		v[4],*coord;
-TQ3Matrix4x4	m;
-static const TQ3Vector3D up = {0,1,0};
-
+static float	halfSize[MAX_PARTICLES], axisX[MAX_PARTICLES], axisZ[MAX_PARTICLES];
 
 	(void) setupInfo;
 
 	if (!gParticleGroupsInitialized)
 		return;
 
-	const TQ3Point3D* camCoords = &gGameViewInfoPtr->currentCameraCoords;
+			/* GET QUAD X-AXIS FROM CAMERA */
+			//
+			// Column 2 of the world-to-view matrix is the camera's "back" vector;
+			// the original's x-axis was up x lookAt = (lookAt.z, 0, -lookAt.x) with lookAt = -back.
+			//
+
+	const float rightX = -gCameraWorldToViewMatrix.value[2][2];
+	const float rightZ = gCameraWorldToViewMatrix.value[0][2];
 
 	for (int g = Pool_First(gParticleGroupPool); g >= 0; g = Pool_Next(gParticleGroupPool, g))
 	{
 		GAME_ASSERT(Pool_IsUsed(gParticleGroupPool, g));
 
-		float	minX,minY,minZ,maxX,maxY,maxZ;
-
 		ParticleGroupType* pg = &gParticleGroups[g];
 
+		const int n = pg->numParticles;
+		const int nVec = RoundUpToVectors(n);
+
+		if (n == 0)
+			continue;
+
 		tm = pg->mesh;									// get pointer to trimesh data
-		baseScale = pg->baseScale;						// get base scale
 
-					/********************************/
-					/* ADD ALL PARTICLES TO TRIMESH */
-					/********************************/
+					/***********************/
+					/* GET BOUNDING SPHERE */
+					/***********************/
+					//
+					// Bound the particle centers with a box, then put a sphere around it that's
+					// big enough for the biggest quad. Skip the whole group if it's offscreen.
+					//
 
-		minX = minY = minZ = 1e9f;						// init bbox
-		maxX = maxY = maxZ = -minX;
+		Vec4 minX = V4Splat(1e9f), minY = minX, minZ = minX;
+		Vec4 maxX = V4Splat(-1e9f), maxY = maxX, maxZ = maxX;
+		Vec4 maxScale = V4Splat(0);
+		int p = 0;
 
-		int numParticlesDrawn = 0;
-		for (int p = Pool_First(pg->pool); p >= 0; p = Pool_Next(pg->pool, p))
+		for (; p + 4 <= n; p += 4)
 		{
-			GAME_ASSERT(Pool_IsUsed(pg->pool, p));
-
-					/* TRANSFORM PARTICLE POSITION */
+			Vec4 x = V4Load(pg->x + p), y = V4Load(pg->y + p), z = V4Load(pg->z + p);
+			minX = V4Min(minX, x);	maxX = V4Max(maxX, x);
+			minY = V4Min(minY, y);	maxY = V4Max(maxY, y);
+			minZ = V4Min(minZ, z);	maxZ = V4Max(maxZ, z);
+			maxScale = V4Max(maxScale, V4Load(pg->scale + p));
+		}
 
-			coord = &pg->coord[p];
-			SetLookAtMatrixAndTranslate(&m, &up, coord, camCoords);
+		float mnx[4], mny[4], mnz[4], mxx[4], mxy[4], mxz[4], ms[4];
+		V4Store(mnx, minX);	V4Store(mny, minY);	V4Store(mnz, minZ);
+		V4Store(mxx, maxX);	V4Store(mxy, maxY);	V4Store(mxz, maxZ);
+		V4Store(ms, maxScale);
 
-					/* CULL PARTICLE TO AVOID OVERDRAW (SOURCE PORT ADD) */
+		TQ3BoundingBox bounds = { .min = { mnx[0], mny[0], mnz[0] }, .max = { mxx[0], mxy[0], mxz[0] } };
+		float biggestScale = ms[0];
 
-			if (!IsSphereInFrustum_XYZ(coord, pg->baseScale))
-				continue;
+		for (int i = 1; i < 4; i++)
+		{
+			bounds.min.x = fminf(bounds.min.x, mnx[i]);		bounds.max.x = fmaxf(bounds.max.x, mxx[i]);
+			bounds.min.y = fminf(bounds.min.y, mny[i]);		bounds.max.y = fmaxf(bounds.max.y, mxy[i]);
+			bounds.min.z = fminf(bounds.min.z, mnz[i]);		bounds.max.z = fmaxf(bounds.max.z, mxz[i]);
+			biggestScale = fmaxf(biggestScale, ms[i]);
+		}
 
-					/* TRANSFORM PARTICLE VERTICES & ADD TO TRIMESH */
+		for (; p < n; p++)													// leftovers
+		{
+			bounds.min.x = fminf(bounds.min.x, pg->x[p]);	bounds.max.x = fmaxf(bounds.max.x, pg->x[p]);
+			bounds.min.y = fminf(bounds.min.y, pg->y[p]);	bounds.max.y = fmaxf(bounds.max.y, pg->y[p]);
+			bounds.min.z = fminf(bounds.min.z, pg->z[p]);	bounds.max.z = fmaxf(bounds.max.z, pg->z[p]);
+			biggestScale = fmaxf(biggestScale, pg->scale[p]);
+		}
 
-			const float S = baseScale * pg->scale[p];
-			v[0] = (TQ3Point3D) {  S, S, 0 };
-			v[1] = (TQ3Point3D) {  S,-S, 0 };
-			v[2] = (TQ3Point3D) { -S,-S, 0 };
-			v[3] = (TQ3Point3D) { -S, S, 0 };
+		TQ3Point3D center =
+		{
+			(bounds.min.x + bounds.max.x) * .5f,
+			(bounds.min.y + bounds.max.y) * .5f,
+			(bounds.min.z + bounds.max.z) * .5f,
+		};
+
+		float dx = bounds.max.x - center.x;
+		float dy = bounds.max.y - center.y;
+		float dz = bounds.max.z - center.z;
+		float quadRadius = pg->baseScale * (biggestScale > 1.0f ? biggestScale : 1.0f) * 1.4143f;	// half diagonal (also covers the cull radius below)
+		float radius = sqrtf(dx*dx + dy*dy + dz*dz) + quadRadius;
+
+		if (!IsSphereInFrustum_XYZ(&center, radius))
+			continue;
 
-			Q3Point3D_To3DTransformArray(&v[0], &m, &tm->points[numParticlesDrawn * 4], 4);
+					/******************************/
+					/* GET QUAD HALF-SIZES & AXES */
+					/******************************/
 
-					/* UPDATE BBOX */
+		{
+			Vec4 baseScale = V4Splat(pg->baseScale);
+			Vec4 vRightX = V4Splat(rightX);
+			Vec4 vRightZ = V4Splat(rightZ);
 
-			for (int i = 0; i < 4; i++)
+			for (int i = 0; i < nVec; i += 4)
 			{
-				const TQ3Point3D* pt = &tm->points[numParticlesDrawn * 4 + i];
-				if (pt->x < minX) minX = pt->x;
-				if (pt->x > maxX) maxX = pt->x;
-				if (pt->y < minY) minY = pt->y;
-				if (pt->y > maxY) maxY = pt->y;
-				if (pt->z < minZ) minZ = pt->z;
-				if (pt->z > maxZ) maxZ = pt->z;
+				Vec4 S = V4Mul(baseScale, V4Load(pg->scale + i));
+				V4Store(halfSize + i, S);
+				V4Store(axisX + i, V4Mul(S, vRightX));
+				V4Store(axisZ + i, V4Mul(S, vRightZ));
 			}
+		}
+
+					/********************************/
+					/* ADD ALL PARTICLES TO TRIMESH */
+					/********************************/
+
+		int numParticlesDrawn = 0;
+		for (p = 0; p < n; p++)
+		{
+			const TQ3Point3D coord = { pg->x[p], pg->y[p], pg->z[p] };
+
+					/* CULL PARTICLE TO AVOID OVERDRAW (SOURCE PORT ADD) */
+
+			if (!IsSphereInFrustum_XYZ(&coord, pg->baseScale))
+				continue;
+
+					/* ADD PARTICLE VERTICES TO TRIMESH */
+
+			const float S = halfSize[p];
+			const float ax = axisX[p];
+			const float az = axisZ[p];
+			TQ3Point3D* v = &tm->points[numParticlesDrawn * 4];
+
+			v[0] = (TQ3Point3D) { coord.x + ax, coord.y + S, coord.z + az };
+			v[1] = (TQ3Point3D) { coord.x + ax, coord.y - S, coord.z + az };
+			v[2] = (TQ3Point3D) { coord.x - ax, coord.y - S, coord.z - az };
+			v[3] = (TQ3Point3D) { coord.x - ax, coord.y + S, coord.z - az };
 
 					/* UPDATE FACE TRANSPARENCY */
 
@@ -690,15 +881,19 @@ static const TQ3Vector3D up = {0,1,0};
 			continue;
 
 				/* UPDATE FINAL VALUES */
+				//
+				// The bbox is only used to depth sort the group, so the box around
+				// the bounding sphere does fine.
+				//
 
 		tm->numTriangles = numParticlesDrawn * 2;
 		tm->numPoints = numParticlesDrawn * 4;
-		tm->bBox.min.x = minX;
-		tm->bBox.min.y = minY;
-		tm->bBox.min.z = minZ;
-		tm->bBox.max.x = maxX;
-		tm->bBox.max.y = maxY;
-		tm->bBox.max.z = maxZ;
+		tm->bBox.min.x = center.x - radius;
+		tm->bBox.min.y = center.y - radius;
+		tm->bBox.min.z = center.z - radius;
+		tm->bBox.max.x = center.x + radius;
+		tm->bBox.max.y = center.y + radius;
+		tm->bBox.max.z = center.z + radius;
 
 					/* DRAW IT */
 
@@ -753,17 +948,17 @@ bool ParticleHitObject(ObjNode *theNode, uint8_t inFlags)
 		if (inFlags && !(inFlags & pg->flags))				// see if check flags
 			continue;
 
-		for (int p = Pool_First(pg->pool); p >= 0; p = Pool_Next(pg->pool, p))
+		for (int p = 0; p < pg->numParticles; p++)
 		{
-			GAME_ASSERT(Pool_IsUsed(pg->pool, p));
-
 			if (pg->alpha[p] < .4f)							// if particle is too decayed, then skip
 				continue;
 
-			const TQ3Point3D* coord = &pg->coord[p];		// get ptr to coords
-			if (DoSimpleBoxCollisionAgainstObject(coord->y+40.0f,coord->y-40.0f,
-												coord->x-40.0f, coord->x+40.0f,
-												coord->z+40.0f, coord->z-40.0f,
+			float x = pg->x[p];
+			float y = pg->y[p];
+			float z = pg->z[p];
+			if (DoSimpleBoxCollisionAgainstObject(y+40.0f,y-40.0f,
+												x-40.0f, x+40.0f,
+												z+40.0f, z-40.0f,
 												theNode))
 			{
 				return(true);
@@ -274,6 +274,7 @@ float		l,r,f,b;
 		boxPtr[i].back = b;
 	}
 
+	UpdateObjectCollisionGrid(theNode);
 }
 
 
@@ -77,6 +77,11 @@ void LoadGrouped3DMF(FSSpec *spec, Byte groupNum)
 
 	Render_Load3DMFTextures(the3DMFFile, gObjectGroupTextures[groupNum], false);
 
+			/* UPLOAD GEOMETRY TO GPU */
+
+	for (int j = 0; j < the3DMFFile->numMeshes; j++)
+		Render_UploadStaticMesh(the3DMFFile->meshes[j]);
+
 			/* BUILD OBJECT LIST */
 
 	int nObjects = the3DMFFile->numTopLevelGroups;
@@ -116,6 +121,9 @@ void Free3DMFGroup(Byte groupNum)
 
 	if (gObjectGroupFile[groupNum] != nil)
 	{
+		for (int j = 0; j < gObjectGroupFile[groupNum]->numMeshes; j++)
+			Render_ReleaseStaticMesh(gObjectGroupFile[groupNum]->meshes[j]);
+
 		Q3MetaFile_Dispose(gObjectGroupFile[groupNum]);
 		gObjectGroupFile[groupNum] = nil;
 	}
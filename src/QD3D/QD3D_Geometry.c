@@ -24,6 +24,7 @@ static void ExplodeTriMesh(
 		Byte shardMode,
 		int shardDensity,
 		float shardDecaySpeed);
+static void DeleteShard(int i);
 
 
 /****************************/
@@ -38,13 +39,35 @@ static const TQ3Matrix4x4 kIdentity4x4 =
 	{0, 0, 0, 1},
 }};
 
+		/* SHARDS */
+		//
+		// Stored as structure-of-arrays with the live shards packed at the front:
+		// a dead shard is replaced by the last one. The meshes get swapped along
+		// with everything else, so each slot always owns one mesh.
+		//
+
+typedef struct
+{
+	int						numShards;
+	float					x[MAX_SHARDS], y[MAX_SHARDS], z[MAX_SHARDS];
+	float					dx[MAX_SHARDS], dy[MAX_SHARDS], dz[MAX_SHARDS];
+	float					rotX[MAX_SHARDS], rotY[MAX_SHARDS], rotZ[MAX_SHARDS];
+	float					rotDX[MAX_SHARDS], rotDY[MAX_SHARDS], rotDZ[MAX_SHARDS];
+	float					scale[MAX_SHARDS];
+	float					decaySpeed[MAX_SHARDS];
+	float					radius[MAX_SHARDS];				// distance from center to farthest point at scale 1
+	Byte					mode[MAX_SHARDS];
+	TQ3Matrix4x4			matrix[MAX_SHARDS];
+	TQ3TriMeshData			*mesh[MAX_SHARDS];
+}ShardListType;
+
+
 /*********************/
 /*    VARIABLES      */
 /*********************/
 
-static ShardType			gShards[MAX_SHARDS];
+static ShardListType		gShards;
 static RenderModifiers		kShardRenderMods;
-Pool						*gShardPool = NULL;
 
 
 /*************** QD3D: CALC OBJECT BOUNDING BOX ************************/
@@ -147,17 +170,17 @@ void QD3D_CalcObjectBoundingSphere(int numMeshes, TQ3TriMeshData** meshList, TQ3
 
 void QD3D_InitShards(void)
 {
-	if (!gShardPool)
-		gShardPool = Pool_New(MAX_SHARDS);
-	else
-		Pool_Reset(gShardPool);
+	gShards.numShards = 0;
 
 	for (int i = 0; i < MAX_SHARDS; i++)
 	{
-		ShardType* shard = &gShards[i];
-		shard->mesh = Q3TriMeshData_New(1, 3, kQ3TriMeshDataFeatureVertexUVs | kQ3TriMeshDataFeatureVertexNormals);
+		if (gShards.mesh[i])											// already have meshes from last time
+			continue;
+
+		TQ3TriMeshData* mesh = Q3TriMeshData_New(1, 3, kQ3TriMeshDataFeatureVertexUVs | kQ3TriMeshDataFeatureVertexNormals);
 		for (int v = 0; v < 3; v++)
-			shard->mesh->triangles[0].pointIndices[v] = v;
+			mesh->triangles[0].pointIndices[v] = v;
+		gShards.mesh[i] = mesh;
 	}
 
 	Render_SetDefaultModifiers(&kShardRenderMods);
@@ -172,16 +195,14 @@ void QD3D_DisposeShards(void)
 {
 	for (int i = 0; i < MAX_SHARDS; i++)
 	{
-		ShardType* shard = &gShards[i];
-		if (shard->mesh)
+		if (gShards.mesh[i])
 		{
-			Q3TriMeshData_Dispose(shard->mesh);
-			shard->mesh = NULL;
+			Q3TriMeshData_Dispose(gShards.mesh[i]);
+			gShards.mesh[i] = NULL;
 		}
 	}
 
-	Pool_Free(gShardPool);
-	gShardPool = NULL;
+	gShards.numShards = 0;
 }
 
 
@@ -199,6 +220,9 @@ void QD3D_ExplodeGeometry(ObjNode* theNode, float boomForce, Byte shardMode, int
 
 	if (theNode->Genre == SKELETON_GENRE)
 	{
+		if (IsGPUSkinningAvailable(theNode))				// skinned on the GPU: local trimeshes aren't kept up to date
+			UpdateSkinnedGeometry(theNode);
+
 		transform = &kIdentity4x4;							// init to identity matrix (skeleton vertices are pre-transformed)
 	}
 	else
@@ -274,13 +298,12 @@ static void ExplodeTriMesh(
 	{
 				/* GET FREE SHARD INDEX */
 
-		int shardIndex = Pool_AllocateIndex(gShardPool);
-		if (shardIndex < 0)												// see if all out
+		if (gShards.numShards >= MAX_SHARDS)							// see if all out
 			break;
 
-		ShardType* shard = &gShards[shardIndex];
+		int i = gShards.numShards++;
 
-		TQ3TriMeshData* sMesh = shard->mesh;
+		TQ3TriMeshData* sMesh = gShards.mesh[i];
 
 		const uint32_t* ind = inMesh->triangles[t].pointIndices;		// get indices of 3 points
 
@@ -302,11 +325,17 @@ static void ExplodeTriMesh(
 			(sMesh->points[0].z + sMesh->points[1].z + sMesh->points[2].z) * 0.3333f,
 		};
 
+		float radius2 = 0;
 		for (int v = 0; v < 3; v++)
 		{
-			sMesh->points[v].x -= centerPt.x;											// offset coords to be around center
-			sMesh->points[v].y -= centerPt.y;
-			sMesh->points[v].z -= centerPt.z;
+			TQ3Point3D* pt = &sMesh->points[v];
+			pt->x -= centerPt.x;														// offset coords to be around center
+			pt->y -= centerPt.y;
+			pt->z -= centerPt.z;
+
+			float d2 = pt->x*pt->x + pt->y*pt->y + pt->z*pt->z;
+			if (d2 > radius2)
+				radius2 = d2;
 		}
 
 		sMesh->bBox.min = sMesh->bBox.max = centerPt;
@@ -353,22 +382,25 @@ static void ExplodeTriMesh(
 			/* SET PHYSICS STUFF */
 			/*********************/
 
-		shard->coord = centerPt;
-		shard->rot = (TQ3Vector3D) {0, 0, 0};
-		shard->scale = 1.0f;
+		gShards.x[i] = centerPt.x;
+		gShards.y[i] = centerPt.y;
+		gShards.z[i] = centerPt.z;
+		gShards.rotX[i] = gShards.rotY[i] = gShards.rotZ[i] = 0;
+		gShards.scale[i] = 1.0f;
+		gShards.radius[i] = sqrtf(radius2);
 
-		shard->coordDelta.x = (RandomFloat() - 0.5f) * boomForce;
-		shard->coordDelta.y = (RandomFloat() - 0.5f) * boomForce;
-		shard->coordDelta.z = (RandomFloat() - 0.5f) * boomForce;
+		gShards.dx[i] = (RandomFloat() - 0.5f) * boomForce;
+		gShards.dy[i] = (RandomFloat() - 0.5f) * boomForce;
+		gShards.dz[i] = (RandomFloat() - 0.5f) * boomForce;
 		if (shardMode & SHARD_MODE_UPTHRUST)
-			shard->coordDelta.y += 1.5f * boomForce;
+			gShards.dy[i] += 1.5f * boomForce;
 
-		shard->rotDelta.x = (RandomFloat() - 0.5f) * 4.0f;			// random rotation deltas
-		shard->rotDelta.y = (RandomFloat() - 0.5f) * 4.0f;
-		shard->rotDelta.z = (RandomFloat() - 0.5f) * 4.0f;
+		gShards.rotDX[i] = (RandomFloat() - 0.5f) * 4.0f;			// random rotation deltas
+		gShards.rotDY[i] = (RandomFloat() - 0.5f) * 4.0f;
+		gShards.rotDZ[i] = (RandomFloat() - 0.5f) * 4.0f;
 
-		shard->decaySpeed = shardDecaySpeed;
-		shard->mode = shardMode;
+		gShards.decaySpeed[i] = shardDecaySpeed;
+		gShards.mode[i] = shardMode;
 	}
 }
 
@@ -377,55 +409,61 @@ static void ExplodeTriMesh(
 
 void QD3D_MoveShards(void)
 {
-float	ty,y,fps,x,z;
-TQ3Matrix4x4	matrix,matrix2;
+static float	terrainY[MAX_SHARDS];
+float			fps;
 
-	if (!gShardPool || Pool_Empty(gShardPool))					// quick check if any shards at all
+	int n = gShards.numShards;
+	if (n == 0)													// quick check if any shards at all
 		return;
 
 	fps = gFramesPerSecondFrac;
-	ty = -100.0f;												// pin point to "floor" if no terrain
-
-	int i = Pool_First(gShardPool);
-	while (i >= 0)
-	{
-		GAME_ASSERT(Pool_IsUsed(gShardPool, i));
 
-		int nextIndex = Pool_Next(gShardPool, i);
+	const float gravity = fps * 1700.0f / 3;
+	const float heavyGravity = fps * 1700.0f / 2;
 
-		ShardType* shard = &gShards[i];
+				/* ROTATE & MOVE THEM */
+				//
+				// Straight loops over the arrays with no branches, so the compiler can vectorize them.
+				//
 
-				/* ROTATE IT */
-
-		shard->rot.x += shard->rotDelta.x * fps;
-		shard->rot.y += shard->rotDelta.y * fps;
-		shard->rot.z += shard->rotDelta.z * fps;
+	for (int i = 0; i < n; i++)
+	{
+		gShards.rotX[i] += gShards.rotDX[i] * fps;
+		gShards.rotY[i] += gShards.rotDY[i] * fps;
+		gShards.rotZ[i] += gShards.rotDZ[i] * fps;
+	}
 
-					/* MOVE IT */
+	for (int i = 0; i < n; i++)
+	{
+		gShards.dy[i] -= (gShards.mode[i] & SHARD_MODE_HEAVYGRAVITY) ? heavyGravity : gravity;
 
-		if (shard->mode & SHARD_MODE_HEAVYGRAVITY)
-			shard->coordDelta.y -= fps * 1700.0f / 2;			// gravity
-		else
-			shard->coordDelta.y -= fps * 1700.0f / 3;			// gravity
+		gShards.x[i] += gShards.dx[i] * fps;
+		gShards.y[i] += gShards.dy[i] * fps;
+		gShards.z[i] += gShards.dz[i] * fps;
+	}
 
-		x = (shard->coord.x += shard->coordDelta.x * fps);
-		y = (shard->coord.y += shard->coordDelta.y * fps);
-		z = (shard->coord.z += shard->coordDelta.z * fps);
+				/* GET TERRAIN HEIGHT UNDER ALL OF THEM AT ONCE */
 
+	if (gFloorMap)
+		GetTerrainHeightsAtCoords(gShards.x, gShards.z, terrainY, nil, n, FLOOR);
+	else
+	{
+		for (int i = 0; i < n; i++)
+			terrainY[i] = -100.0f;								// pin point to "floor" if no terrain
+	}
 
+	for (int i = 0; i < n; )
+	{
 					/* SEE IF BOUNCE */
 
-		if (gFloorMap)
-			ty = GetTerrainHeightAtCoord(x,z, FLOOR);			// get terrain height here
-
-		if (y <= ty)
+		if (gShards.y[i] <= terrainY[i])
 		{
-			if (shard->mode & SHARD_MODE_BOUNCE)
+			if (gShards.mode[i] & SHARD_MODE_BOUNCE)
 			{
-				shard->coord.y  = ty;
-				shard->coordDelta.y *= -0.5f;
-				shard->coordDelta.x *= 0.9f;
-				shard->coordDelta.z *= 0.9f;
+				gShards.y[i] = terrainY[i];
+				gShards.dy[i] *= -0.5f;
+				gShards.dx[i] *= 0.9f;
+				gShards.dz[i] *= 0.9f;
 			}
 			else
 				goto del;
@@ -433,53 +471,93 @@ TQ3Matrix4x4	matrix,matrix2;
 
 					/* SCALE IT */
 
-		shard->scale -= shard->decaySpeed * fps;
-		if (shard->scale <= 0.0f)
+		gShards.scale[i] -= gShards.decaySpeed[i] * fps;
+		if (gShards.scale[i] > 0.0f)
 		{
-				/* DEACTIVATE THIS SHARD */
-	del:
-			Pool_ReleaseIndex(gShardPool, i);
-			goto next;
+			i++;
+			continue;
 		}
 
-			/***************************/
-			/* UPDATE TRANSFORM MATRIX */
-			/***************************/
-
-
-				/* SET SCALE MATRIX */
-
-		Q3Matrix4x4_SetScale(&shard->matrix, shard->scale, shard->scale, shard->scale);
-
-					/* NOW ROTATE IT */
-
-		Q3Matrix4x4_SetRotate_XYZ(&matrix, shard->rot.x, shard->rot.y, shard->rot.z);
-		MatrixMultiplyFast(&shard->matrix, &matrix, &matrix2);
+				/* DEACTIVATE THIS SHARD */
+del:
+		n--;
+		terrainY[i] = terrainY[n];								// the last shard moves into this slot
+		DeleteShard(i);
+	}
+}
 
-					/* NOW TRANSLATE IT */
 
-		Q3Matrix4x4_SetTranslate(&matrix, shard->coord.x, shard->coord.y, shard->coord.z);
-		MatrixMultiplyFast(&matrix2,&matrix, &shard->matrix);
+/************************** DELETE SHARD ****************************/
+//
+// Moves the last shard into this one's slot.
+//
 
-next:
-		i = nextIndex;
-	}
+static void DeleteShard(int i)
+{
+	int last = --gShards.numShards;
+
+	TQ3TriMeshData* mesh = gShards.mesh[i];					// hang on to the dead shard's mesh
+
+	gShards.x[i]			= gShards.x[last];
+	gShards.y[i]			= gShards.y[last];
+	gShards.z[i]			= gShards.z[last];
+	gShards.dx[i]			= gShards.dx[last];
+	gShards.dy[i]			= gShards.dy[last];
+	gShards.dz[i]			= gShards.dz[last];
+	gShards.rotX[i]			= gShards.rotX[last];
+	gShards.rotY[i]			= gShards.rotY[last];
+	gShards.rotZ[i]			= gShards.rotZ[last];
+	gShards.rotDX[i]		= gShards.rotDX[last];
+	gShards.rotDY[i]		= gShards.rotDY[last];
+	gShards.rotDZ[i]		= gShards.rotDZ[last];
+	gShards.scale[i]		= gShards.scale[last];
+	gShards.decaySpeed[i]	= gShards.decaySpeed[last];
+	gShards.radius[i]		= gShards.radius[last];
+	gShards.mode[i]			= gShards.mode[last];
+	gShards.mesh[i]			= gShards.mesh[last];
+	gShards.mesh[last]		= mesh;
 }
 
 
 /************************* QD3D: DRAW SHARDS ****************************/
+//
+// Transform matrices are only built for the shards that are onscreen.
+//
 
 void QD3D_DrawShards(const QD3DSetupOutputType *setupInfo)
 {
 	(void) setupInfo;
 
-	if (!gShardPool || Pool_Empty(gShardPool))		// quick check if any shards at all
-		return;
-
-	for (int i = Pool_First(gShardPool); i >= 0; i = Pool_Next(gShardPool, i))
+	for (int i = 0; i < gShards.numShards; i++)
 	{
-		ShardType* shard = &gShards[i];
-		Render_SubmitMesh(shard->mesh, &shard->matrix, &kShardRenderMods, &shard->coord);
+		const float s = gShards.scale[i];
+		const TQ3Point3D coord = { gShards.x[i], gShards.y[i], gShards.z[i] };
+
+		if (!IsSphereInFrustum_XYZ(&coord, gShards.radius[i] * s))
+			continue;
+
+				/* UPDATE TRANSFORM MATRIX */
+				//
+				// Same as scale * rotate * translate, without the matrix multiplies:
+				// scale the rotation's rows and drop the translation in the bottom row.
+				//
+
+		TQ3Matrix4x4* m = &gShards.matrix[i];
+
+		Q3Matrix4x4_SetRotate_XYZ(m, gShards.rotX[i], gShards.rotY[i], gShards.rotZ[i]);
+
+		for (int row = 0; row < 3; row++)
+		{
+			m->value[row][0] *= s;
+			m->value[row][1] *= s;
+			m->value[row][2] *= s;
+		}
+
+		m->value[3][0] = coord.x;
+		m->value[3][1] = coord.y;
+		m->value[3][2] = coord.z;
+
+		Render_SubmitMesh(gShards.mesh[i], m, &kShardRenderMods, &coord);
 	}
 }
 
@@ -507,6 +585,8 @@ void QD3D_ScrollUVs(TQ3TriMeshData* mesh, float du, float dv)
 		mesh->vertexUVs[j].u += du;
 		mesh->vertexUVs[j].v += dv;
 	}
+
+	Render_InvalidateStaticMesh(mesh);
 }
 
 
@@ -20,6 +20,7 @@
 /****************************/
 
 static void CreateLights(QD3DLightDefType *lightDefPtr);
+static uint64_t WaitForFrameDeadline(uint64_t prevTime, uint64_t performanceFrequency);
 
 
 /****************************/
@@ -28,6 +29,8 @@ static void CreateLights(QD3DLightDefType *lightDefPtr);
 
 static const int kDebugTextMeshQuadCapacity = 1024;
 
+#define	FRAME_PACER_SPIN_MICROSECONDS	1000		// SDL_Delay may oversleep, so spin instead of sleeping for the last bit of the wait
+
 
 /*********************/
 /*    VARIABLES      */
@@ -265,6 +268,9 @@ static void CreateLights(QD3DLightDefType *lightDefPtr)
 
 	for (int i = lightDefPtr->numFillLights; i < MAX_FILL_LIGHTS; i++)
 	{
+		static const GLfloat black[4] = { 0, 0, 0, 1 };
+		glLightfv(GL_LIGHT0 + i, GL_AMBIENT, black);		// the skinning shader sums all MAX_FILL_LIGHTS lights,
+		glLightfv(GL_LIGHT0 + i, GL_DIFFUSE, black);		// so make sure unused ones don't contribute anything
 		glDisable(GL_LIGHT0 + i);
 	}
 }
@@ -337,7 +343,12 @@ void QD3D_DrawScene(QD3DSetupOutputType *setupInfo, void (*drawRoutine)(const QD
 
 	Render_EndFrame();
 
-	SDL_GL_SwapWindow(gSDLWindow);
+	Profiler_BeginZone(PROFILER_ZONE_SWAP);
+	if (gCommandLine.noPresent)
+		glFinish();											// still wait for the GPU to be done with the frame
+	else
+		SDL_GL_SwapWindow(gSDLWindow);
+	Profiler_EndZone(PROFILER_ZONE_SWAP);
 }
 
 
@@ -532,8 +543,7 @@ void QD3D_CalcFramesPerSecond(void)
 		performanceFrequency = SDL_GetPerformanceFrequency();
 	}
 
-	slow_down:
-	currTime = SDL_GetPerformanceCounter();
+	currTime = WaitForFrameDeadline(prevTime, performanceFrequency);		// keep from cooking the GPU
 	uint64_t deltaTime = currTime - prevTime;
 
 	if (deltaTime <= 0)
@@ -544,15 +554,6 @@ void QD3D_CalcFramesPerSecond(void)
 	{
 		gFramesPerSecond = performanceFrequency / (float)(deltaTime);
 
-		if (gFramesPerSecond > MAX_FPS)					// keep from cooking the GPU
-		{
-			if (gFramesPerSecond - MAX_FPS > 1000)		// try to sneak in some sleep if we have 1 ms to spare
-			{
-				SDL_Delay(1);
-			}
-			goto slow_down;
-		}
-
 		if (gFramesPerSecond < MIN_FPS)					// (avoid divide by 0's later)
 		{
 			gFramesPerSecond = MIN_FPS;
@@ -582,6 +583,49 @@ void QD3D_CalcFramesPerSecond(void)
 	gFramesPerSecondFrac = 1.0f / gFramesPerSecond;		// calc fractional for multiplication
 
 	prevTime = currTime;								// reset for next time interval
+
+	Profiler_EndFrame();
+}
+
+
+/************** WAIT FOR FRAME DEADLINE *****************/
+//
+// Holds the frame rate down to the cap (--max-fps, or MAX_FPS by default).
+// Sleeps through most of the wait and only spins for the last fraction of a millisecond,
+// so that uncapped vsync-off play and the menus don't keep a core busy.
+//
+// Returns the performance counter at the start of the new frame.
+//
+
+static uint64_t WaitForFrameDeadline(uint64_t prevTime, uint64_t performanceFrequency)
+{
+int			maxFPS = gCommandLine.maxFPS > 0 ? gCommandLine.maxFPS : MAX_FPS;
+uint64_t	deadline;
+uint64_t	spinTime = performanceFrequency * FRAME_PACER_SPIN_MICROSECONDS / 1000000;
+uint64_t	currTime = SDL_GetPerformanceCounter();
+
+	if (gCommandLine.benchmarkInputFile)					// benchmark runs flat out
+		return currTime;
+
+	if (gCommandLine.recordInputFile)						// recorded sessions run at a fixed frame time, so play them at that speed
+		maxFPS = INPUT_RECORDING_FPS;
+
+	deadline = prevTime + performanceFrequency / maxFPS;
+
+	while (currTime < deadline)
+	{
+		uint64_t remaining = deadline - currTime;
+
+		if (remaining > spinTime)
+		{
+			Uint32 sleepMS = (Uint32) ((remaining - spinTime) * 1000 / performanceFrequency);
+			SDL_Delay(sleepMS > 0 ? sleepMS : 1);
+		}
+
+		currTime = SDL_GetPerformanceCounter();
+	}
+
+	return currTime;
 }
 
 #pragma mark -
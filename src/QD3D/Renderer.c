@@ -11,7 +11,6 @@
 #include <SDL.h>
 #include <SDL_opengl.h>
 #include <QD3D.h>
-#include <stdlib.h>		// qsort
 #include <stdio.h>
 
 
@@ -41,34 +40,114 @@ typedef struct RendererState
 	bool		blendFuncIsAdditive;
 	bool		sceneHasFog;
 	GLboolean	wantColorMask;
+	GLuint		boundArrayBuffer;
+	GLuint		boundElementArrayBuffer;
+	GLuint		currentProgram;
+	const GLfloat*	currentBonePalette;		// palette last uploaded to the skinning program
+	int			skinningLighting;			// lighting uniform last sent to the skinning program (-1: unknown)
+	int			instancingLighting;			// lighting uniform last sent to the instancing program (-1: unknown)
+	bool		hasBoneIndexAttribArray;
+	bool		hasInstanceAttribArrays;
 	const TQ3Matrix4x4*	currentTransform;
 } RendererState;
 
+enum
+{
+	kMeshArray_Points,
+	kMeshArray_Normals,
+	kMeshArray_UVs,
+	kMeshArray_Colors,
+	kMeshArray_COUNT
+};
+
+// GPU-side copy of a static mesh's vertex & index data.
+typedef struct MeshBufferRecord
+{
+	const TQ3TriMeshData*	mesh;						// key (nil if the slot is free)
+	GLuint					vertexBuffer;
+	GLuint					indexBuffer;
+	GLintptr				offsets[kMeshArray_COUNT];	// offset of each array in vertexBuffer (-1 if absent)
+	GLsizeiptr				vertexBufferSize;
+	GLsizeiptr				indexBufferSize;
+	int						numPoints;					// mesh dimensions at upload time,
+	int						numTriangles;				// used to detect stale records
+	bool					dirty;						// re-upload before next draw
+} MeshBufferRecord;
+
 typedef struct MeshQueueEntry
 {
 	const TQ3TriMeshData*	mesh;
 	const TQ3Matrix4x4*		transform;	// may be NULL
 	const RenderModifiers*	mods;		// may be NULL
+	const MeshBufferRecord*	buffers;	// NULL if the mesh isn't on the GPU (draw from client arrays)
+	const RenderInstance*	instances;	// if non-NULL, draw the mesh once per instance (transform is ignored)
+	int						numInstances;
+	int						firstInstance;	// where the instances' matrices start in gInstanceBuffer (-1 if not uploaded)
+	const GLfloat*			boneIndices;	// if non-NULL, skin the mesh on the GPU (one bone index per vertex)
+	const GLfloat*			bonePalette;	// 3 vec4 rows per bone
+	int						numBones;
 	float					depth;		// used to determine draw order
 	bool					meshIsTransparent;
+	uint64_t				sortKey;	// see MakeSortKey
 } MeshQueueEntry;
 
-#define MESHQUEUE_MAX_SIZE 4096
-
-static MeshQueueEntry		gMeshQueueEntryPool[MESHQUEUE_MAX_SIZE];
-static MeshQueueEntry*		gMeshQueuePtrs[MESHQUEUE_MAX_SIZE];
+typedef struct MeshSortItem
+{
+	uint64_t				key;
+	MeshQueueEntry*			entry;
+} MeshSortItem;
+
+#define MESHQUEUE_INITIAL_CAPACITY 4096
+
+// The mesh queue grows on demand and keeps its capacity from one frame to the next.
+// Nothing may point into gMeshQueueEntryPool between submission and Render_FlushQueue,
+// because the pool may move when it grows.
+static MeshQueueEntry*		gMeshQueueEntryPool = nil;
+static MeshQueueEntry**		gMeshQueuePtrs = nil;
+static MeshSortItem*		gMeshSortBuffers[2] = { nil, nil };
 static int					gMeshQueueSize = 0;
+static int					gMeshQueueCapacity = 0;
+static int					gMeshQueueHighWaterMark = 0;
 static bool					gFrameStarted = false;
 
 static float				gBackupVertexColors[4*65536];
 
-static int DrawOrderComparator(void const* a_void, void const* b_void);
+// Status bits that affect GL state when a mesh is drawn.
+#define SHADING_STATUS_BITS		(STATUS_BIT_REFLECTIONMAP | STATUS_BIT_GLOW | STATUS_BIT_NULLSHADER | STATUS_BIT_NOZWRITE \
+								| STATUS_BIT_NOFOG | STATUS_BIT_KEEPBACKFACES | STATUS_BIT_KEEPBACKFACES_2PASS)
+
+// Small untransformed opaque meshes that share the same state are concatenated
+// into these arrays and drawn in a single call.
+#define MERGE_MAX_MESH_POINTS	1024		// only consider meshes smaller than this
+#define MERGE_MAX_POINTS		16384
+#define MERGE_MAX_TRIANGLES		32768
+
+static TQ3Point3D				gMergedPoints[MERGE_MAX_POINTS];
+static TQ3Vector3D				gMergedNormals[MERGE_MAX_POINTS];
+static TQ3Param2D				gMergedUVs[MERGE_MAX_POINTS];
+static TQ3ColorRGBA				gMergedColors[MERGE_MAX_POINTS];
+static TQ3TriMeshTriangleData	gMergedTriangles[MERGE_MAX_TRIANGLES];
+static TQ3TriMeshData			gMergedMesh;
+static MeshQueueEntry			gMergedEntry;
+
+static MeshBufferRecord*	gMeshBufferTable = nil;		// open-addressing hash table keyed by mesh pointer
+static int					gMeshBufferTableCapacity = 0;	// always a power of 2
+static int					gMeshBufferTableCount = 0;
+
+static void SortMeshQueue(void);
 
 static void BeginDepthPass(const MeshQueueEntry* entry);
 static void BeginShadingPass(const MeshQueueEntry* entry);
 static void PrepareOpaqueShading(const MeshQueueEntry* entry);
 static void PrepareAlphaShading(const MeshQueueEntry* entry);
 static void SendGeometry(const MeshQueueEntry* entry);
+static bool IsSameShadingState(const MeshQueueEntry* a, const MeshQueueEntry* b);
+static void SendShadingArrays(const MeshQueueEntry* entry);
+static int MergeOpaqueRun(int first);
+static const MeshBufferRecord* LookUpMeshBuffers(const TQ3TriMeshData* mesh);
+static void Render_CreateSkinningProgram(void);
+static void Render_CreateInstancingProgram(void);
+static void DisableShaders(void);
 
 
 #pragma mark -
@@ -133,6 +212,190 @@ float gGammaFadeFactor = 1.0f;
 
 static TQ3TriMeshData* gFullscreenQuad = nil;
 
+static bool gCanUseBufferObjects = false;
+
+#if !(__APPLE__)
+static PFNGLGENBUFFERSPROC			procptr_glGenBuffers		= NULL;
+static PFNGLDELETEBUFFERSPROC		procptr_glDeleteBuffers		= NULL;
+static PFNGLBINDBUFFERPROC			procptr_glBindBuffer		= NULL;
+static PFNGLBUFFERDATAPROC			procptr_glBufferData		= NULL;
+static PFNGLBUFFERSUBDATAPROC		procptr_glBufferSubData		= NULL;
+#define glGenBuffers				procptr_glGenBuffers
+#define glDeleteBuffers				procptr_glDeleteBuffers
+#define glBindBuffer				procptr_glBindBuffer
+#define glBufferData				procptr_glBufferData
+#define glBufferSubData				procptr_glBufferSubData
+#endif
+
+static bool gCanUseShaders = false;
+
+#if !(__APPLE__)
+static PFNGLCREATESHADERPROC				procptr_glCreateShader				= NULL;
+static PFNGLDELETESHADERPROC				procptr_glDeleteShader				= NULL;
+static PFNGLSHADERSOURCEPROC				procptr_glShaderSource				= NULL;
+static PFNGLCOMPILESHADERPROC				procptr_glCompileShader				= NULL;
+static PFNGLGETSHADERIVPROC					procptr_glGetShaderiv				= NULL;
+static PFNGLGETSHADERINFOLOGPROC			procptr_glGetShaderInfoLog			= NULL;
+static PFNGLCREATEPROGRAMPROC				procptr_glCreateProgram				= NULL;
+static PFNGLDELETEPROGRAMPROC				procptr_glDeleteProgram				= NULL;
+static PFNGLATTACHSHADERPROC				procptr_glAttachShader				= NULL;
+static PFNGLBINDATTRIBLOCATIONPROC			procptr_glBindAttribLocation		= NULL;
+static PFNGLLINKPROGRAMPROC					procptr_glLinkProgram				= NULL;
+static PFNGLGETPROGRAMIVPROC				procptr_glGetProgramiv				= NULL;
+static PFNGLGETPROGRAMINFOLOGPROC			procptr_glGetProgramInfoLog			= NULL;
+static PFNGLUSEPROGRAMPROC					procptr_glUseProgram				= NULL;
+static PFNGLGETUNIFORMLOCATIONPROC			procptr_glGetUniformLocation		= NULL;
+static PFNGLUNIFORM1IPROC					procptr_glUniform1i					= NULL;
+static PFNGLUNIFORM4FVPROC					procptr_glUniform4fv				= NULL;
+static PFNGLVERTEXATTRIBPOINTERPROC			procptr_glVertexAttribPointer		= NULL;
+static PFNGLENABLEVERTEXATTRIBARRAYPROC		procptr_glEnableVertexAttribArray	= NULL;
+static PFNGLDISABLEVERTEXATTRIBARRAYPROC	procptr_glDisableVertexAttribArray	= NULL;
+#define glCreateShader						procptr_glCreateShader
+#define glDeleteShader						procptr_glDeleteShader
+#define glShaderSource						procptr_glShaderSource
+#define glCompileShader						procptr_glCompileShader
+#define glGetShaderiv						procptr_glGetShaderiv
+#define glGetShaderInfoLog					procptr_glGetShaderInfoLog
+#define glCreateProgram						procptr_glCreateProgram
+#define glDeleteProgram						procptr_glDeleteProgram
+#define glAttachShader						procptr_glAttachShader
+#define glBindAttribLocation				procptr_glBindAttribLocation
+#define glLinkProgram						procptr_glLinkProgram
+#define glGetProgramiv						procptr_glGetProgramiv
+#define glGetProgramInfoLog					procptr_glGetProgramInfoLog
+#define glUseProgram						procptr_glUseProgram
+#define glGetUniformLocation				procptr_glGetUniformLocation
+#define glUniform1i							procptr_glUniform1i
+#define glUniform4fv						procptr_glUniform4fv
+#define glVertexAttribPointer				procptr_glVertexAttribPointer
+#define glEnableVertexAttribArray			procptr_glEnableVertexAttribArray
+#define glDisableVertexAttribArray			procptr_glDisableVertexAttribArray
+#endif
+
+// Instanced drawing is core in OpenGL 3.3, and an ARB extension before that (including
+// on Apple's legacy contexts), so it's looked up by name on every platform.
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+typedef void (APIENTRY *DrawElementsInstancedProc)(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices, GLsizei primcount);
+typedef void (APIENTRY *VertexAttribDivisorProc)(GLuint index, GLuint divisor);
+static bool gCanUseInstancing = false;
+static DrawElementsInstancedProc			procptr_glDrawElementsInstanced		= NULL;
+static VertexAttribDivisorProc				procptr_glVertexAttribDivisor		= NULL;
+#define glDrawElementsInstanced				procptr_glDrawElementsInstanced
+#define glVertexAttribDivisor				procptr_glVertexAttribDivisor
+
+			/* FIXED-FUNCTION LIGHTING */
+
+// Replicates the fixed-function pipeline's lighting (directional fill lights + ambient,
+// with GL_COLOR_MATERIAL) for the vertex shaders below, which all prepend it to their main().
+static const char* kLightingShaderFunction =
+	"vec4 LightVertex(vec3 n, vec4 color)\n"
+	"{\n"
+	"	vec3 lit = gl_LightModel.ambient.rgb;\n"
+	"	for (int i = 0; i < NUM_LIGHTS; i++)\n"
+	"	{\n"
+	"		float d = max(dot(n, normalize(gl_LightSource[i].position.xyz)), 0.0);\n"
+	"		lit += gl_LightSource[i].ambient.rgb + d * gl_LightSource[i].diffuse.rgb;\n"
+	"	}\n"
+	"	color.rgb = clamp(lit * color.rgb, 0.0, 1.0);\n"
+	"	return color;\n"
+	"}\n"
+	"\n";
+
+			/* GPU SKINNING */
+
+#define SKINNING_BONE_INDEX_ATTRIB		1		// (not 0, which aliases gl_Vertex on some drivers)
+
+static GLuint	gSkinningProgram = 0;
+static GLint	gSkinningPaletteUniform = -1;
+static GLint	gSkinningLightingUniform = -1;
+
+// Vertex shader for rigid one-bone-per-vertex skinning, lit like the fixed-function pipeline.
+// Fragments still go through the fixed-function pipeline (texturing, alpha test, fog).
+static const char* kSkinningVertexShader =
+	"uniform vec4 u_bonePalette[NUM_PALETTE_ROWS];\n"
+	"uniform bool u_lighting;\n"
+	"attribute float a_boneIndex;\n"
+	"\n"
+	"void main()\n"
+	"{\n"
+	"	int row = 3 * int(a_boneIndex + 0.5);\n"
+	"	vec4 r0 = u_bonePalette[row];\n"
+	"	vec4 r1 = u_bonePalette[row + 1];\n"
+	"	vec4 r2 = u_bonePalette[row + 2];\n"
+	"\n"
+	"	vec4 bonePos = vec4(gl_Vertex.xyz, 1.0);\n"
+	"	vec4 worldPos = vec4(dot(r0, bonePos), dot(r1, bonePos), dot(r2, bonePos), 1.0);\n"
+	"	vec4 eyePos = gl_ModelViewMatrix * worldPos;\n"
+	"	gl_Position = gl_ProjectionMatrix * eyePos;\n"
+	"\n"
+	"	vec4 color = gl_Color;\n"
+	"	if (u_lighting)\n"
+	"	{\n"
+	"		vec3 worldNormal = vec3(dot(r0.xyz, gl_Normal), dot(r1.xyz, gl_Normal), dot(r2.xyz, gl_Normal));\n"
+	"		color = LightVertex(normalize(gl_NormalMatrix * worldNormal), color);\n"
+	"	}\n"
+	"\n"
+	"	gl_FrontColor = color;\n"
+	"	gl_BackColor = color;\n"
+	"	gl_TexCoord[0] = gl_MultiTexCoord0;\n"
+	"	gl_FogFragCoord = abs(eyePos.z);\n"
+	"}\n";
+
+			/* GPU INSTANCING */
+
+#define INSTANCE_MATRIX_ATTRIB			2		// 4 consecutive attributes, one per matrix column
+
+static GLuint	gInstancingProgram = 0;
+static GLint	gInstancingLightingUniform = -1;
+
+// Every instance's matrix is copied here as its batch is submitted,
+// then the lot goes to gInstanceBuffer in one upload when the queue is flushed.
+static TQ3Matrix4x4*	gInstanceMatrices = nil;
+static int				gNumInstanceMatrices = 0;
+static int				gInstanceMatricesCapacity = 0;
+static GLuint			gInstanceBuffer = 0;
+
+// Vertex shader that draws the same mesh at every instance's transform, lit like the
+// fixed-function pipeline. The instance matrix comes in as 4 column attributes that
+// advance once per instance (glVertexAttribDivisor).
+static const char* kInstancingVertexShader =
+	"uniform bool u_lighting;\n"
+	"attribute vec4 a_instanceColumn0;\n"
+	"attribute vec4 a_instanceColumn1;\n"
+	"attribute vec4 a_instanceColumn2;\n"
+	"attribute vec4 a_instanceColumn3;\n"
+	"\n"
+	"void main()\n"
+	"{\n"
+	"	vec4 worldPos = a_instanceColumn0 * gl_Vertex.x\n"
+	"				+ a_instanceColumn1 * gl_Vertex.y\n"
+	"				+ a_instanceColumn2 * gl_Vertex.z\n"
+	"				+ a_instanceColumn3 * gl_Vertex.w;\n"
+	"	vec4 eyePos = gl_ModelViewMatrix * worldPos;\n"
+	"	gl_Position = gl_ProjectionMatrix * eyePos;\n"
+	"\n"
+	"	vec4 color = gl_Color;\n"
+	"	if (u_lighting)\n"
+	"	{\n"
+	"		// Normals go through the inverse transpose of the instance matrix, like GL_NORMALIZE\n"
+	"		// does with the modelview matrix. Up to scale, that's the matrix of cofactors.\n"
+	"		vec3 c0 = a_instanceColumn0.xyz;\n"
+	"		vec3 c1 = a_instanceColumn1.xyz;\n"
+	"		vec3 c2 = a_instanceColumn2.xyz;\n"
+	"		vec3 c1xc2 = cross(c1, c2);\n"
+	"		mat3 cofactors = mat3(c1xc2, cross(c2, c0), cross(c0, c1));\n"
+	"		vec3 worldNormal = sign(dot(c0, c1xc2)) * (cofactors * gl_Normal);\n"
+	"		color = LightVertex(normalize(gl_NormalMatrix * worldNormal), color);\n"
+	"	}\n"
+	"\n"
+	"	gl_FrontColor = color;\n"
+	"	gl_BackColor = color;\n"
+	"	gl_TexCoord[0] = gl_MultiTexCoord0;\n"
+	"	gl_FogFragCoord = abs(eyePos.z);\n"
+	"}\n";
+
 #pragma mark -
 
 /****************************/
@@ -168,6 +431,7 @@ static inline void __SetState(GLenum stateEnum, bool* stateFlagPtr, bool enable)
 		else
 			glDisable(stateEnum);
 		*stateFlagPtr = enable;
+		gRenderStats.stateChanges++;
 	}
 }
 
@@ -180,6 +444,7 @@ static inline void __SetClientState(GLenum stateEnum, bool* stateFlagPtr, bool e
 		else
 			glDisableClientState(stateEnum);
 		*stateFlagPtr = enable;
+		gRenderStats.stateChanges++;
 	}
 }
 
@@ -197,10 +462,31 @@ static inline void __SetClientState(GLenum stateEnum, bool* stateFlagPtr, bool e
 #define RestoreStateFromBackup(stateEnum, backup) __SetState(stateEnum, &gState.hasState_##stateEnum, (backup)->hasState_##stateEnum)
 #define RestoreClientStateFromBackup(stateEnum, backup) __SetClientState(stateEnum, &gState.hasClientState_##stateEnum, (backup)->hasClientState_##stateEnum)
 
+static inline void BindArrayBuffer(GLuint buffer)
+{
+	if (buffer != gState.boundArrayBuffer)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		gState.boundArrayBuffer = buffer;
+		gRenderStats.stateChanges++;
+	}
+}
+
+static inline void BindElementArrayBuffer(GLuint buffer)
+{
+	if (buffer != gState.boundElementArrayBuffer)
+	{
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);
+		gState.boundElementArrayBuffer = buffer;
+		gRenderStats.stateChanges++;
+	}
+}
+
 #define SetFlag(glFunction, value) do {				\
 	if ((value) != gState.hasFlag_##glFunction) {	\
 		glFunction((value)? GL_TRUE: GL_FALSE);		\
 		gState.hasFlag_##glFunction = (value);		\
+		gRenderStats.stateChanges++;				\
 	} } while(0)
 
 static inline void SetColorMask(GLboolean enable)
@@ -209,6 +495,7 @@ static inline void SetColorMask(GLboolean enable)
 	{
 		glColorMask(enable, enable, enable, enable);
 		gState.wantColorMask = enable;
+		gRenderStats.stateChanges++;
 	}
 }
 
@@ -229,6 +516,238 @@ void DoFatalGLError(GLenum error, const char* file, int line)
 }
 #endif
 
+/****************** BUILD VERTEX PROGRAM ********************/
+//
+// Compiles & links a vertex shader made of the given sources, binding each attribute
+// name to the location next to it. Returns 0 if anything goes wrong.
+//
+
+static GLuint CompileShader(GLenum type, int numSources, const char** sources)
+{
+	GLuint shader = glCreateShader(type);
+	glShaderSource(shader, numSources, sources, NULL);
+	glCompileShader(shader);
+
+	GLint ok = GL_FALSE;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+	if (!ok)
+	{
+		char log[1024];
+		glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+		printf("Shader didn't compile:\n%s\n", log);
+		glDeleteShader(shader);
+		return 0;
+	}
+
+	return shader;
+}
+
+static GLuint BuildVertexProgram(
+		int				numSources,
+		const char**	sources,
+		int				numAttribs,
+		const char**	attribNames,
+		const GLuint*	attribLocations)
+{
+	GLuint vertexShader = CompileShader(GL_VERTEX_SHADER, numSources, sources);
+	if (!vertexShader)
+		return 0;
+
+	GLuint program = glCreateProgram();
+	glAttachShader(program, vertexShader);
+	for (int i = 0; i < numAttribs; i++)
+		glBindAttribLocation(program, attribLocations[i], attribNames[i]);
+	glLinkProgram(program);
+	glDeleteShader(vertexShader);							// flagged for deletion; goes away with the program
+
+	GLint ok = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &ok);
+	if (!ok)
+	{
+		char log[1024];
+		glGetProgramInfoLog(program, sizeof(log), NULL, log);
+		printf("Program didn't link:\n%s\n", log);
+		glDeleteProgram(program);
+		return 0;
+	}
+
+	return program;
+}
+
+/****************** CREATE SKINNING PROGRAM ********************/
+//
+// Leaves gSkinningProgram at 0 if anything goes wrong,
+// in which case skeletons keep being skinned on the CPU.
+//
+
+static void Render_CreateSkinningProgram(void)
+{
+	gSkinningProgram = 0;
+
+	if (!gCanUseShaders)
+		return;
+
+	char defines[128];
+	snprintf(defines, sizeof(defines),
+			"#version 110\n#define NUM_PALETTE_ROWS %d\n#define NUM_LIGHTS %d\n",
+			3 * MAX_JOINTS, MAX_FILL_LIGHTS);
+
+	const char* sources[3] = { defines, kLightingShaderFunction, kSkinningVertexShader };
+	const char* attribNames[1] = { "a_boneIndex" };
+	const GLuint attribLocations[1] = { SKINNING_BONE_INDEX_ATTRIB };
+
+	GLuint program = BuildVertexProgram(3, sources, 1, attribNames, attribLocations);
+	if (!program)
+		return;
+
+	gSkinningPaletteUniform = glGetUniformLocation(program, "u_bonePalette");
+	gSkinningLightingUniform = glGetUniformLocation(program, "u_lighting");
+	CHECK_GL_ERROR();
+
+	gSkinningProgram = program;
+}
+
+/****************** CREATE INSTANCING PROGRAM ********************/
+//
+// Leaves gInstancingProgram at 0 if anything goes wrong,
+// in which case instanced batches are drawn one instance at a time.
+//
+
+static void Render_CreateInstancingProgram(void)
+{
+	gInstancingProgram = 0;
+
+	if (!gCanUseInstancing)
+		return;
+
+	char defines[64];
+	snprintf(defines, sizeof(defines), "#version 110\n#define NUM_LIGHTS %d\n", MAX_FILL_LIGHTS);
+
+	const char* sources[3] = { defines, kLightingShaderFunction, kInstancingVertexShader };
+	const char* attribNames[4] = { "a_instanceColumn0", "a_instanceColumn1", "a_instanceColumn2", "a_instanceColumn3" };
+	const GLuint attribLocations[4] = { INSTANCE_MATRIX_ATTRIB, INSTANCE_MATRIX_ATTRIB+1, INSTANCE_MATRIX_ATTRIB+2, INSTANCE_MATRIX_ATTRIB+3 };
+
+	GLuint program = BuildVertexProgram(3, sources, 4, attribNames, attribLocations);
+	if (!program)
+		return;
+
+	gInstancingLightingUniform = glGetUniformLocation(program, "u_lighting");
+
+	glGenBuffers(1, &gInstanceBuffer);
+	CHECK_GL_ERROR();
+
+	gInstancingProgram = program;
+}
+
+bool Render_IsGPUSkinningEnabled(void)
+{
+	return gSkinningProgram != 0;
+}
+
+static void Render_GetGLProcAddresses(void)
+{
+#if !(__APPLE__)
+	#define GET_PROC_ADDRESS(t, name) \
+		procptr_##name = (t) SDL_GL_GetProcAddress(#name);
+
+	GET_PROC_ADDRESS(PFNGLGENBUFFERSPROC, glGenBuffers);
+	GET_PROC_ADDRESS(PFNGLDELETEBUFFERSPROC, glDeleteBuffers);
+	GET_PROC_ADDRESS(PFNGLBINDBUFFERPROC, glBindBuffer);
+	GET_PROC_ADDRESS(PFNGLBUFFERDATAPROC, glBufferData);
+	GET_PROC_ADDRESS(PFNGLBUFFERSUBDATAPROC, glBufferSubData);
+
+	gCanUseBufferObjects = procptr_glGenBuffers
+		&& procptr_glDeleteBuffers
+		&& procptr_glBindBuffer
+		&& procptr_glBufferData
+		&& procptr_glBufferSubData;
+
+	GET_PROC_ADDRESS(PFNGLCREATESHADERPROC, glCreateShader);
+	GET_PROC_ADDRESS(PFNGLDELETESHADERPROC, glDeleteShader);
+	GET_PROC_ADDRESS(PFNGLSHADERSOURCEPROC, glShaderSource);
+	GET_PROC_ADDRESS(PFNGLCOMPILESHADERPROC, glCompileShader);
+	GET_PROC_ADDRESS(PFNGLGETSHADERIVPROC, glGetShaderiv);
+	GET_PROC_ADDRESS(PFNGLGETSHADERINFOLOGPROC, glGetShaderInfoLog);
+	GET_PROC_ADDRESS(PFNGLCREATEPROGRAMPROC, glCreateProgram);
+	GET_PROC_ADDRESS(PFNGLDELETEPROGRAMPROC, glDeleteProgram);
+	GET_PROC_ADDRESS(PFNGLATTACHSHADERPROC, glAttachShader);
+	GET_PROC_ADDRESS(PFNGLBINDATTRIBLOCATIONPROC, glBindAttribLocation);
+	GET_PROC_ADDRESS(PFNGLLINKPROGRAMPROC, glLinkProgram);
+	GET_PROC_ADDRESS(PFNGLGETPROGRAMIVPROC, glGetProgramiv);
+	GET_PROC_ADDRESS(PFNGLGETPROGRAMINFOLOGPROC, glGetProgramInfoLog);
+	GET_PROC_ADDRESS(PFNGLUSEPROGRAMPROC, glUseProgram);
+	GET_PROC_ADDRESS(PFNGLGETUNIFORMLOCATIONPROC, glGetUniformLocation);
+	GET_PROC_ADDRESS(PFNGLUNIFORM1IPROC, glUniform1i);
+	GET_PROC_ADDRESS(PFNGLUNIFORM4FVPROC, glUniform4fv);
+	GET_PROC_ADDRESS(PFNGLVERTEXATTRIBPOINTERPROC, glVertexAttribPointer);
+	GET_PROC_ADDRESS(PFNGLENABLEVERTEXATTRIBARRAYPROC, glEnableVertexAttribArray);
+	GET_PROC_ADDRESS(PFNGLDISABLEVERTEXATTRIBARRAYPROC, glDisableVertexAttribArray);
+
+	#undef GET_PROC_ADDRESS
+
+	gCanUseShaders = procptr_glCreateShader
+		&& procptr_glDeleteShader
+		&& procptr_glShaderSource
+		&& procptr_glCompileShader
+		&& procptr_glGetShaderiv
+		&& procptr_glGetShaderInfoLog
+		&& procptr_glCreateProgram
+		&& procptr_glDeleteProgram
+		&& procptr_glAttachShader
+		&& procptr_glBindAttribLocation
+		&& procptr_glLinkProgram
+		&& procptr_glGetProgramiv
+		&& procptr_glGetProgramInfoLog
+		&& procptr_glUseProgram
+		&& procptr_glGetUniformLocation
+		&& procptr_glUniform1i
+		&& procptr_glUniform4fv
+		&& procptr_glVertexAttribPointer
+		&& procptr_glEnableVertexAttribArray
+		&& procptr_glDisableVertexAttribArray;
+#elif OSXPPC
+	// Buffer objects are core in OpenGL 1.5, and shaders in 2.0; some PowerPC Macs only go up to 1.3
+	const char* version = (const char*) glGetString(GL_VERSION);
+	gCanUseBufferObjects = version && (version[0] > '1' || (version[0] == '1' && version[2] >= '5'));
+	gCanUseShaders = version && version[0] >= '2';
+#else
+	gCanUseBufferObjects = true;
+	gCanUseShaders = true;
+#endif
+
+	// Instancing needs GL 3.3, or else the ARB extensions that it's made of
+	int major = 0;
+	int minor = 0;
+	const char* glVersion = (const char*) glGetString(GL_VERSION);
+	if (glVersion)
+		sscanf(glVersion, "%d.%d", &major, &minor);
+
+	procptr_glDrawElementsInstanced = NULL;
+	procptr_glVertexAttribDivisor = NULL;
+
+	if (major > 3 || (major == 3 && minor >= 3))
+	{
+		procptr_glDrawElementsInstanced = (DrawElementsInstancedProc) SDL_GL_GetProcAddress("glDrawElementsInstanced");
+		procptr_glVertexAttribDivisor = (VertexAttribDivisorProc) SDL_GL_GetProcAddress("glVertexAttribDivisor");
+	}
+	else if (SDL_GL_ExtensionSupported("GL_ARB_instanced_arrays") && SDL_GL_ExtensionSupported("GL_ARB_draw_instanced"))
+	{
+		procptr_glDrawElementsInstanced = (DrawElementsInstancedProc) SDL_GL_GetProcAddress("glDrawElementsInstancedARB");
+		procptr_glVertexAttribDivisor = (VertexAttribDivisorProc) SDL_GL_GetProcAddress("glVertexAttribDivisorARB");
+	}
+
+	gCanUseInstancing = gCanUseShaders
+		&& gCanUseBufferObjects
+		&& procptr_glDrawElementsInstanced
+		&& procptr_glVertexAttribDivisor;
+
+#if _DEBUG
+	printf("GL buffer objects: %s\n", gCanUseBufferObjects ? "yes" : "no");
+	printf("GL shaders: %s\n", gCanUseShaders ? "yes" : "no");
+	printf("GL instancing: %s\n", gCanUseInstancing ? "yes" : "no");
+#endif
+}
+
 void Render_CreateContext(void)
 {
 	gGLContext = SDL_GL_CreateContext(gSDLWindow);
@@ -237,7 +756,12 @@ void Render_CreateContext(void)
 
 	// On Windows, proc addresses are only valid for the current context,
 	// so we must get proc addresses everytime we recreate the context.
-	//Render_GetGLProcAddresses();
+	Render_GetGLProcAddresses();
+
+	if (gCommandLine.gpuSkinning)
+		Render_CreateSkinningProgram();
+
+	Render_CreateInstancingProgram();
 }
 
 void Render_DeleteContext(void)
@@ -247,6 +771,20 @@ void Render_DeleteContext(void)
 		SDL_GL_DeleteContext(gGLContext);
 		gGLContext = NULL;
 	}
+
+	// The shader programs went away with the context
+	gSkinningProgram = 0;
+	gInstancingProgram = 0;
+	gInstanceBuffer = 0;
+
+	// The GL buffers went away with the context
+	if (gMeshBufferTable)
+	{
+		DisposePtr((Ptr) gMeshBufferTable);
+		gMeshBufferTable = nil;
+		gMeshBufferTableCapacity = 0;
+		gMeshBufferTableCount = 0;
+	}
 }
 
 void Render_SetDefaultModifiers(RenderModifiers* dest)
@@ -285,6 +823,28 @@ void Render_InitState(const TQ3ColorRGBA* clearColor)
 	gState.sceneHasFog = false;
 	gState.currentTransform = NULL;
 
+	if (gCanUseBufferObjects)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	}
+	gState.boundArrayBuffer = 0;			// must match glBindBuffer calls above!
+	gState.boundElementArrayBuffer = 0;
+
+	if (gSkinningProgram || gInstancingProgram)
+	{
+		glUseProgram(0);
+		glDisableVertexAttribArray(SKINNING_BONE_INDEX_ATTRIB);
+		for (int i = 0; i < 4; i++)
+			glDisableVertexAttribArray(INSTANCE_MATRIX_ATTRIB + i);
+	}
+	gState.currentProgram = 0;				// must match calls above!
+	gState.currentBonePalette = NULL;
+	gState.skinningLighting = -1;
+	gState.instancingLighting = -1;
+	gState.hasBoneIndexAttribArray = false;
+	gState.hasInstanceAttribArrays = false;
+
 	glClearColor(clearColor->r, clearColor->g, clearColor->b, 1.0f);
 	
 	// Set misc GL defaults that apply throughout the entire game
@@ -294,7 +854,7 @@ void Render_InitState(const TQ3ColorRGBA* clearColor)
 
 	// Set up mesh queue
 	gMeshQueueSize = 0;
-	memset(gMeshQueuePtrs, 0, sizeof(gMeshQueuePtrs));
+	gNumInstanceMatrices = 0;
 
 	// Set up fullscreen overlay quad
 	if (!gFullscreenQuad)
@@ -347,6 +907,7 @@ void Render_BindTexture(GLuint textureName)
 	{
 		glBindTexture(GL_TEXTURE_2D, textureName);
 		gState.boundTexture = textureName;
+		gRenderStats.stateChanges++;
 	}
 }
 
@@ -512,6 +1073,270 @@ void Render_Load3DMFTextures(TQ3MetaFile* metaFile, GLuint* outTextureNames, boo
 
 #pragma mark -
 
+/****************************/
+/*    STATIC MESH BUFFERS   */
+/****************************/
+
+static inline uint32_t HashMeshPointer(const TQ3TriMeshData* mesh)
+{
+	return (uint32_t) (((uintptr_t) mesh >> 4) * 2654435761u);
+}
+
+// Returns the record for this mesh, or the free slot where it should be inserted.
+static MeshBufferRecord* FindMeshBufferSlot(const TQ3TriMeshData* mesh)
+{
+	uint32_t mask = gMeshBufferTableCapacity - 1;
+	uint32_t i = HashMeshPointer(mesh) & mask;
+
+	while (gMeshBufferTable[i].mesh && gMeshBufferTable[i].mesh != mesh)
+		i = (i + 1) & mask;
+
+	return &gMeshBufferTable[i];
+}
+
+static void GrowMeshBufferTable(void)
+{
+	// Queued meshes point into the table, so don't move records around in the middle of a frame
+	GAME_ASSERT_MESSAGE(gMeshQueueSize == 0, "Can't grow mesh buffer table while meshes are queued");
+
+	MeshBufferRecord* oldTable = gMeshBufferTable;
+	int oldCapacity = gMeshBufferTableCapacity;
+
+	gMeshBufferTableCapacity = oldCapacity ? 2 * oldCapacity : 1024;
+	gMeshBufferTable = (MeshBufferRecord*) NewPtrClear(gMeshBufferTableCapacity * sizeof(MeshBufferRecord));
+	GAME_ASSERT(gMeshBufferTable);
+
+	for (int i = 0; i < oldCapacity; i++)
+	{
+		if (oldTable[i].mesh)
+			*FindMeshBufferSlot(oldTable[i].mesh) = oldTable[i];
+	}
+
+	if (oldTable)
+		DisposePtr((Ptr) oldTable);
+}
+
+static void UploadMeshBuffers(MeshBufferRecord* record)
+{
+	const TQ3TriMeshData* mesh = record->mesh;
+
+	const GLvoid* arrays[kMeshArray_COUNT] =
+	{
+		[kMeshArray_Points]		= mesh->points,
+		[kMeshArray_Normals]	= mesh->vertexNormals,
+		[kMeshArray_UVs]		= mesh->vertexUVs,
+		[kMeshArray_Colors]		= mesh->vertexColors,
+	};
+
+	const GLsizeiptr arraySizes[kMeshArray_COUNT] =
+	{
+		[kMeshArray_Points]		= mesh->numPoints * sizeof(mesh->points[0]),
+		[kMeshArray_Normals]	= mesh->numPoints * sizeof(mesh->vertexNormals[0]),
+		[kMeshArray_UVs]		= mesh->numPoints * sizeof(mesh->vertexUVs[0]),
+		[kMeshArray_Colors]		= mesh->numPoints * sizeof(mesh->vertexColors[0]),
+	};
+
+			/* LAY OUT ARRAYS BACK-TO-BACK IN VERTEX BUFFER */
+
+	GLsizeiptr vertexBufferSize = 0;
+	for (int a = 0; a < kMeshArray_COUNT; a++)
+	{
+		if (arrays[a])
+		{
+			record->offsets[a] = vertexBufferSize;
+			vertexBufferSize += arraySizes[a];
+		}
+		else
+		{
+			record->offsets[a] = -1;
+		}
+	}
+
+	GLsizeiptr indexBufferSize = mesh->numTriangles * sizeof(mesh->triangles[0]);
+
+	if (!record->vertexBuffer)
+		glGenBuffers(1, &record->vertexBuffer);
+
+	if (!record->indexBuffer)
+		glGenBuffers(1, &record->indexBuffer);
+
+			/* UPLOAD VERTEX DATA */
+
+	BindArrayBuffer(record->vertexBuffer);
+
+	if (vertexBufferSize != record->vertexBufferSize)					// (re)allocate storage if size changed
+	{
+		glBufferData(GL_ARRAY_BUFFER, vertexBufferSize, NULL, GL_STATIC_DRAW);
+		record->vertexBufferSize = vertexBufferSize;
+	}
+
+	for (int a = 0; a < kMeshArray_COUNT; a++)
+	{
+		if (arrays[a])
+			glBufferSubData(GL_ARRAY_BUFFER, record->offsets[a], arraySizes[a], arrays[a]);
+	}
+
+			/* UPLOAD INDEX DATA */
+
+	BindElementArrayBuffer(record->indexBuffer);
+
+	if (indexBufferSize != record->indexBufferSize)
+	{
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBufferSize, mesh->triangles, GL_STATIC_DRAW);
+		record->indexBufferSize = indexBufferSize;
+	}
+	else
+	{
+		glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indexBufferSize, mesh->triangles);
+	}
+
+	CHECK_GL_ERROR();
+
+	record->numPoints		= mesh->numPoints;
+	record->numTriangles	= mesh->numTriangles;
+	record->dirty			= false;
+}
+
+void Render_UploadStaticMesh(const TQ3TriMeshData* mesh)
+{
+	if (!gCanUseBufferObjects)									// no buffer objects -- mesh will be drawn from client arrays
+		return;
+
+	GAME_ASSERT(gGLContext);
+
+	if (2 * (gMeshBufferTableCount + 1) > gMeshBufferTableCapacity)	// keep load factor under 1/2
+		GrowMeshBufferTable();
+
+	MeshBufferRecord* record = FindMeshBufferSlot(mesh);
+
+	if (!record->mesh)
+	{
+		memset(record, 0, sizeof(*record));
+		record->mesh = mesh;
+		gMeshBufferTableCount++;
+	}
+
+	UploadMeshBuffers(record);
+}
+
+void Render_InvalidateStaticMesh(const TQ3TriMeshData* mesh)
+{
+	if (gMeshBufferTableCount == 0)
+		return;
+
+	MeshBufferRecord* record = FindMeshBufferSlot(mesh);
+
+	if (record->mesh)
+		record->dirty = true;
+}
+
+void Render_ReleaseStaticMesh(const TQ3TriMeshData* mesh)
+{
+	if (gMeshBufferTableCount == 0)
+		return;
+
+	MeshBufferRecord* record = FindMeshBufferSlot(mesh);
+
+	if (!record->mesh)											// mesh was never uploaded
+		return;
+
+	GAME_ASSERT_MESSAGE(gMeshQueueSize == 0, "Can't release mesh buffers while meshes are queued");
+
+			/* DELETE GL BUFFERS */
+
+	// Deleting a bound buffer reverts the binding to 0
+	if (gState.boundArrayBuffer == record->vertexBuffer)
+		gState.boundArrayBuffer = 0;
+	if (gState.boundElementArrayBuffer == record->indexBuffer)
+		gState.boundElementArrayBuffer = 0;
+
+	glDeleteBuffers(1, &record->vertexBuffer);
+	glDeleteBuffers(1, &record->indexBuffer);
+	CHECK_GL_ERROR();
+
+			/* REMOVE FROM TABLE (BACKWARD-SHIFT DELETION) */
+
+	uint32_t mask = gMeshBufferTableCapacity - 1;
+	uint32_t hole = (uint32_t) (record - gMeshBufferTable);
+	uint32_t i = hole;
+
+	while (true)
+	{
+		i = (i + 1) & mask;
+
+		if (!gMeshBufferTable[i].mesh)
+			break;
+
+		uint32_t home = HashMeshPointer(gMeshBufferTable[i].mesh) & mask;
+
+		if (((i - home) & mask) >= ((i - hole) & mask))			// hole is on this record's probe path: shift it back
+		{
+			gMeshBufferTable[hole] = gMeshBufferTable[i];
+			hole = i;
+		}
+	}
+
+	memset(&gMeshBufferTable[hole], 0, sizeof(MeshBufferRecord));
+	gMeshBufferTableCount--;
+}
+
+static const MeshBufferRecord* LookUpMeshBuffers(const TQ3TriMeshData* mesh)
+{
+	if (gMeshBufferTableCount == 0)
+		return NULL;
+
+	MeshBufferRecord* record = FindMeshBufferSlot(mesh);
+
+	if (!record->mesh)											// not a static mesh
+		return NULL;
+
+	if (record->dirty
+		|| record->numPoints != mesh->numPoints
+		|| record->numTriangles != mesh->numTriangles)
+	{
+		UploadMeshBuffers(record);
+	}
+
+	return record;
+}
+
+// Returns a pointer suitable for gl*Pointer: an offset into the mesh's
+// vertex buffer if the mesh lives on the GPU, or else the client-side array.
+static const GLvoid* GetMeshArray(const MeshQueueEntry* entry, int whichArray)
+{
+	if (entry->buffers)
+	{
+		GAME_ASSERT(entry->buffers->offsets[whichArray] >= 0);
+		BindArrayBuffer(entry->buffers->vertexBuffer);
+		return (const GLvoid*) entry->buffers->offsets[whichArray];
+	}
+
+	BindArrayBuffer(0);
+
+	switch (whichArray)
+	{
+		case kMeshArray_Points:		return entry->mesh->points;
+		case kMeshArray_Normals:	return entry->mesh->vertexNormals;
+		case kMeshArray_UVs:		return entry->mesh->vertexUVs;
+		case kMeshArray_Colors:		return entry->mesh->vertexColors;
+		default:					return NULL;
+	}
+}
+
+static const GLvoid* GetMeshIndices(const MeshQueueEntry* entry)
+{
+	if (entry->buffers)
+	{
+		BindElementArrayBuffer(entry->buffers->indexBuffer);
+		return NULL;											// offset 0 into the index buffer
+	}
+
+	BindElementArrayBuffer(0);
+	return entry->mesh->triangles;
+}
+
+#pragma mark -
+
 void Render_StartFrame(void)
 {
 	int mkc = SDL_GL_MakeCurrent(gSDLWindow, gGLContext);
@@ -522,11 +1347,15 @@ void Render_StartFrame(void)
 
 	// Clear mesh queue
 	gMeshQueueSize = 0;
+	gNumInstanceMatrices = 0;
 
 	// Clear stats
 	gRenderStats.meshesPass1 = 0;
 	gRenderStats.meshesPass2 = 0;
 	gRenderStats.triangles = 0;
+	gRenderStats.drawCalls = 0;
+	gRenderStats.stateChanges = 0;
+	gRenderStats.batchedMeshes = 0;
 
 	// Clear color & depth buffers.
 	SetFlag(glDepthMask, true);	// The depth mask must be re-enabled so we can clear the depth buffer.
@@ -558,16 +1387,24 @@ void Render_FlushQueue(void)
 	if (gMeshQueueSize == 0)
 		return;
 
+	Profiler_BeginZone(PROFILER_ZONE_FLUSH_QUEUE);
+
+	// Skeletons may have updated their palettes since the last flush
+	gState.currentBonePalette = NULL;
+
+	// Send the matrices of all instanced batches to the GPU in one go
+	if (gNumInstanceMatrices > 0)
+	{
+		BindArrayBuffer(gInstanceBuffer);
+		glBufferData(GL_ARRAY_BUFFER, gNumInstanceMatrices * sizeof(TQ3Matrix4x4), gInstanceMatrices, GL_STREAM_DRAW);
+		CHECK_GL_ERROR();
+	}
+
 	//--------------------------------------------------------------
 	// SORT DRAW QUEUE ENTRIES
 	// Opaque meshes are sorted front-to-back,
 	// followed by transparent meshes, sorted back-to-front.
-	qsort(
-			gMeshQueuePtrs,
-			gMeshQueueSize,
-			sizeof(gMeshQueuePtrs[0]),
-			DrawOrderComparator
-	);
+	SortMeshQueue();
 
 	//--------------------------------------------------------------
 	// PASS 1: OPAQUE COLOR + DEPTH
@@ -575,6 +1412,7 @@ void Render_FlushQueue(void)
 	// - Draw transparent meshes (pre-sorted back-to-front after opaque meshes) to depth buffer only.
 
 	int numDeferredColorMeshes = 0;
+	const MeshQueueEntry* prevOpaqueEntry = NULL;
 
 	glDepthFunc(GL_LESS);
 	DisableState(GL_BLEND);
@@ -585,10 +1423,30 @@ void Render_FlushQueue(void)
 
 		if (!entry->meshIsTransparent)
 		{
-			// If the mesh is opaque, draw it now
-			BeginShadingPass(entry);
-			PrepareOpaqueShading(entry);
+			// If the mesh is opaque, draw it now.
+			// Try to fold the next few meshes into a single draw call first.
+			const MeshQueueEntry* stateEntry = entry;
+			int numMerged = MergeOpaqueRun(i);
+			if (numMerged > 1)
+			{
+				entry = &gMergedEntry;
+				i += numMerged - 1;
+				gRenderStats.batchedMeshes += numMerged;
+			}
+
+			if (prevOpaqueEntry && IsSameShadingState(prevOpaqueEntry, entry))
+			{
+				// Same state as previous mesh: only point GL to the new vertex arrays
+				SendShadingArrays(entry);
+			}
+			else
+			{
+				BeginShadingPass(entry);
+				PrepareOpaqueShading(entry);
+			}
+
 			SendGeometry(entry);
+			prevOpaqueEntry = stateEntry;		// (not gMergedEntry, which gets overwritten by the next merge)
 		}
 		else
 		{
@@ -601,6 +1459,7 @@ void Render_FlushQueue(void)
 			{
 				BeginDepthPass(entry);
 				SendGeometry(entry);
+				prevOpaqueEntry = NULL;						// depth pass clobbered the shading state
 			}
 		}
 	}
@@ -630,8 +1489,9 @@ void Render_FlushQueue(void)
 	//--------------------------------------------------------------
 	// CLEAN UP
 
-	// Clear mesh draw queue
+	// Clear mesh draw queue (but keep its storage for the next frame)
 	gMeshQueueSize = 0;
+	gNumInstanceMatrices = 0;
 
 	// Clear transform
 	if (NULL != gState.currentTransform)
@@ -639,6 +1499,11 @@ void Render_FlushQueue(void)
 		glPopMatrix();
 		gState.currentTransform = NULL;
 	}
+
+	// Leave the fixed-function pipeline on for code that draws outside the queue
+	DisableShaders();
+
+	Profiler_EndZone(PROFILER_ZONE_FLUSH_QUEUE);
 }
 
 void Render_EndFrame(void)
@@ -647,6 +1512,9 @@ void Render_EndFrame(void)
 
 	Render_FlushQueue();
 
+	gRenderStats.queueCapacity = gMeshQueueCapacity;
+	gRenderStats.queueHighWaterMark = gMeshQueueHighWaterMark;
+
 	gFrameStarted = false;
 }
 
@@ -700,11 +1568,152 @@ static bool IsMeshTransparent(const TQ3TriMeshData* mesh, const RenderModifiers*
 	;
 }
 
+// Packs everything that determines draw order into a single integer so that
+// sorting the queue is a matter of sorting plain 64-bit keys.
+//
+//   63......56  55  54.........31  30...........7  6.....0
+//   drawOrder   T   depth          texture          state
+//
+// T = transparent: opaque meshes go first.
+// Depth is flipped for transparent meshes so they're drawn back-to-front.
+// Texture and state come last so that meshes at roughly the same depth
+// are grouped by GL state; they never override the depth order.
+static uint64_t MakeSortKey(const MeshQueueEntry* entry)
+{
+	static const uint32_t kStateBits[] =
+	{
+		STATUS_BIT_REFLECTIONMAP,
+		STATUS_BIT_GLOW,
+		STATUS_BIT_NULLSHADER,
+		STATUS_BIT_NOZWRITE,
+		STATUS_BIT_NOFOG,
+		STATUS_BIT_KEEPBACKFACES,
+		STATUS_BIT_KEEPBACKFACES_2PASS,
+	};
+	_Static_assert((STATUS_BIT_REFLECTIONMAP | STATUS_BIT_GLOW | STATUS_BIT_NULLSHADER | STATUS_BIT_NOZWRITE
+			| STATUS_BIT_NOFOG | STATUS_BIT_KEEPBACKFACES | STATUS_BIT_KEEPBACKFACES_2PASS) == SHADING_STATUS_BITS,
+			"sort key state bits out of sync with SHADING_STATUS_BITS");
+	_Static_assert(sizeof(kStateBits) / sizeof(kStateBits[0]) <= 7, "too many state bits for sort key");
+
+	uint64_t drawOrder = (uint8_t) (entry->mods->drawOrder - kDrawOrder_Terrain);	// bias to 0..255
+
+	// Make the float's bit pattern sort like an unsigned integer
+	union { float f; uint32_t u; } depthBits = { .f = entry->depth };
+	uint32_t depth = (depthBits.u & 0x80000000u) ? ~depthBits.u : (depthBits.u | 0x80000000u);
+	depth >>= 8;													// keep 24 bits
+	if (entry->meshIsTransparent)
+		depth = ~depth & 0xFFFFFF;
+
+	uint64_t texture = entry->mesh->glTextureName & 0xFFFFFF;
+
+	uint64_t state = 0;
+	for (int i = 0; i < (int) (sizeof(kStateBits) / sizeof(kStateBits[0])); i++)
+	{
+		if (entry->mods->statusBits & kStateBits[i])
+			state |= 1 << i;
+	}
+
+	return    (drawOrder					<< 56)
+			| ((uint64_t) entry->meshIsTransparent << 55)
+			| ((uint64_t) depth			<< 31)
+			| (texture					<< 7)
+			| state;
+}
+
+/****************** RESERVE MESH QUEUE ********************/
+//
+// Makes sure the queue can hold `numNewEntries` more entries,
+// growing the storage (by doubling) if needed.
+//
+
+static void ReserveMeshQueue(int numNewEntries)
+{
+	int needed = gMeshQueueSize + numNewEntries;
+
+	if (needed <= gMeshQueueCapacity)
+		return;
+
+	int newCapacity = gMeshQueueCapacity ? gMeshQueueCapacity : MESHQUEUE_INITIAL_CAPACITY;
+	while (newCapacity < needed)
+		newCapacity *= 2;
+
+			/* MOVE LIVE ENTRIES TO NEW POOL */
+
+	MeshQueueEntry* newPool = (MeshQueueEntry*) NewPtr(newCapacity * sizeof(MeshQueueEntry));
+	GAME_ASSERT(newPool);
+
+	if (gMeshQueueEntryPool)
+	{
+		memcpy(newPool, gMeshQueueEntryPool, gMeshQueueSize * sizeof(MeshQueueEntry));
+		DisposePtr((Ptr) gMeshQueueEntryPool);
+	}
+	gMeshQueueEntryPool = newPool;
+
+			/* SCRATCH ARRAYS ARE ONLY FILLED AT FLUSH TIME -- NO NEED TO COPY THEM */
+
+	if (gMeshQueuePtrs)
+		DisposePtr((Ptr) gMeshQueuePtrs);
+	gMeshQueuePtrs = (MeshQueueEntry**) NewPtr(newCapacity * sizeof(MeshQueueEntry*));
+	GAME_ASSERT(gMeshQueuePtrs);
+
+	for (int i = 0; i < 2; i++)
+	{
+		if (gMeshSortBuffers[i])
+			DisposePtr((Ptr) gMeshSortBuffers[i]);
+		gMeshSortBuffers[i] = (MeshSortItem*) NewPtr(newCapacity * sizeof(MeshSortItem));
+		GAME_ASSERT(gMeshSortBuffers[i]);
+	}
+
+#if _DEBUG
+	if (gMeshQueueCapacity != 0)
+		printf("Mesh queue grown to %d entries\n", newCapacity);
+#endif
+
+	gMeshQueueCapacity = newCapacity;
+}
+
+// Copies a batch's matrices to the staging array that gets uploaded to gInstanceBuffer
+// at flush time. Returns the index of the batch's first matrix.
+static int StageInstanceMatrices(int numInstances, const RenderInstance* instances)
+{
+	int needed = gNumInstanceMatrices + numInstances;
+
+	if (needed > gInstanceMatricesCapacity)
+	{
+		int newCapacity = gInstanceMatricesCapacity ? gInstanceMatricesCapacity : 1024;
+		while (newCapacity < needed)
+			newCapacity *= 2;
+
+		TQ3Matrix4x4* newMatrices = (TQ3Matrix4x4*) NewPtr(newCapacity * sizeof(TQ3Matrix4x4));
+		GAME_ASSERT(newMatrices);
+
+		if (gInstanceMatrices)
+		{
+			memcpy(newMatrices, gInstanceMatrices, gNumInstanceMatrices * sizeof(TQ3Matrix4x4));
+			DisposePtr((Ptr) gInstanceMatrices);
+		}
+		gInstanceMatrices = newMatrices;
+		gInstanceMatricesCapacity = newCapacity;
+	}
+
+	int first = gNumInstanceMatrices;
+	for (int i = 0; i < numInstances; i++)
+		gInstanceMatrices[first + i] = *instances[i].transform;
+	gNumInstanceMatrices = needed;
+
+	return first;
+}
+
 static MeshQueueEntry* NewMeshQueueEntry(void)
 {
+	GAME_ASSERT(gMeshQueueSize < gMeshQueueCapacity);		// caller must ReserveMeshQueue first
+
 	MeshQueueEntry* entry = &gMeshQueueEntryPool[gMeshQueueSize];
-	gMeshQueuePtrs[gMeshQueueSize] = entry;
 	gMeshQueueSize++;
+
+	if (gMeshQueueSize > gMeshQueueHighWaterMark)
+		gMeshQueueHighWaterMark = gMeshQueueSize;
+
 	return entry;
 }
 
@@ -719,7 +1728,7 @@ void Render_SubmitMeshList(
 		printf("not drawing this!\n");
 
 	GAME_ASSERT(gFrameStarted);
-	GAME_ASSERT(gMeshQueueSize + numMeshes <= MESHQUEUE_MAX_SIZE);
+	ReserveMeshQueue(numMeshes);
 
 	float depth = GetDepth(numMeshes, meshList, centerCoord);
 
@@ -729,8 +1738,16 @@ void Render_SubmitMeshList(
 		entry->mesh				= meshList[i];
 		entry->transform		= transform;
 		entry->mods				= mods ? mods : &kDefaultRenderMods;
+		entry->buffers			= LookUpMeshBuffers(entry->mesh);
+		entry->instances		= NULL;
+		entry->numInstances		= 0;
+		entry->firstInstance	= -1;
+		entry->boneIndices		= NULL;
+		entry->bonePalette		= NULL;
+		entry->numBones			= 0;
 		entry->depth			= depth;
 		entry->meshIsTransparent= IsMeshTransparent(entry->mesh, entry->mods);
+		entry->sortKey			= MakeSortKey(entry);
 
 		gRenderStats.meshesPass1++;
 		gRenderStats.triangles += entry->mesh->numTriangles;
@@ -746,14 +1763,22 @@ void Render_SubmitMesh(
 		const TQ3Point3D*		centerCoord)
 {
 	GAME_ASSERT(gFrameStarted);
-	GAME_ASSERT(gMeshQueueSize < MESHQUEUE_MAX_SIZE);
+	ReserveMeshQueue(1);
 
 	MeshQueueEntry* entry = NewMeshQueueEntry();
 	entry->mesh				= mesh;
 	entry->transform		= transform;
 	entry->mods				= mods ? mods : &kDefaultRenderMods;
+	entry->buffers			= LookUpMeshBuffers(mesh);
+	entry->instances		= NULL;
+	entry->numInstances		= 0;
+	entry->firstInstance	= -1;
+	entry->boneIndices		= NULL;
+	entry->bonePalette		= NULL;
+	entry->numBones			= 0;
 	entry->depth			= GetDepth(1, (TQ3TriMeshData **) &mesh, centerCoord);
 	entry->meshIsTransparent= IsMeshTransparent(entry->mesh, entry->mods);
+	entry->sortKey			= MakeSortKey(entry);
 
 	gRenderStats.meshesPass1++;
 	gRenderStats.triangles += entry->mesh->numTriangles;
@@ -761,58 +1786,468 @@ void Render_SubmitMesh(
 	GAME_ASSERT(!(entry->mods->statusBits & STATUS_BIT_HIDDEN));
 }
 
+void Render_SubmitMeshListInstanced(
+		int						numMeshes,
+		TQ3TriMeshData**		meshList,
+		const RenderModifiers*	mods,
+		int						numInstances,
+		const RenderInstance*	instances)
+{
+	GAME_ASSERT(gFrameStarted);
+
+	if (!mods)
+		mods = &kDefaultRenderMods;
+
+			/* SEE IF THESE MESHES CAN BE DRAWN AS ONE BATCH */
+			//
+			// Transparent meshes must be depth-sorted individually,
+			// and reflection-mapped meshes need per-instance UVs.
+			//
+
+	bool canInstance = numInstances > 1 && !(mods->statusBits & (STATUS_BIT_REFLECTIONMAP | STATUS_BIT_KEEPBACKFACES_2PASS));
+
+	for (int i = 0; canInstance && i < numMeshes; i++)
+	{
+		if (IsMeshTransparent(meshList[i], mods))
+			canInstance = false;
+	}
+
+	if (!canInstance)
+	{
+		for (int i = 0; i < numInstances; i++)
+			Render_SubmitMeshList(numMeshes, meshList, instances[i].transform, mods, instances[i].centerCoord);
+		return;
+	}
+
+			/* THE BATCH IS SORTED BY ITS NEAREST INSTANCE */
+
+	float depth = WorldPointToDepth(*instances[0].centerCoord);
+	for (int i = 1; i < numInstances; i++)
+	{
+		float d = WorldPointToDepth(*instances[i].centerCoord);
+		if (d < depth)
+			depth = d;
+	}
+
+			/* ALL MESHES SHARE THE SAME INSTANCE MATRICES ON THE GPU */
+
+	int firstInstance = gInstancingProgram ? StageInstanceMatrices(numInstances, instances) : -1;
+
+			/* QUEUE ONE ENTRY PER MESH */
+
+	ReserveMeshQueue(numMeshes);
+
+	for (int i = 0; i < numMeshes; i++)
+	{
+		MeshQueueEntry* entry = NewMeshQueueEntry();
+		entry->mesh				= meshList[i];
+		entry->transform		= NULL;
+		entry->mods				= mods;
+		entry->buffers			= LookUpMeshBuffers(entry->mesh);
+		entry->instances		= instances;
+		entry->numInstances		= numInstances;
+		entry->firstInstance	= firstInstance;
+		entry->boneIndices		= NULL;
+		entry->bonePalette		= NULL;
+		entry->numBones			= 0;
+		entry->depth			= depth;
+		entry->meshIsTransparent= false;
+		entry->sortKey			= MakeSortKey(entry);
+
+		gRenderStats.meshesPass1 += numInstances;
+		gRenderStats.triangles += entry->mesh->numTriangles * numInstances;
+	}
+
+	GAME_ASSERT(!(mods->statusBits & STATUS_BIT_HIDDEN));
+}
+
+void Render_SubmitSkinnedMeshList(
+		int						numMeshes,
+		TQ3TriMeshData**		bindPoseMeshes,
+		GLfloat**				boneIndices,
+		int						numBones,
+		const GLfloat*			bonePalette,
+		const RenderModifiers*	mods,
+		const TQ3Point3D*		centerCoord)
+{
+	GAME_ASSERT(gFrameStarted);
+	GAME_ASSERT(gSkinningProgram);
+	GAME_ASSERT(numBones <= MAX_JOINTS);
+	ReserveMeshQueue(numMeshes);
+
+	float depth = GetDepth(numMeshes, bindPoseMeshes, centerCoord);
+
+	for (int i = 0; i < numMeshes; i++)
+	{
+		MeshQueueEntry* entry = NewMeshQueueEntry();
+		entry->mesh				= bindPoseMeshes[i];
+		entry->transform		= NULL;
+		entry->mods				= mods ? mods : &kDefaultRenderMods;
+		entry->buffers			= LookUpMeshBuffers(entry->mesh);
+		entry->instances		= NULL;
+		entry->numInstances		= 0;
+		entry->firstInstance	= -1;
+		entry->boneIndices		= boneIndices[i];
+		entry->bonePalette		= bonePalette;
+		entry->numBones			= numBones;
+		entry->depth			= depth;
+		entry->meshIsTransparent= IsMeshTransparent(entry->mesh, entry->mods);
+		entry->sortKey			= MakeSortKey(entry);
+
+		gRenderStats.meshesPass1++;
+		gRenderStats.triangles += entry->mesh->numTriangles;
+
+		GAME_ASSERT(!(entry->mods->statusBits & (STATUS_BIT_HIDDEN | STATUS_BIT_REFLECTIONMAP)));
+	}
+}
+
 #pragma mark -
 
-static int DrawOrderComparator(const void* a_void, const void* b_void)
+/****************** SORT MESH QUEUE ********************/
+//
+// LSD radix sort on the entries' 64-bit sort keys, one byte at a time.
+// The sort is stable, so meshes with identical keys keep their submission order.
+// Passes where every key has the same byte (e.g. a single draw order) are skipped.
+//
+// OUTPUT: gMeshQueuePtrs in draw order
+//
+
+static void SortMeshQueue(void)
 {
-	static const int AFirst		= -1;
-	static const int BFirst		= +1;
-	static const int DontCare	= 0;
+	uint32_t counts[8][256];
+	MeshSortItem* src = gMeshSortBuffers[0];
+	MeshSortItem* dst = gMeshSortBuffers[1];
+	const int n = gMeshQueueSize;
+
+			/* GATHER KEYS & BUILD HISTOGRAMS FOR ALL 8 DIGITS IN ONE GO */
+
+	memset(counts, 0, sizeof(counts));
+
+	for (int i = 0; i < n; i++)
+	{
+		uint64_t key = gMeshQueueEntryPool[i].sortKey;		// pool is in submission order
+		src[i].key = key;
+		src[i].entry = &gMeshQueueEntryPool[i];
+
+		for (int d = 0; d < 8; d++)
+			counts[d][(key >> (8 * d)) & 0xFF]++;
+	}
+
+			/* SCATTER */
 
-	const MeshQueueEntry* a = *(MeshQueueEntry**) a_void;
-	const MeshQueueEntry* b = *(MeshQueueEntry**) b_void;
+	for (int d = 0; d < 8; d++)
+	{
+		uint32_t* digitCounts = counts[d];
+		int shift = 8 * d;
+
+		if (digitCounts[(src[0].key >> shift) & 0xFF] == (uint32_t) n)	// all keys share this digit
+			continue;
+
+		uint32_t offset = 0;										// turn counts into starting offsets
+		for (int b = 0; b < 256; b++)
+		{
+			uint32_t c = digitCounts[b];
+			digitCounts[b] = offset;
+			offset += c;
+		}
 
-	// First check manual priority
+		for (int i = 0; i < n; i++)
+			dst[digitCounts[(src[i].key >> shift) & 0xFF]++] = src[i];
 
-	if (a->mods->drawOrder < b->mods->drawOrder)
-		return AFirst;
+		MeshSortItem* temp = src;
+		src = dst;
+		dst = temp;
+	}
 
-	if (a->mods->drawOrder > b->mods->drawOrder)
-		return BFirst;
+	for (int i = 0; i < n; i++)
+		gMeshQueuePtrs[i] = src[i].entry;
+}
 
-	// A and B have the same manual priority
-	// Compare their transparencies (opaque meshes go first)
+#pragma mark -
 
-	if (a->meshIsTransparent != b->meshIsTransparent)
+/****************** IS SAME SHADING STATE ********************/
+//
+// Returns true if drawing B right after A needs no GL state changes
+// other than pointing GL to B's vertex arrays (and B's transform).
+//
+
+static bool IsSameShadingState(const MeshQueueEntry* a, const MeshQueueEntry* b)
+{
+	const TQ3TriMeshData* ma = a->mesh;
+	const TQ3TriMeshData* mb = b->mesh;
+	uint32_t aBits = a->mods->statusBits & SHADING_STATUS_BITS;
+	uint32_t bBits = b->mods->statusBits & SHADING_STATUS_BITS;
+
+	if (aBits != bBits
+		|| (aBits & STATUS_BIT_REFLECTIONMAP)						// env map UVs are computed per mesh
+		|| a->meshIsTransparent != b->meshIsTransparent
+		|| ma->glTextureName != mb->glTextureName
+		|| ma->texturingMode != mb->texturingMode
+		|| ma->hasVertexNormals != mb->hasVertexNormals
+		|| ma->hasVertexColors != mb->hasVertexColors
+		|| (ma->vertexUVs == NULL) != (mb->vertexUVs == NULL))
 	{
-		return b->meshIsTransparent? AFirst: BFirst;
+		return false;
+	}
+
+	if (!ma->hasVertexColors)										// glColor4f derived from diffuse colors
+	{
+		if (0 != memcmp(&ma->diffuseColor, &mb->diffuseColor, sizeof(TQ3ColorRGBA))
+			|| 0 != memcmp(&a->mods->diffuseColor, &b->mods->diffuseColor, sizeof(TQ3ColorRGBA)))
+		{
+			return false;
+		}
 	}
 
-	// A and B have the same manual priority AND transparency
-	// Compare their depths
+	return true;
+}
+
+/****************** SEND SHADING ARRAYS ********************/
+//
+// Opaque shading pass for a mesh whose state was already set up by a previous
+// mesh (see IsSameShadingState): just submit the per-vertex arrays.
+//
+
+static void SendShadingArrays(const MeshQueueEntry* entry)
+{
+	if (gState.hasClientState_GL_TEXTURE_COORD_ARRAY)
+		glTexCoordPointer(2, GL_FLOAT, 0, GetMeshArray(entry, kMeshArray_UVs));
+
+	if (gState.hasClientState_GL_NORMAL_ARRAY)
+		glNormalPointer(GL_FLOAT, 0, GetMeshArray(entry, kMeshArray_Normals));
+
+	if (gState.hasClientState_GL_COLOR_ARRAY)
+		glColorPointer(4, GL_FLOAT, 0, GetMeshArray(entry, kMeshArray_Colors));
+}
+
+/****************** MERGE OPAQUE RUN ********************/
+//
+// Concatenates consecutive small, untransformed opaque meshes (starting at queue
+// index `first`) that share the same shading state into gMergedEntry.
+//
+// OUTPUT: number of queue entries that were merged (0 or 1 = nothing merged)
+//
+
+static bool IsMergeable(const MeshQueueEntry* entry)
+{
+	return !entry->meshIsTransparent
+		&& entry->transform == NULL
+		&& entry->instances == NULL
+		&& entry->bonePalette == NULL
+		&& entry->buffers == NULL									// already on the GPU, leave it there
+		&& entry->mesh->numPoints <= MERGE_MAX_MESH_POINTS
+		&& !(entry->mods->statusBits & STATUS_BIT_REFLECTIONMAP);
+}
+
+static int MergeOpaqueRun(int first)
+{
+	const MeshQueueEntry* head = gMeshQueuePtrs[first];
+
+	if (!IsMergeable(head))
+		return 0;
 
-	if (!a->meshIsTransparent)					// both A and B are OPAQUE meshes: order them front-to-back
+			/* FIND LENGTH OF RUN */
+
+	int numPoints = 0;
+	int numTriangles = 0;
+	int end = first;
+
+	while (end < gMeshQueueSize)
 	{
-		if (a->depth < b->depth)				// A is closer to the camera, draw it first
-			return AFirst;
+		const MeshQueueEntry* entry = gMeshQueuePtrs[end];
+
+		if (end != first && !(IsMergeable(entry) && IsSameShadingState(head, entry)))
+			break;
+
+		if (numPoints + entry->mesh->numPoints > MERGE_MAX_POINTS
+			|| numTriangles + entry->mesh->numTriangles > MERGE_MAX_TRIANGLES)
+			break;
 
-		if (a->depth > b->depth)				// B is closer to the camera, draw it first
-			return BFirst;
+		numPoints += entry->mesh->numPoints;
+		numTriangles += entry->mesh->numTriangles;
+		end++;
 	}
-	else										// both A and B are TRANSPARENT meshes: order them back-to-front
+
+	int count = end - first;
+	if (count < 2)
+		return count;
+
+			/* CONCATENATE GEOMETRY */
+
+	const TQ3TriMeshData* headMesh = head->mesh;
+	TQ3TriMeshData* merged = &gMergedMesh;
+
+	memset(merged, 0, sizeof(*merged));
+	merged->points				= gMergedPoints;
+	merged->triangles			= gMergedTriangles;
+	merged->vertexNormals		= headMesh->hasVertexNormals ? gMergedNormals : NULL;
+	merged->vertexUVs			= headMesh->vertexUVs ? gMergedUVs : NULL;
+	merged->vertexColors		= headMesh->hasVertexColors ? gMergedColors : NULL;
+	merged->hasVertexNormals	= headMesh->hasVertexNormals;
+	merged->hasVertexColors		= headMesh->hasVertexColors;
+	merged->diffuseColor		= headMesh->diffuseColor;
+	merged->texturingMode		= headMesh->texturingMode;
+	merged->glTextureName		= headMesh->glTextureName;
+	merged->numPoints			= 0;
+	merged->numTriangles		= 0;
+
+	for (int i = first; i < end; i++)
 	{
-		if (a->depth < b->depth)				// A is closer to the camera, draw it last
-			return BFirst;
+		const TQ3TriMeshData* mesh = gMeshQueuePtrs[i]->mesh;
+		int base = merged->numPoints;
+
+		memcpy(&merged->points[base], mesh->points, mesh->numPoints * sizeof(TQ3Point3D));
+		if (merged->vertexNormals)
+			memcpy(&merged->vertexNormals[base], mesh->vertexNormals, mesh->numPoints * sizeof(TQ3Vector3D));
+		if (merged->vertexUVs)
+			memcpy(&merged->vertexUVs[base], mesh->vertexUVs, mesh->numPoints * sizeof(TQ3Param2D));
+		if (merged->vertexColors)
+			memcpy(&merged->vertexColors[base], mesh->vertexColors, mesh->numPoints * sizeof(TQ3ColorRGBA));
+
+		for (int t = 0; t < mesh->numTriangles; t++)				// rebase indices
+		{
+			TQ3TriMeshTriangleData* dst = &merged->triangles[merged->numTriangles + t];
+			dst->pointIndices[0] = mesh->triangles[t].pointIndices[0] + base;
+			dst->pointIndices[1] = mesh->triangles[t].pointIndices[1] + base;
+			dst->pointIndices[2] = mesh->triangles[t].pointIndices[2] + base;
+		}
 
-		if (a->depth > b->depth)				// B is closer to the camera, draw it last
-			return AFirst;
+		merged->numPoints += mesh->numPoints;
+		merged->numTriangles += mesh->numTriangles;
 	}
 
-	return DontCare;
+	gMergedEntry				= *head;
+	gMergedEntry.mesh			= merged;
+	gMergedEntry.buffers		= NULL;
+
+	return count;
 }
 
 #pragma mark -
 
+static void SetTransform(const TQ3Matrix4x4* transform)
+{
+	if (gState.currentTransform != transform)
+	{
+		if (gState.currentTransform)	// nuke old transform
+			glPopMatrix();
+
+		if (transform)					// apply new transform
+		{
+			glPushMatrix();
+			glMultMatrixf((float*)transform->value);
+		}
+
+		gState.currentTransform = transform;
+		gRenderStats.stateChanges++;
+	}
+}
+
+static void UseProgram(GLuint program)
+{
+	if (gState.currentProgram != program)
+	{
+		glUseProgram(program);
+		gState.currentProgram = program;
+		gRenderStats.stateChanges++;
+	}
+}
+
+static void SetBoneIndexAttribArray(bool enable)
+{
+	if (enable != gState.hasBoneIndexAttribArray)
+	{
+		if (enable)
+			glEnableVertexAttribArray(SKINNING_BONE_INDEX_ATTRIB);
+		else
+			glDisableVertexAttribArray(SKINNING_BONE_INDEX_ATTRIB);
+		gState.hasBoneIndexAttribArray = enable;
+	}
+}
+
+static void SetInstanceAttribArrays(bool enable)
+{
+	if (enable != gState.hasInstanceAttribArrays)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			if (enable)
+			{
+				glEnableVertexAttribArray(INSTANCE_MATRIX_ATTRIB + i);
+				glVertexAttribDivisor(INSTANCE_MATRIX_ATTRIB + i, 1);		// advance once per instance
+			}
+			else
+			{
+				glDisableVertexAttribArray(INSTANCE_MATRIX_ATTRIB + i);
+			}
+		}
+		gState.hasInstanceAttribArrays = enable;
+	}
+}
+
+static void DisableShaders(void)
+{
+	if (gState.currentProgram)								// back to fixed-function
+		UseProgram(0);
+
+	SetBoneIndexAttribArray(false);
+	SetInstanceAttribArrays(false);
+}
+
+static void SetSkinning(const MeshQueueEntry* entry)
+{
+	UseProgram(gSkinningProgram);
+	SetInstanceAttribArrays(false);
+
+	if (gState.currentBonePalette != entry->bonePalette)		// new skeleton: upload its joint matrices
+	{
+		glUniform4fv(gSkinningPaletteUniform, 3 * entry->numBones, entry->bonePalette);
+		gState.currentBonePalette = entry->bonePalette;
+		gRenderStats.stateChanges++;
+	}
+
+	int lighting = gState.hasState_GL_LIGHTING;
+	if (gState.skinningLighting != lighting)
+	{
+		glUniform1i(gSkinningLightingUniform, lighting);
+		gState.skinningLighting = lighting;
+	}
+
+	SetBoneIndexAttribArray(true);
+
+	BindArrayBuffer(0);
+	glVertexAttribPointer(SKINNING_BONE_INDEX_ATTRIB, 1, GL_FLOAT, GL_FALSE, 0, entry->boneIndices);
+}
+
+static void SetInstancing(const MeshQueueEntry* entry)
+{
+	GAME_ASSERT(entry->firstInstance >= 0);
+
+	UseProgram(gInstancingProgram);
+	SetBoneIndexAttribArray(false);
+
+	int lighting = gState.hasState_GL_LIGHTING;
+	if (gState.instancingLighting != lighting)
+	{
+		glUniform1i(gInstancingLightingUniform, lighting);
+		gState.instancingLighting = lighting;
+	}
+
+	SetInstanceAttribArrays(true);
+
+	// Point the 4 column attributes at this batch's matrices
+	BindArrayBuffer(gInstanceBuffer);
+	GLintptr offset = entry->firstInstance * sizeof(TQ3Matrix4x4);
+	for (int i = 0; i < 4; i++)
+	{
+		glVertexAttribPointer(INSTANCE_MATRIX_ATTRIB + i, 4, GL_FLOAT, GL_FALSE, sizeof(TQ3Matrix4x4),
+				(const GLvoid*) (offset + i * 4 * sizeof(GLfloat)));
+	}
+
+	// The instance matrices replace the modelview transform
+	SetTransform(NULL);
+}
+
 static void SendGeometry(const MeshQueueEntry* entry)
 {
 	uint32_t statusBits = entry->mods->statusBits;
@@ -829,25 +2264,47 @@ static void SendGeometry(const MeshQueueEntry* entry)
 		glCullFace(GL_FRONT);		// Pass 1: draw backfaces (cull frontfaces)
 
 	// Submit vertex data
-	glVertexPointer(3, GL_FLOAT, 0, mesh->points);
+	glVertexPointer(3, GL_FLOAT, 0, GetMeshArray(entry, kMeshArray_Points));
+	const GLvoid* indices = GetMeshIndices(entry);
+
+	// Skinned or instanced on the GPU, or plain fixed-function
+	if (entry->bonePalette)
+		SetSkinning(entry);
+	else if (entry->instances && gInstancingProgram)
+		SetInstancing(entry);
+	else
+		DisableShaders();
 
-	// Submit transformation matrix if any
-	if (gState.currentTransform != entry->transform)
+	// Instanced mesh: the vertex arrays & GL state are shared by all instances
+	if (entry->instances)
 	{
-		if (gState.currentTransform)	// nuke old transform
-			glPopMatrix();
+		GAME_ASSERT(!(statusBits & STATUS_BIT_KEEPBACKFACES_2PASS));	// instancing is for opaque meshes only
 
-		if (entry->transform)			// apply new transform
+		if (gInstancingProgram)									// all instances in one call
 		{
-			glPushMatrix();
-			glMultMatrixf((float*)entry->transform->value);
+			glDrawElementsInstanced(GL_TRIANGLES, mesh->numTriangles*3, GL_UNSIGNED_INT, indices, entry->numInstances);
+			gRenderStats.drawCalls++;
+			CHECK_GL_ERROR();
+			return;
 		}
 
-		gState.currentTransform = entry->transform;
+		// No instancing on this GPU: just swap the transform between draws
+		for (int i = 0; i < entry->numInstances; i++)
+		{
+			SetTransform(entry->instances[i].transform);
+			glDrawElements(GL_TRIANGLES, mesh->numTriangles*3, GL_UNSIGNED_INT, indices);
+			gRenderStats.drawCalls++;
+		}
+		CHECK_GL_ERROR();
+		return;
 	}
 
+	// Submit transformation matrix if any
+	SetTransform(entry->transform);
+
 	// Draw the mesh
-	glDrawElements(GL_TRIANGLES, mesh->numTriangles*3, GL_UNSIGNED_INT, mesh->triangles);
+	glDrawElements(GL_TRIANGLES, mesh->numTriangles*3, GL_UNSIGNED_INT, indices);
+	gRenderStats.drawCalls++;
 	CHECK_GL_ERROR();
 
 	// Pass 2 to draw transparent meshes without face culling (see above for an explanation)
@@ -857,7 +2314,8 @@ static void SendGeometry(const MeshQueueEntry* entry)
 		glCullFace(GL_BACK);	// pass 2: draw frontfaces (cull backfaces)
 
 		// Draw the mesh again
-		glDrawElements(GL_TRIANGLES, mesh->numTriangles * 3, GL_UNSIGNED_INT, mesh->triangles);
+		glDrawElements(GL_TRIANGLES, mesh->numTriangles * 3, GL_UNSIGNED_INT, indices);
+		gRenderStats.drawCalls++;
 		CHECK_GL_ERROR();
 	}
 }
@@ -893,7 +2351,7 @@ static void BeginDepthPass(const MeshQueueEntry* entry)
 		EnableState(GL_TEXTURE_2D);
 		EnableClientState(GL_TEXTURE_COORD_ARRAY);
 		Render_BindTexture(mesh->glTextureName);
-		glTexCoordPointer(2, GL_FLOAT, 0, mesh->vertexUVs);
+		glTexCoordPointer(2, GL_FLOAT, 0, GetMeshArray(entry, kMeshArray_UVs));
 		CHECK_GL_ERROR();
 	}
 	else
@@ -931,7 +2389,15 @@ static void BeginShadingPass(const MeshQueueEntry* entry)
 		EnableState(GL_TEXTURE_2D);
 		EnableClientState(GL_TEXTURE_COORD_ARRAY);
 		Render_BindTexture(mesh->glTextureName);
-		glTexCoordPointer(2, GL_FLOAT, 0, (statusBits & STATUS_BIT_REFLECTIONMAP) ? gEnvMapUVs: mesh->vertexUVs);
+		if (statusBits & STATUS_BIT_REFLECTIONMAP)
+		{
+			BindArrayBuffer(0);									// env map UVs are computed on the CPU every frame
+			glTexCoordPointer(2, GL_FLOAT, 0, gEnvMapUVs);
+		}
+		else
+		{
+			glTexCoordPointer(2, GL_FLOAT, 0, GetMeshArray(entry, kMeshArray_UVs));
+		}
 		CHECK_GL_ERROR();
 	}
 	else
@@ -945,7 +2411,7 @@ static void BeginShadingPass(const MeshQueueEntry* entry)
 	if (mesh->hasVertexNormals && !(statusBits & STATUS_BIT_NULLSHADER))
 	{
 		EnableClientState(GL_NORMAL_ARRAY);
-		glNormalPointer(GL_FLOAT, 0, mesh->vertexNormals);
+		glNormalPointer(GL_FLOAT, 0, GetMeshArray(entry, kMeshArray_Normals));
 	}
 	else
 	{
@@ -971,7 +2437,7 @@ static void PrepareOpaqueShading(const MeshQueueEntry* entry)
 	{
 		EnableClientState(GL_COLOR_ARRAY);
 
-		glColorPointer(4, GL_FLOAT, 0, mesh->vertexColors);
+		glColorPointer(4, GL_FLOAT, 0, GetMeshArray(entry, kMeshArray_Colors));
 	}
 	else
 	{
@@ -1000,6 +2466,7 @@ static void PrepareAlphaShading(const MeshQueueEntry* entry)
 		else
 			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 		gState.blendFuncIsAdditive = wantAdditive;
+		gRenderStats.stateChanges++;
 	}
 
 	// Per-vertex colors
@@ -1019,6 +2486,7 @@ static void PrepareAlphaShading(const MeshQueueEntry* entry)
 			gBackupVertexColors[j++] = mesh->vertexColors[v].a * entry->mods->autoFadeFactor;
 		}
 
+		BindArrayBuffer(0);
 		glColorPointer(4, GL_FLOAT, 0, gBackupVertexColors);
 	}
 	else
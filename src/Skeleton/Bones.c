@@ -13,19 +13,27 @@
 
 #include <string.h>				// strcasecmp
 
+#include "simd4.h"
+
 
 /****************************/
 /*    PROTOTYPES            */
 /****************************/
 
 static void DecomposeATriMesh(SkeletonDefType* gCurrentSkeleton, TQ3TriMeshData* triMeshData);
+static void UpdateSkinnedGeometry_Reference(ObjNode *theNode);
 static void UpdateSkinnedGeometry_Recurse(ObjNode* skelNode, short joint);
+static void BuildSkinningStreams(SkeletonDefType *skeleton);
+static void UpdateGPUSkinPalette_Recurse(SkeletonObjDataType* skeleton, short joint, const TQ3Matrix4x4* parentMatrix);
 
 
 /****************************/
 /*    CONSTANTS             */
 /****************************/
 
+#define	MAX_SKIN_POINTS_SOA		(3 * (MAX_DECOMPOSED_POINTS + 3*MAX_JOINTS))		// worst case incl. padding
+#define	MAX_SKIN_NORMALS_SOA	(3 * (MAX_DECOMPOSED_NORMALS + 3*MAX_JOINTS))
+
 
 /*********************/
 /*    VARIABLES      */
@@ -38,6 +46,9 @@ static	TQ3BoundingBox		gBBox = {{0,0,0}, {0,0,0}, kQ3False};
 
 static	TQ3Vector3D			gTransformedNormals[MAX_DECOMPOSED_NORMALS];	// temporary buffer for holding transformed normals before they're applied to their trimeshes
 
+static	float				gSkinnedPointsSoA[MAX_SKIN_POINTS_SOA];			// output of the SIMD transform pass, input of the scatter pass
+static	float				gSkinnedNormalsSoA[MAX_SKIN_NORMALS_SOA];
+
 
 /******************** LOAD BONES REFERENCE MODEL *********************/
 //
@@ -175,13 +186,200 @@ added_norm:
 
 
 
+#pragma mark -
+
+/************************** SKIN SOA: POINTS *******************************/
+//
+// Transforms a bone's points (x's, then y's, then z's, `stride` of each) by m
+// and grows the running bbox.
+// The padding lanes hold copies of the last point, so they never extend the bbox.
+//
+
+static void SkinPointsSoA(const TQ3Matrix4x4* matrix, const float* src, float* dst, int stride,
+						Vec4* minX, Vec4* minY, Vec4* minZ, Vec4* maxX, Vec4* maxY, Vec4* maxZ)
+{
+	const float* m = &matrix->value[0][0];
+
+	Vec4 m00 = V4Splat(m[0]),	m01 = V4Splat(m[1]),	m02 = V4Splat(m[2]);
+	Vec4 m10 = V4Splat(m[4]),	m11 = V4Splat(m[5]),	m12 = V4Splat(m[6]);
+	Vec4 m20 = V4Splat(m[8]),	m21 = V4Splat(m[9]),	m22 = V4Splat(m[10]);
+	Vec4 m30 = V4Splat(m[12]),	m31 = V4Splat(m[13]),	m32 = V4Splat(m[14]);
+
+	for (int i = 0; i < stride; i += 4)
+	{
+		Vec4 x = V4Load(src + i);
+		Vec4 y = V4Load(src + stride + i);
+		Vec4 z = V4Load(src + 2*stride + i);
+
+		Vec4 newX = V4Add(V4Add(V4Add(V4Mul(m00, x), V4Mul(m10, y)), V4Mul(m20, z)), m30);
+		Vec4 newY = V4Add(V4Add(V4Add(V4Mul(m01, x), V4Mul(m11, y)), V4Mul(m21, z)), m31);
+		Vec4 newZ = V4Add(V4Add(V4Add(V4Mul(m02, x), V4Mul(m12, y)), V4Mul(m22, z)), m32);
+
+		V4Store(dst + i, newX);
+		V4Store(dst + stride + i, newY);
+		V4Store(dst + 2*stride + i, newZ);
+
+		*minX = V4Min(*minX, newX);		*maxX = V4Max(*maxX, newX);
+		*minY = V4Min(*minY, newY);		*maxY = V4Max(*maxY, newY);
+		*minZ = V4Min(*minZ, newZ);		*maxZ = V4Max(*maxZ, newZ);
+	}
+}
+
+
+/************************** SKIN SOA: NORMALS *******************************/
+//
+// Same as above, but only with the rotation part of the matrix.
+//
+
+static void SkinNormalsSoA(const TQ3Matrix4x4* matrix, const float* src, float* dst, int stride)
+{
+	const float* m = &matrix->value[0][0];
+
+	Vec4 m00 = V4Splat(m[0]),	m01 = V4Splat(m[1]),	m02 = V4Splat(m[2]);
+	Vec4 m10 = V4Splat(m[4]),	m11 = V4Splat(m[5]),	m12 = V4Splat(m[6]);
+	Vec4 m20 = V4Splat(m[8]),	m21 = V4Splat(m[9]),	m22 = V4Splat(m[10]);
+
+	for (int i = 0; i < stride; i += 4)
+	{
+		Vec4 x = V4Load(src + i);
+		Vec4 y = V4Load(src + stride + i);
+		Vec4 z = V4Load(src + 2*stride + i);
+
+		V4Store(dst + i,			V4Add(V4Add(V4Mul(m00, x), V4Mul(m10, y)), V4Mul(m20, z)));
+		V4Store(dst + stride + i,	V4Add(V4Add(V4Mul(m01, x), V4Mul(m11, y)), V4Mul(m21, z)));
+		V4Store(dst + 2*stride + i,	V4Add(V4Add(V4Mul(m02, x), V4Mul(m12, y)), V4Mul(m22, z)));
+	}
+}
+
+
 /************************** UPDATE SKINNED GEOMETRY *******************************/
 //
 // Updates all of the points in the local trimesh data's to coordinate with the
 // current joint transforms.
 //
+// Works in 3 passes over the streams built by BuildSkinningStreams:
+//   1. concatenate the joint matrices (parents before children),
+//   2. transform every bone's points & normals, 4 at a time, into SoA scratch buffers,
+//   3. scatter the results into the trimeshes.
+//
 
 void UpdateSkinnedGeometry(ObjNode *theNode)
+{
+TQ3Matrix4x4	boneMatrices[MAX_JOINTS];
+
+			/* MAKE SURE OBJNODE IS STILL VALID */
+			//
+			// (See comment in UpdateSkinnedGeometry_Reference)
+			//
+
+	if (theNode->CType == INVALID_NODE_FLAG)
+		return;
+
+	GAME_ASSERT(theNode->Skeleton);
+
+	SkeletonObjDataType* skeleton = theNode->Skeleton;
+	const SkeletonDefType* skeletonDef = skeleton->skeletonDefinition;
+	GAME_ASSERT(skeletonDef);
+	GAME_ASSERT(theNode->NumMeshes == skeletonDef->numDecomposedTriMeshes);
+
+	RefreshSkeletonJoints(skeleton);										// anim LOD may have skipped them
+	skeleton->SkinnedBaseTransform = theNode->BaseTransformMatrix;
+	skeleton->GeometryIsSkinned = true;
+
+			/* PASS 1: CONCATENATE JOINT MATRICES */
+
+	for (int i = 0; i < skeletonDef->NumBones; i++)
+	{
+		int b = skeletonDef->bonePreorder[i];
+		long parent = skeletonDef->Bones[b].parentBone;
+
+		if (skeleton->JointsAreGlobal)
+			boneMatrices[b] = skeleton->jointTransformMatrix[b];
+		else if (parent == NO_PREVIOUS_JOINT)
+			MatrixMultiply((TQ3Matrix4x4 *)&skeleton->jointTransformMatrix[b], &theNode->BaseTransformMatrix, &boneMatrices[b]);
+		else
+			MatrixMultiply((TQ3Matrix4x4 *)&skeleton->jointTransformMatrix[b], &boneMatrices[parent], &boneMatrices[b]);
+	}
+
+			/* PASS 2: TRANSFORM POINTS & NORMALS */
+
+	Vec4 minX = V4Splat(10000000), minY = minX, minZ = minX;
+	Vec4 maxX = V4Splat(-10000000), maxY = maxX, maxZ = maxX;
+
+	for (int b = 0; b < skeletonDef->NumBones; b++)
+	{
+		const SkinSpanType* pointSpan = &skeletonDef->skinPointSpans[b];
+		const SkinSpanType* normalSpan = &skeletonDef->skinNormalSpans[b];
+
+		SkinNormalsSoA(&boneMatrices[b],
+				skeletonDef->skinNormalsSoA + normalSpan->offset,
+				gSkinnedNormalsSoA + normalSpan->offset,
+				normalSpan->stride);
+
+		SkinPointsSoA(&boneMatrices[b],
+				skeletonDef->skinPointsSoA + pointSpan->offset,
+				gSkinnedPointsSoA + pointSpan->offset,
+				pointSpan->stride,
+				&minX, &minY, &minZ, &maxX, &maxY, &maxZ);
+	}
+
+			/* PASS 3: SCATTER INTO LOCAL TRIMESHES */
+
+	TQ3TriMeshData** localTriMeshes = theNode->MeshList;
+	const SkinScatterType* scatter = skeletonDef->skinScatterList;
+
+	for (long s = 0; s < skeletonDef->numSkinScatters; s++, scatter++)
+	{
+		TQ3TriMeshData* mesh = localTriMeshes[scatter->whichTriMesh];
+		TQ3Point3D* point = &mesh->points[scatter->whichPoint];
+		TQ3Vector3D* normal = &mesh->vertexNormals[scatter->whichPoint];
+		const float* p = gSkinnedPointsSoA + scatter->pointSrc;
+		const float* n = gSkinnedNormalsSoA + scatter->normalSrc;
+
+		point->x = p[0];
+		point->y = p[scatter->pointStride];
+		point->z = p[2 * scatter->pointStride];
+
+		normal->x = n[0];
+		normal->y = n[scatter->normalStride];
+		normal->z = n[2 * scatter->normalStride];
+	}
+
+			/* REDUCE BBOX LANES & APPLY TO ALL TRIMESHES */
+
+	float lanes[6][4];
+	V4Store(lanes[0], minX);	V4Store(lanes[1], minY);	V4Store(lanes[2], minZ);
+	V4Store(lanes[3], maxX);	V4Store(lanes[4], maxY);	V4Store(lanes[5], maxZ);
+
+	TQ3BoundingBox bbox;
+	bbox.min.x = lanes[0][0];	bbox.min.y = lanes[1][0];	bbox.min.z = lanes[2][0];
+	bbox.max.x = lanes[3][0];	bbox.max.y = lanes[4][0];	bbox.max.z = lanes[5][0];
+	bbox.isEmpty = kQ3False;
+
+	for (int i = 1; i < 4; i++)
+	{
+		if (lanes[0][i] < bbox.min.x) bbox.min.x = lanes[0][i];
+		if (lanes[1][i] < bbox.min.y) bbox.min.y = lanes[1][i];
+		if (lanes[2][i] < bbox.min.z) bbox.min.z = lanes[2][i];
+		if (lanes[3][i] > bbox.max.x) bbox.max.x = lanes[3][i];
+		if (lanes[4][i] > bbox.max.y) bbox.max.y = lanes[4][i];
+		if (lanes[5][i] > bbox.max.z) bbox.max.z = lanes[5][i];
+	}
+
+	for (int i = 0; i < theNode->NumMeshes; i++)
+	{
+		theNode->MeshList[i]->bBox = bbox;				// apply to local copy of trimesh
+	}
+}
+
+
+/************************** UPDATE SKINNED GEOMETRY: REFERENCE *******************************/
+//
+// Original scalar implementation, one point at a time.
+// Only kept around to validate & benchmark the SIMD path (see BenchmarkSkinning).
+//
+
+static void UpdateSkinnedGeometry_Reference(ObjNode *theNode)
 {
 			/* MAKE SURE OBJNODE IS STILL VALID */
 			//
@@ -200,6 +398,8 @@ void UpdateSkinnedGeometry(ObjNode *theNode)
 	const SkeletonDefType* skeletonDef = theNode->Skeleton->skeletonDefinition;
 	GAME_ASSERT(skeletonDef);
 
+	RefreshSkeletonJoints(theNode->Skeleton);
+
 	if (theNode->Skeleton->JointsAreGlobal)
 		Q3Matrix4x4_SetIdentity(&gMatrix);
 	else
@@ -455,14 +655,494 @@ long	i,b,j;
 			}
 		}
 	}
+
+			/* LAY OUT POINTS & NORMALS FOR SIMD SKINNING */
+
+	BuildSkinningStreams(skeleton);
 }
 
 
+/******************* BUILD SKINNING STREAMS *********************/
+//
+// Copies each bone's points & normals into SoA arrays (see SkinSpanType),
+// and flattens the decomposed point references into a scatter list.
+//
+// The scatter list reproduces the reference code's write order: if a vertex is
+// reached from several bones, the last bone in depth-first order wins; and a vertex
+// takes its normal as transformed by the latest bone (so far) that lists that normal.
+//
+
+static void BuildSkinningStreams(SkeletonDefType *skeleton)
+{
+int			numBones = skeleton->NumBones;
+int			stackDepth = 0;
+Byte		stack[MAX_JOINTS];
+
+	GAME_ASSERT(numBones <= MAX_JOINTS);
+
+			/* SORT BONES DEPTH-FIRST (SAME ORDER AS RECURSION) */
+
+	int numSorted = 0;
+	stack[stackDepth++] = 0;
+	while (stackDepth > 0)
+	{
+		int b = stack[--stackDepth];
+		skeleton->bonePreorder[numSorted++] = b;
+
+		for (int c = skeleton->numChildren[b] - 1; c >= 0; c--)			// push in reverse so 1st child pops 1st
+			stack[stackDepth++] = skeleton->childIndecies[b][c];
+	}
+	GAME_ASSERT_MESSAGE(numSorted == numBones, "some bones aren't connected to the base joint");
+
+			/* ASSIGN SOA SPANS */
+
+	long pointsSize = 0;
+	long normalsSize = 0;
+
+	for (int b = 0; b < numBones; b++)
+	{
+		const BoneDefinitionType* bonePtr = &skeleton->Bones[b];
+		SkinSpanType* pointSpan = &skeleton->skinPointSpans[b];
+		SkinSpanType* normalSpan = &skeleton->skinNormalSpans[b];
+
+		pointSpan->offset	= pointsSize;
+		pointSpan->count	= bonePtr->numPointsAttachedToBone;
+		pointSpan->stride	= (pointSpan->count + 3) & ~3;
+		pointsSize			+= 3 * pointSpan->stride;
+
+		normalSpan->offset	= normalsSize;
+		normalSpan->count	= bonePtr->numNormalsAttachedToBone;
+		normalSpan->stride	= (normalSpan->count + 3) & ~3;
+		normalsSize			+= 3 * normalSpan->stride;
+	}
+
+	GAME_ASSERT(pointsSize <= MAX_SKIN_POINTS_SOA);
+	GAME_ASSERT(normalsSize <= MAX_SKIN_NORMALS_SOA);
+
+	skeleton->skinPointsSoASize = pointsSize;
+	skeleton->skinNormalsSoASize = normalsSize;
+	skeleton->skinPointsSoA = (float*) AllocPtr(sizeof(float) * (pointsSize + 1));		// +1: never alloc 0 bytes
+	skeleton->skinNormalsSoA = (float*) AllocPtr(sizeof(float) * (normalsSize + 1));
+
+			/* FILL SOA ARRAYS, PADDING EACH SPAN WITH ITS LAST ELEMENT */
 
+	for (int b = 0; b < numBones; b++)
+	{
+		const BoneDefinitionType* bonePtr = &skeleton->Bones[b];
+		const SkinSpanType* pointSpan = &skeleton->skinPointSpans[b];
+		const SkinSpanType* normalSpan = &skeleton->skinNormalSpans[b];
+		float* dst;
+
+		dst = skeleton->skinPointsSoA + pointSpan->offset;
+		for (int p = 0; p < pointSpan->stride; p++)
+		{
+			int i = bonePtr->pointList[p < pointSpan->count ? p : pointSpan->count - 1];
+			dst[p]							= skeleton->decomposedPointList[i].boneRelPoint.x;
+			dst[p + pointSpan->stride]		= skeleton->decomposedPointList[i].boneRelPoint.y;
+			dst[p + 2*pointSpan->stride]	= skeleton->decomposedPointList[i].boneRelPoint.z;
+		}
 
+		dst = skeleton->skinNormalsSoA + normalSpan->offset;
+		for (int p = 0; p < normalSpan->stride; p++)
+		{
+			int i = bonePtr->normalList[p < normalSpan->count ? p : normalSpan->count - 1];
+			dst[p]							= skeleton->decomposedNormalsList[i].x;
+			dst[p + normalSpan->stride]		= skeleton->decomposedNormalsList[i].y;
+			dst[p + 2*normalSpan->stride]	= skeleton->decomposedNormalsList[i].z;
+		}
+	}
 
+			/* BUILD SCATTER LIST */
+			//
+			// Gather into a per-trimesh-vertex table first so that later bones
+			// overwrite earlier ones, and so that the final list is sorted by destination.
+			//
 
+	int vertexBase[MAX_DECOMPOSED_TRIMESHES + 1];
+	vertexBase[0] = 0;
+	for (int t = 0; t < skeleton->numDecomposedTriMeshes; t++)
+		vertexBase[t + 1] = vertexBase[t] + skeleton->decomposedTriMeshPtrs[t]->numPoints;
 
+	int numVertices = vertexBase[skeleton->numDecomposedTriMeshes];
+	SkinScatterType* table = (SkinScatterType*) AllocPtr(sizeof(SkinScatterType) * (numVertices + 1));
+	Byte* isSet = (Byte*) AllocPtr(numVertices + 1);					// 0: unreached, 1: done, 2: normal still unresolved
 
+	int normalSrc[MAX_DECOMPOSED_NORMALS];
+	int normalStride[MAX_DECOMPOSED_NORMALS];
+	for (int n = 0; n < MAX_DECOMPOSED_NORMALS; n++)
+		normalSrc[n] = -1;
 
+	for (int i = 0; i < numBones; i++)
+	{
+		int b = skeleton->bonePreorder[i];
+		const BoneDefinitionType* bonePtr = &skeleton->Bones[b];
+		const SkinSpanType* pointSpan = &skeleton->skinPointSpans[b];
+		const SkinSpanType* normalSpan = &skeleton->skinNormalSpans[b];
 
+		for (int p = 0; p < normalSpan->count; p++)						// this bone's normals are transformed before its points
+		{
+			normalSrc[bonePtr->normalList[p]] = normalSpan->offset + p;
+			normalStride[bonePtr->normalList[p]] = normalSpan->stride;
+		}
+
+		for (int p = 0; p < pointSpan->count; p++)
+		{
+			const DecomposedPointType* decomposedPoint = &skeleton->decomposedPointList[bonePtr->pointList[p]];
+
+			for (int r = 0; r < decomposedPoint->numRefs; r++)
+			{
+				int v = vertexBase[decomposedPoint->whichTriMesh[r]] + decomposedPoint->whichPoint[r];
+				int n = decomposedPoint->whichNormal[r];
+
+				table[v].whichTriMesh	= decomposedPoint->whichTriMesh[r];
+				table[v].whichPoint		= decomposedPoint->whichPoint[r];
+				table[v].pointSrc		= pointSpan->offset + p;
+				table[v].pointStride	= pointSpan->stride;
+
+				if (normalSrc[n] >= 0)
+				{
+					table[v].normalSrc		= normalSrc[n];
+					table[v].normalStride	= normalStride[n];
+					isSet[v] = 1;
+				}
+				else													// no bone has claimed this normal yet: resolve once they all have
+				{
+					table[v].normalSrc		= n;
+					table[v].normalStride	= 0;
+					isSet[v] = 2;
+				}
+			}
+		}
+	}
+
+			/* COMPACT */
+
+	skeleton->skinScatterList = (SkinScatterType*) AllocPtr(sizeof(SkinScatterType) * (numVertices + 1));
+	skeleton->numSkinScatters = 0;
+
+	for (int v = 0; v < numVertices; v++)
+	{
+		if (!isSet[v])
+			continue;
+
+		SkinScatterType* scatter = &skeleton->skinScatterList[skeleton->numSkinScatters++];
+		*scatter = table[v];
+
+		if (isSet[v] == 2)												// normal was only claimed by a later bone: use its final value
+		{
+			int n = scatter->normalSrc;
+			GAME_ASSERT_MESSAGE(normalSrc[n] >= 0, "a vertex's normal isn't attached to any bone");
+			scatter->normalSrc = normalSrc[n];
+			scatter->normalStride = normalStride[n];
+		}
+	}
+
+	DisposePtr((Ptr) table);
+	DisposePtr((Ptr) isSet);
+}
+
+
+#pragma mark -
+
+/******************* SUBMIT CPU SKINNED GEOMETRY *********************/
+//
+// Skins the node's local trimeshes and submits them.
+// If anim LOD has kept the previous pose this frame, skip the skinning and just move the
+// previously skinned trimeshes from where they were to where the object is now.
+//
+
+void SubmitCPUSkinnedGeometry(ObjNode *theNode)
+{
+SkeletonObjDataType	*skeleton = theNode->Skeleton;
+const TQ3Matrix4x4	*transform = nil;			// Don't mult matrix with BaseTransformMatrix -- skeleton code already does it
+
+	if (skeleton->ReuseSkinnedGeometry)
+	{
+		TQ3Matrix4x4	inverse;
+
+		GAME_ASSERT(skeleton->GeometryIsSkinned);
+
+		Q3Matrix4x4_Invert(&skeleton->SkinnedBaseTransform, &inverse);
+		MatrixMultiply(&inverse, &theNode->BaseTransformMatrix, &skeleton->SkinReuseTransform);
+		transform = &skeleton->SkinReuseTransform;
+		skeleton->ReuseSkinnedGeometry = false;
+	}
+	else
+	{
+		UpdateSkinnedGeometry(theNode);
+	}
+
+	Render_SubmitMeshList(
+			theNode->NumMeshes,
+			theNode->MeshList,
+			transform,
+			&theNode->RenderModifiers,
+			&theNode->Coord);
+}
+
+
+/******************* PREPARE GPU SKINNING *********************/
+//
+// Builds copies of the skeleton's trimeshes in their bind pose (i.e. with bone-relative points
+// and untransformed normals), along with the index of the bone that each vertex is attached to.
+// These are uploaded to the GPU once; after that, drawing a skeleton only requires
+// sending its joint matrices.
+//
+// Does nothing if GPU skinning isn't enabled.
+//
+
+void PrepareGPUSkinning(SkeletonDefType *skeleton)
+{
+	if (!Render_IsGPUSkinningEnabled())
+		return;
+
+	if (skeleton->gpuSkinMeshes)								// already done
+		return;
+
+	if (skeleton->NumBones > MAX_JOINTS)
+		return;
+
+	long numMeshes = skeleton->numDecomposedTriMeshes;
+
+	skeleton->gpuSkinMeshes = (TQ3TriMeshData**) AllocPtr(numMeshes * sizeof(TQ3TriMeshData*));
+	skeleton->gpuSkinBoneIndices = (float**) AllocPtr(numMeshes * sizeof(float*));
+
+	for (long i = 0; i < numMeshes; i++)
+	{
+		skeleton->gpuSkinMeshes[i] = Q3TriMeshData_Duplicate(skeleton->decomposedTriMeshPtrs[i]);
+		skeleton->gpuSkinBoneIndices[i] = (float*) AllocPtr(skeleton->gpuSkinMeshes[i]->numPoints * sizeof(float));
+	}
+
+			/* PUT EACH VERTEX IN BONE SPACE */
+
+	for (int b = 0; b < skeleton->NumBones; b++)
+	{
+		const BoneDefinitionType* bonePtr = &skeleton->Bones[b];
+
+		for (int p = 0; p < bonePtr->numPointsAttachedToBone; p++)
+		{
+			const DecomposedPointType* decomposedPoint = &skeleton->decomposedPointList[bonePtr->pointList[p]];
+
+			for (int r = 0; r < decomposedPoint->numRefs; r++)
+			{
+				int meshNum = decomposedPoint->whichTriMesh[r];
+				int pointNum = decomposedPoint->whichPoint[r];
+				TQ3TriMeshData* mesh = skeleton->gpuSkinMeshes[meshNum];
+
+				mesh->points[pointNum] = decomposedPoint->boneRelPoint;
+				mesh->vertexNormals[pointNum] = skeleton->decomposedNormalsList[decomposedPoint->whichNormal[r]];
+				skeleton->gpuSkinBoneIndices[meshNum][pointNum] = b;
+			}
+		}
+	}
+
+			/* SEND TO GPU */
+
+	for (long i = 0; i < numMeshes; i++)
+	{
+		Render_UploadStaticMesh(skeleton->gpuSkinMeshes[i]);
+	}
+}
+
+
+/******************* DISPOSE GPU SKINNING *********************/
+
+void DisposeGPUSkinning(SkeletonDefType *skeleton)
+{
+	if (!skeleton->gpuSkinMeshes)
+		return;
+
+	for (long i = 0; i < skeleton->numDecomposedTriMeshes; i++)
+	{
+		Render_ReleaseStaticMesh(skeleton->gpuSkinMeshes[i]);
+		Q3TriMeshData_Dispose(skeleton->gpuSkinMeshes[i]);
+		DisposePtr((Ptr) skeleton->gpuSkinBoneIndices[i]);
+	}
+
+	DisposePtr((Ptr) skeleton->gpuSkinMeshes);
+	DisposePtr((Ptr) skeleton->gpuSkinBoneIndices);
+	skeleton->gpuSkinMeshes = nil;
+	skeleton->gpuSkinBoneIndices = nil;
+}
+
+
+/******************* IS GPU SKINNING AVAILABLE *********************/
+//
+// Reflection-mapped skeletons need their skinned normals on the CPU to generate UVs,
+// so they always go through UpdateSkinnedGeometry.
+//
+
+Boolean IsGPUSkinningAvailable(const ObjNode *theNode)
+{
+	if (theNode->CType == INVALID_NODE_FLAG)
+		return false;
+
+	const SkeletonDefType* skeletonDef = theNode->Skeleton->skeletonDefinition;
+
+	return skeletonDef->gpuSkinMeshes != nil
+		&& Render_IsGPUSkinningEnabled()
+		&& !(theNode->RenderModifiers.statusBits & STATUS_BIT_REFLECTIONMAP);
+}
+
+
+/******************* SUBMIT GPU SKINNED GEOMETRY *********************/
+//
+// GPU counterpart to UpdateSkinnedGeometry + Render_SubmitMeshList.
+// Only the joint matrices are computed here; the vertices are transformed by the skinning shader.
+//
+
+void SubmitGPUSkinnedGeometry(ObjNode *theNode)
+{
+	SkeletonObjDataType* skeleton = theNode->Skeleton;
+	const SkeletonDefType* skeletonDef = skeleton->skeletonDefinition;
+
+	GAME_ASSERT(skeletonDef->gpuSkinMeshes);
+	GAME_ASSERT(theNode->NumMeshes == skeletonDef->numDecomposedTriMeshes);
+
+	if (!skeleton->ReuseSkinnedGeometry)								// anim LOD: keep last pose, but follow the object
+		RefreshSkeletonJoints(skeleton);
+	skeleton->ReuseSkinnedGeometry = false;
+	skeleton->GeometryIsSkinned = true;
+
+	UpdateGPUSkinPalette_Recurse(skeleton, 0, &theNode->BaseTransformMatrix);
+
+	Render_SubmitSkinnedMeshList(
+			skeletonDef->numDecomposedTriMeshes,
+			skeletonDef->gpuSkinMeshes,
+			skeletonDef->gpuSkinBoneIndices,
+			skeletonDef->NumBones,
+			&skeleton->gpuSkinPalette[0][0][0],
+			&theNode->RenderModifiers,
+			&theNode->Coord);
+}
+
+
+/******************** UPDATE GPU SKIN PALETTE: RECURSE ************************/
+//
+// Same matrix concatenation as UpdateSkinnedGeometry_Recurse.
+// Each joint's matrix is stored as 3 columns (i.e. the rows of the transposed 4x3 matrix).
+//
+
+static void UpdateGPUSkinPalette_Recurse(SkeletonObjDataType* skeleton, short joint, const TQ3Matrix4x4* parentMatrix)
+{
+TQ3Matrix4x4			m;
+const TQ3Matrix4x4		*jointMatrix = &skeleton->jointTransformMatrix[joint];
+const SkeletonDefType	*skeletonDef = skeleton->skeletonDefinition;
+
+	if (skeleton->JointsAreGlobal)
+		m = *jointMatrix;
+	else
+		MatrixMultiply((TQ3Matrix4x4 *)jointMatrix, (TQ3Matrix4x4 *)parentMatrix, &m);
+
+	for (int col = 0; col < 3; col++)
+	{
+		float* row = skeleton->gpuSkinPalette[joint][col];
+		row[0] = m.value[0][col];
+		row[1] = m.value[1][col];
+		row[2] = m.value[2][col];
+		row[3] = m.value[3][col];
+	}
+
+	for (int c = 0; c < skeletonDef->numChildren[joint]; c++)
+	{
+		UpdateGPUSkinPalette_Recurse(skeleton, skeletonDef->childIndecies[joint][c], &m);
+	}
+}
+
+
+#pragma mark -
+
+/******************* BENCHMARK SKINNING *********************/
+//
+// Run with --bench-skinning.
+// Times UpdateSkinnedGeometry against the original scalar code on every skeleton,
+// and checks that both produce the same vertices.
+//
+
+void BenchmarkSkinning(void)
+{
+	const int numIterations = 2000;
+	const double ticksPerMicrosecond = SDL_GetPerformanceFrequency() / 1e6;
+
+	printf("%-14s %6s %6s %10s %10s %8s %10s\n", "skeleton", "bones", "verts", "scalar us", "simd us", "speedup", "max diff");
+
+	for (int type = 0; type < MAX_SKELETON_TYPES; type++)
+	{
+		LoadASkeleton(type);
+
+		gNewObjectDefinition.type		= type;
+		gNewObjectDefinition.animNum	= 0;
+		gNewObjectDefinition.coord		= (TQ3Point3D) {0, 0, 0};
+		gNewObjectDefinition.flags		= 0;
+		gNewObjectDefinition.slot		= 100;
+		gNewObjectDefinition.moveCall	= nil;
+		gNewObjectDefinition.rot		= 0;
+		gNewObjectDefinition.scale		= 1;
+		ObjNode* theNode = MakeNewSkeletonObject(&gNewObjectDefinition);
+		GAME_ASSERT(theNode);
+
+		int numVertices = 0;
+		for (int i = 0; i < theNode->NumMeshes; i++)
+			numVertices += theNode->MeshList[i]->numPoints;
+
+				/* TIME BOTH PATHS */
+
+		Uint64 t0 = SDL_GetPerformanceCounter();
+		for (int i = 0; i < numIterations; i++)
+			UpdateSkinnedGeometry_Reference(theNode);
+		Uint64 t1 = SDL_GetPerformanceCounter();
+		for (int i = 0; i < numIterations; i++)
+			UpdateSkinnedGeometry(theNode);
+		Uint64 t2 = SDL_GetPerformanceCounter();
+
+				/* COMPARE OUTPUT */
+
+		TQ3Point3D* referencePoints = (TQ3Point3D*) AllocPtr(sizeof(TQ3Point3D) * (numVertices + 1));
+		TQ3Vector3D* referenceNormals = (TQ3Vector3D*) AllocPtr(sizeof(TQ3Vector3D) * (numVertices + 1));
+
+		UpdateSkinnedGeometry_Reference(theNode);
+		for (int i = 0, v = 0; i < theNode->NumMeshes; i++)
+		{
+			const TQ3TriMeshData* mesh = theNode->MeshList[i];
+			memcpy(&referencePoints[v], mesh->points, sizeof(TQ3Point3D) * mesh->numPoints);
+			memcpy(&referenceNormals[v], mesh->vertexNormals, sizeof(TQ3Vector3D) * mesh->numPoints);
+			v += mesh->numPoints;
+		}
+
+		UpdateSkinnedGeometry(theNode);
+		float maxDiff = 0;
+		for (int i = 0, v = 0; i < theNode->NumMeshes; i++)
+		{
+			const TQ3TriMeshData* mesh = theNode->MeshList[i];
+			for (int p = 0; p < mesh->numPoints; p++, v++)
+			{
+				maxDiff = fmaxf(maxDiff, fabsf(mesh->points[p].x - referencePoints[v].x));
+				maxDiff = fmaxf(maxDiff, fabsf(mesh->points[p].y - referencePoints[v].y));
+				maxDiff = fmaxf(maxDiff, fabsf(mesh->points[p].z - referencePoints[v].z));
+				maxDiff = fmaxf(maxDiff, fabsf(mesh->vertexNormals[p].x - referenceNormals[v].x));
+				maxDiff = fmaxf(maxDiff, fabsf(mesh->vertexNormals[p].y - referenceNormals[v].y));
+				maxDiff = fmaxf(maxDiff, fabsf(mesh->vertexNormals[p].z - referenceNormals[v].z));
+			}
+		}
+
+		DisposePtr((Ptr) referencePoints);
+		DisposePtr((Ptr) referenceNormals);
+
+				/* REPORT */
+
+		double scalarTime = (t1 - t0) / ticksPerMicrosecond / numIterations;
+		double simdTime = (t2 - t1) / ticksPerMicrosecond / numIterations;
+
+		printf("%-14s %6d %6d %10.2f %10.2f %7.2fx %10g\n",
+				GetSkeletonName(type),
+				theNode->Skeleton->skeletonDefinition->NumBones,
+				numVertices,
+				scalarTime,
+				simdTime,
+				scalarTime / simdTime,
+				maxDiff);
+
+		DeleteObject(theNode);
+		FreeSkeletonFile(type);
+	}
+}
@@ -21,6 +21,7 @@ static void GetModelMorphPosition(const SkeletonObjDataType *skeleton,long joint
 static short GetNextAnimEventAtTime(const SkeletonObjDataType *skeleton, float time);
 static float CalcMaxKeyFrameTime(const SkeletonObjDataType *skeleton);
 static inline float	AccelerationPercent(float percent);
+static void UpdateSkeletonPose(ObjNode *theNode);
 
 
 /****************************/
@@ -33,6 +34,15 @@ enum
 	ANIM_DIRECTION_BACKWARD
 };
 
+		/* ANIM LOD */
+		//
+		// Visible skeletons farther than these distances from the camera
+		// only recompute their pose every 2nd/4th frame.
+		//
+
+#define	ANIM_LOD_DIST_HALF		1200.0f
+#define	ANIM_LOD_DIST_QUARTER	2200.0f
+
 
 /*********************/
 /*    VARIABLES      */
@@ -101,6 +111,8 @@ SkeletonDefType	*skeletonDef;
 	skeleton->MorphPercent = 0;
 	skeleton->MorphSpeed = speed;
 	
+	RefreshSkeletonJoints(skeleton);								// make sure we start from the actual current pose
+
 	for (j=0; j < skeletonDef->NumBones; j++)
 	{
 		skeleton->MorphStart[j] = skeleton->JointCurrentPosition[j];		// copy current position into MorphStart keyframe
@@ -285,8 +297,74 @@ float	fps;
 
 			/* UPDATE ALL OF THE TRANSFORMS & SUCH */
 update_transforms:			
-	GetModelCurrentPosition(skeleton);			
+	UpdateSkeletonPose(theNode);
+}
+
+
+/****************** UPDATE SKELETON POSE ******************/
+//
+// Anim LOD: the anim clock & events above always run at full rate,
+// but the joints are only recomputed when the skeleton will actually be drawn:
+//
+// - Culled skeletons just flag their joints as stale. Anyone who needs them
+//   (joint coords, skinning...) calls RefreshSkeletonJoints first.
+//
+// - Distant skeletons recompute their pose every 2nd or 4th frame. In between,
+//   the previously skinned geometry is reused (see ReuseSkinnedGeometry),
+//   provided it was skinned since the last full update (see GeometryIsSkinned).
+//
+
+static void UpdateSkeletonPose(ObjNode *theNode)
+{
+SkeletonObjDataType	*skeleton = theNode->Skeleton;
+
+	skeleton->ReuseSkinnedGeometry = false;
+
+	if (theNode->StatusBits & (STATUS_BIT_ISCULLED | STATUS_BIT_HIDDEN))	// not drawn: compute joints on demand
+	{
+		skeleton->JointsAreStale = true;
+		skeleton->GeometryIsSkinned = false;						// whatever was skinned before is out of date
+		skeleton->AnimLODCountdown = 0;								// full update as soon as it's visible again
+		return;
+	}
 
+	if (skeleton->AnimLODCountdown > 0 && !skeleton->JointsAreGlobal)	// distant & not its turn: keep last pose
+	{
+		skeleton->AnimLODCountdown--;
+		skeleton->JointsAreStale = true;
+		skeleton->ReuseSkinnedGeometry = skeleton->GeometryIsSkinned;	// else skin it now from the refreshed joints
+		return;
+	}
+
+			/* TIME FOR A FULL UPDATE */
+
+	int interval = 1;
+	if (gGameViewInfoPtr)
+	{
+		const TQ3Point3D* camera = &gGameViewInfoPtr->currentCameraCoords;
+		float dist = CalcQuickDistance(camera->x, camera->z, theNode->Coord.x, theNode->Coord.z);
+
+		if (dist > ANIM_LOD_DIST_QUARTER)
+			interval = 4;
+		else if (dist > ANIM_LOD_DIST_HALF)
+			interval = 2;
+	}
+
+	skeleton->AnimLODCountdown = interval - 1;
+	skeleton->GeometryIsSkinned = false;
+	GetModelCurrentPosition(skeleton);
+}
+
+
+/****************** REFRESH SKELETON JOINTS ******************/
+//
+// Brings the joint matrices up to date if UpdateSkeletonPose skipped them.
+//
+
+void RefreshSkeletonJoints(SkeletonObjDataType *skeleton)
+{
+	if (skeleton->JointsAreStale)
+		GetModelCurrentPosition(skeleton);
 }
 
 
@@ -311,6 +389,8 @@ SkeletonDefType	*skeletonDef;
 	currentAnimTime = skeleton->CurrentAnimTime;				// get time index into currenly running anim
 	skeletonDef = skeleton->skeletonDefinition;
 
+	skeleton->JointsAreStale = false;
+
 	if (skeleton->JointsAreGlobal)								// dont bother if global
 		return;
 
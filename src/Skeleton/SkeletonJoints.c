@@ -131,6 +131,8 @@ BoneDefinitionType	*bonePtr;
 
 	GAME_ASSERT_MESSAGE(theNode->Skeleton, "Node has no skeleton");
 
+	RefreshSkeletonJoints(theNode->Skeleton);							// joints may be stale if culled
+
 			/* ACCUMULATE A MATRIX DOWN THE CHAIN */
 			
 	*outMatrix = theNode->Skeleton->jointTransformMatrix[jointNum];		// init matrix
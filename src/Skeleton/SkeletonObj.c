@@ -69,6 +69,10 @@ void LoadASkeleton(Byte num)
 		gLoadedSkeletonsList[num]->decomposedTriMeshPtrs[8]->texturingMode |= kQ3TexturingModeExt_NullShaderFlag;	// hair
 		gLoadedSkeletonsList[num]->decomposedTriMeshPtrs[9]->texturingMode |= kQ3TexturingModeExt_NullShaderFlag;	// beard
 	}
+
+			/* MAKE BIND-POSE MESHES FOR GPU SKINNING */
+
+	PrepareGPUSkinning(gLoadedSkeletonsList[num]);				// (after the texturing mode tweaks above!)
 }
 
 
@@ -268,6 +272,30 @@ static void DisposeSkeletonDefinitionMemory(SkeletonDefType *skeleton)
 		skeleton->JointKeyframes[j].keyFrames = nil;
 	}
 
+			/* DISPOSE SKINNING STREAMS */
+
+	if (skeleton->skinPointsSoA)
+	{
+		DisposePtr((Ptr)skeleton->skinPointsSoA);
+		skeleton->skinPointsSoA = nil;
+	}
+
+	if (skeleton->skinNormalsSoA)
+	{
+		DisposePtr((Ptr)skeleton->skinNormalsSoA);
+		skeleton->skinNormalsSoA = nil;
+	}
+
+	if (skeleton->skinScatterList)
+	{
+		DisposePtr((Ptr)skeleton->skinScatterList);
+		skeleton->skinScatterList = nil;
+	}
+
+			/* DISPOSE GPU SKINNING DATA */
+
+	DisposeGPUSkinning(skeleton);
+
 			/* DISPOSE DECOMPOSED DATA ARRAYS */
 
 	// DON'T call Q3TriMeshData_Dispose on every decomposedTriMeshPtrs as they're just pointers
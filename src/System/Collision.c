@@ -12,11 +12,32 @@
 #include "game.h"
 
 
+/****************************/
+/*    TYPES                 */
+/****************************/
+
+typedef struct
+{
+	ObjNode		**candidates;				// nil = walk the whole object list
+	int			numCandidates;
+	int			nextCandidate;
+	ObjNode		*nextNode;
+} CollisionScanType;
+
+
 /****************************/
 /*    PROTOTYPES            */
 /****************************/
 
 static void CollisionDetect(ObjNode *baseNode, u_long CType, short startNumCollisions);
+static void CollisionDetect_Scan(ObjNode *baseNode, u_long CType, short startNumCollisions, Boolean useGrid);
+static short DoSimplePointCollision_Scan(TQ3Point3D *thePoint, u_long cType, Boolean useGrid);
+static short DoSimpleBoxCollision_Scan(float top, float bottom, float left, float right,
+						float front, float back, u_long cType, Boolean useGrid);
+static ObjNode *FindClosestObjectOfType_Scan(TQ3Point3D *pt, u_long cType, float *dist, Boolean useGrid);
+static Boolean BeginCollisionScan(CollisionScanType *scan, Boolean useGrid, float left, float right, float back, float front);
+static Boolean BeginClosestObjectScan(CollisionScanType *scan, const TQ3Point3D *pt, u_long cType);
+static void CheckCollisionScanResults(const char *what, short numCollisions, const CollisionRec *collisionList, Byte totalSides);
 
 
 /****************************/
@@ -25,6 +46,10 @@ static void CollisionDetect(ObjNode *baseNode, u_long CType, short startNumColli
 
 #define	MAX_COLLISIONS				60
 
+#define	COLLISION_GRID_CELL_SIZE	TERRAIN_SUPERTILE_UNIT_SIZE		// world units per broadphase grid cell
+#define	COLLISION_GRID_MARGIN		1.0f							// slop for float rounding at cell edges
+#define	MAX_COLLISION_CANDIDATES	1024							// if a query finds more than this, it just walks the object list
+
 enum
 {
 	WH_HEAD	=	1,
@@ -40,6 +65,37 @@ CollisionRec	gCollisionList[MAX_COLLISIONS];
 short			gNumCollisions = 0;
 Byte			gTotalSides;
 
+			/* BROADPHASE GRID */
+			//
+			// Every attached ObjNode with collision boxes below SLOT_OF_DUMB lives in the cell that holds
+			// the center of its boxes (and its coord).  Nodes that are bigger than a cell, off the map,
+			// or whose boxes haven't been filled in yet live in the extra "loose" cell, which every query visits.
+			//
+
+static ObjNode	**gCollisionGrid = nil;						// [row * width + col] -> 1st node in cell
+static int		gCollisionGridWidth = 0;
+static int		gCollisionGridDepth = 0;
+static int		gCollisionGridLooseCell = 0;				// index of the loose cell (after the real ones)
+static ObjNode	*gCollisionCandidates[MAX_COLLISION_CANDIDATES];
+
+
+/******************* NEXT COLLISION SCAN NODE *********************/
+
+static inline ObjNode *NextCollisionScanNode(CollisionScanType *scan)
+{
+	if (scan->candidates)
+	{
+		if (scan->nextCandidate >= scan->numCandidates)
+			return nil;
+		return scan->candidates[scan->nextCandidate++];
+	}
+
+	ObjNode* node = scan->nextNode;
+	if (node)
+		scan->nextNode = node->NextNode;
+	return node;
+}
+
 
 /******************* COLLISION DETECT *********************/
 //
@@ -47,8 +103,33 @@ Byte			gTotalSides;
 //
 
 static void CollisionDetect(ObjNode *baseNode, u_long CType, short startNumCollisions)
+{
+	if (gCommandLine.checkCollisionGrid && gCollisionGrid)
+	{
+		Byte	oldTotalSides = gTotalSides;
+
+		CollisionDetect_Scan(baseNode, CType, startNumCollisions, false);		// brute force first
+
+		short			bruteNumCollisions = gNumCollisions;
+		Byte			bruteTotalSides = gTotalSides;
+		CollisionRec	bruteList[MAX_COLLISIONS];
+		memcpy(bruteList, gCollisionList, sizeof(bruteList));
+
+		gTotalSides = oldTotalSides;
+		CollisionDetect_Scan(baseNode, CType, startNumCollisions, true);
+		CheckCollisionScanResults("CollisionDetect", bruteNumCollisions, bruteList, bruteTotalSides);
+	}
+	else
+	{
+		CollisionDetect_Scan(baseNode, CType, startNumCollisions, true);
+	}
+}
+
+
+static void CollisionDetect_Scan(ObjNode *baseNode, u_long CType, short startNumCollisions, Boolean useGrid)
 {
 ObjNode 	*thisNode;
+CollisionScanType	scan;
 u_long		sideBits,cBits,cType;
 float		relDX,relDY,relDZ;						// relative deltas
 float		realDX,realDY,realDZ;					// real deltas
@@ -98,9 +179,10 @@ float		oldX,oldZ,oldY;
 			/* SCAN AGAINST ALL OBJECTS */
 			/****************************/		
 		
-	thisNode = gFirstNodePtr;									// start on 1st node
+	BeginCollisionScan(&scan, useGrid,							// only the objects near the base box, if possible
+			baseBoxList->left, baseBoxList->right, baseBoxList->back, baseBoxList->front);
 
-	do
+	while ((thisNode = NextCollisionScanNode(&scan)) != nil)
 	{
 		cType = thisNode->CType;	
 		if (cType == INVALID_NODE_FLAG)				// see if something went wrong
@@ -254,8 +336,8 @@ got_sides:
 			}
 		}
 next:	
-		thisNode = thisNode->NextNode;												// next target node
-	}while(thisNode != nil);
+		;
+	}
 
 
 	GAME_ASSERT(gNumCollisions <= MAX_COLLISIONS);									// see if overflowed (memory corruption ensued)
@@ -717,16 +799,34 @@ signed char	wind;										// current winding number
 //
 
 short DoSimplePointCollision(TQ3Point3D *thePoint, u_long cType)
+{
+	if (gCommandLine.checkCollisionGrid && gCollisionGrid)
+	{
+		short			bruteNumCollisions = DoSimplePointCollision_Scan(thePoint, cType, false);
+		CollisionRec	bruteList[MAX_COLLISIONS];
+		memcpy(bruteList, gCollisionList, sizeof(bruteList));
+
+		DoSimplePointCollision_Scan(thePoint, cType, true);
+		CheckCollisionScanResults("DoSimplePointCollision", bruteNumCollisions, bruteList, gTotalSides);
+		return(gNumCollisions);
+	}
+
+	return(DoSimplePointCollision_Scan(thePoint, cType, true));
+}
+
+
+static short DoSimplePointCollision_Scan(TQ3Point3D *thePoint, u_long cType, Boolean useGrid)
 {
 ObjNode	*thisNode;
 short	targetNumBoxes,target;
 CollisionBoxType *targetBoxList;
+CollisionScanType	scan;
 
 	gNumCollisions = 0;
 
-	thisNode = gFirstNodePtr;									// start on 1st node
+	BeginCollisionScan(&scan, useGrid, thePoint->x, thePoint->x, thePoint->z, thePoint->z);
 
-	do
+	while ((thisNode = NextCollisionScanNode(&scan)) != nil)
 	{
 		if (!(thisNode->CType & cType))							// see if we want to check this Type
 			goto next;
@@ -784,8 +884,8 @@ CollisionBoxType *targetBoxList;
 		}
 		
 next:	
-		thisNode = thisNode->NextNode;							// next target node
-	}while(thisNode != nil);
+		;
+	}
 
 	return(gNumCollisions);
 }
@@ -798,16 +898,35 @@ next:
 
 short DoSimpleBoxCollision(float top, float bottom, float left, float right,
 						float front, float back, u_long cType)
+{
+	if (gCommandLine.checkCollisionGrid && gCollisionGrid)
+	{
+		short			bruteNumCollisions = DoSimpleBoxCollision_Scan(top, bottom, left, right, front, back, cType, false);
+		CollisionRec	bruteList[MAX_COLLISIONS];
+		memcpy(bruteList, gCollisionList, sizeof(bruteList));
+
+		DoSimpleBoxCollision_Scan(top, bottom, left, right, front, back, cType, true);
+		CheckCollisionScanResults("DoSimpleBoxCollision", bruteNumCollisions, bruteList, gTotalSides);
+		return(gNumCollisions);
+	}
+
+	return(DoSimpleBoxCollision_Scan(top, bottom, left, right, front, back, cType, true));
+}
+
+
+static short DoSimpleBoxCollision_Scan(float top, float bottom, float left, float right,
+						float front, float back, u_long cType, Boolean useGrid)
 {
 ObjNode			*thisNode;
 short			targetNumBoxes,target;
 CollisionBoxType *targetBoxList;
+CollisionScanType	scan;
 
 	gNumCollisions = 0;
 
-	thisNode = gFirstNodePtr;									// start on 1st node
+	BeginCollisionScan(&scan, useGrid, left, right, back, front);
 
-	do
+	while ((thisNode = NextCollisionScanNode(&scan)) != nil)
 	{
 		if (!(thisNode->CType & cType))							// see if we want to check this Type
 			goto next;
@@ -865,8 +984,8 @@ CollisionBoxType *targetBoxList;
 		}
 		
 next:	
-		thisNode = thisNode->NextNode;							// next target node
-	}while(thisNode != nil);
+		;
+	}
 
 	return(gNumCollisions);
 }
@@ -973,6 +1092,461 @@ CollisionBoxType *targetBoxList;
 }
 
 
+#pragma mark ========== BROADPHASE GRID ==========
+
+
+/******************** INIT COLLISION GRID *********************************/
+//
+// Called once the terrain is loaded, so we know how big the level is.
+// Picks up any objects that already exist.
+//
+
+void InitCollisionGrid(void)
+{
+	DisposeCollisionGrid();
+
+	gCollisionGridWidth = (int) ((gTerrainUnitWidth + COLLISION_GRID_CELL_SIZE - 1) / COLLISION_GRID_CELL_SIZE);
+	gCollisionGridDepth = (int) ((gTerrainUnitDepth + COLLISION_GRID_CELL_SIZE - 1) / COLLISION_GRID_CELL_SIZE);
+	if (gCollisionGridWidth < 1)
+		gCollisionGridWidth = 1;
+	if (gCollisionGridDepth < 1)
+		gCollisionGridDepth = 1;
+
+	gCollisionGridLooseCell = gCollisionGridWidth * gCollisionGridDepth;
+
+	gCollisionGrid = (ObjNode**) AllocPtr((gCollisionGridLooseCell + 1) * sizeof(ObjNode*));
+	GAME_ASSERT(gCollisionGrid);
+
+	for (ObjNode* node = gFirstNodePtr; node != nil; node = node->NextNode)
+		UpdateObjectCollisionGrid(node);
+}
+
+
+/******************** DISPOSE COLLISION GRID *********************************/
+
+void DisposeCollisionGrid(void)
+{
+	if (!gCollisionGrid)
+		return;
+
+	for (int cell = 0; cell <= gCollisionGridLooseCell; cell++)		// unlink any stragglers
+	{
+		ObjNode* node = gCollisionGrid[cell];
+		while (node)
+		{
+			ObjNode* next = node->CollisionGridNext;
+			node->CollisionGridCell = -1;
+			node->CollisionGridNext = nil;
+			node->CollisionGridPrev = nil;
+			node = next;
+		}
+	}
+
+	DisposePtr((Ptr) gCollisionGrid);
+	gCollisionGrid = nil;
+}
+
+
+/******************** LINK INTO COLLISION GRID CELL *********************************/
+
+static void LinkIntoCollisionGridCell(ObjNode *theNode, int cell)
+{
+	if (theNode->CollisionGridCell == cell)
+		return;
+
+	RemoveObjectFromCollisionGrid(theNode);
+
+	theNode->CollisionGridCell = cell;
+	theNode->CollisionGridPrev = nil;
+	theNode->CollisionGridNext = gCollisionGrid[cell];
+	if (gCollisionGrid[cell])
+		gCollisionGrid[cell]->CollisionGridPrev = theNode;
+	gCollisionGrid[cell] = theNode;
+}
+
+
+/******************** REMOVE OBJECT FROM COLLISION GRID *********************************/
+
+void RemoveObjectFromCollisionGrid(ObjNode *theNode)
+{
+	if (theNode->CollisionGridCell < 0)
+		return;
+
+	GAME_ASSERT(gCollisionGrid);
+
+	if (theNode->CollisionGridPrev)
+		theNode->CollisionGridPrev->CollisionGridNext = theNode->CollisionGridNext;
+	else
+		gCollisionGrid[theNode->CollisionGridCell] = theNode->CollisionGridNext;
+
+	if (theNode->CollisionGridNext)
+		theNode->CollisionGridNext->CollisionGridPrev = theNode->CollisionGridPrev;
+
+	theNode->CollisionGridCell = -1;
+	theNode->CollisionGridPrev = nil;
+	theNode->CollisionGridNext = nil;
+}
+
+
+/******************** IS COLLISION GRID CANDIDATE *********************************/
+//
+// Same objects the collision scans can ever hit.
+//
+
+static inline Boolean IsCollisionGridCandidate(const ObjNode *theNode)
+{
+	return !(theNode->StatusBits & STATUS_BIT_DETACHED)
+		&& theNode->Slot < SLOT_OF_DUMB
+		&& theNode->NumCollisionBoxes > 0
+		&& theNode->CollisionBoxes != nil;
+}
+
+
+/******************** UPDATE OBJECT COLLISION GRID *********************************/
+//
+// Must be called whenever an object's collision boxes change.
+// CalcObjectBoxFromNode & CalcObjectBoxFromGlobal do it for you;
+// code that fills in boxes by hand has to call this afterwards.
+//
+
+void UpdateObjectCollisionGrid(ObjNode *theNode)
+{
+	if (!gCollisionGrid)
+		return;
+
+	if (!IsCollisionGridCandidate(theNode))
+	{
+		RemoveObjectFromCollisionGrid(theNode);
+		return;
+	}
+
+			/* GET X/Z EXTENTS OF BOXES & COORD */
+
+	float minX = theNode->Coord.x;
+	float maxX = minX;
+	float minZ = theNode->Coord.z;
+	float maxZ = minZ;
+
+	for (int i = 0; i < theNode->NumCollisionBoxes; i++)
+	{
+		const CollisionBoxType* box = &theNode->CollisionBoxes[i];
+		if (box->left < minX)	minX = box->left;
+		if (box->right > maxX)	maxX = box->right;
+		if (box->back < minZ)	minZ = box->back;
+		if (box->front > maxZ)	maxZ = box->front;
+	}
+
+			/* PICK CELL */
+
+	int cell = gCollisionGridLooseCell;
+
+	if ((maxX - minX) <= COLLISION_GRID_CELL_SIZE && (maxZ - minZ) <= COLLISION_GRID_CELL_SIZE)	// fails on NaN too
+	{
+		float centerX = (minX + maxX) * 0.5f;
+		float centerZ = (minZ + maxZ) * 0.5f;
+
+		if (centerX >= 0 && centerX < gCollisionGridWidth * COLLISION_GRID_CELL_SIZE
+			&& centerZ >= 0 && centerZ < gCollisionGridDepth * COLLISION_GRID_CELL_SIZE)
+		{
+			int col = (int) (centerX * (1.0f / COLLISION_GRID_CELL_SIZE));
+			int row = (int) (centerZ * (1.0f / COLLISION_GRID_CELL_SIZE));
+			if (col >= gCollisionGridWidth)	col = gCollisionGridWidth - 1;
+			if (row >= gCollisionGridDepth)	row = gCollisionGridDepth - 1;
+			cell = row * gCollisionGridWidth + col;
+		}
+	}
+
+	LinkIntoCollisionGridCell(theNode, cell);
+}
+
+
+/******************** SET OBJECT COLLISION GRID LOOSE *********************************/
+//
+// For objects whose boxes have been allocated but not filled in yet.
+//
+
+void SetObjectCollisionGridLoose(ObjNode *theNode)
+{
+	if (!gCollisionGrid)
+		return;
+
+	if (IsCollisionGridCandidate(theNode))
+		LinkIntoCollisionGridCell(theNode, gCollisionGridLooseCell);
+	else
+		RemoveObjectFromCollisionGrid(theNode);
+}
+
+
+/******************** ADD COLLISION CANDIDATES *********************************/
+
+static Boolean AddCollisionCandidates(CollisionScanType *scan, int cell)
+{
+	for (ObjNode* node = gCollisionGrid[cell]; node != nil; node = node->CollisionGridNext)
+	{
+		if (scan->numCandidates >= MAX_COLLISION_CANDIDATES)
+			return false;
+		scan->candidates[scan->numCandidates++] = node;
+	}
+	return true;
+}
+
+
+/******************** SORT COLLISION CANDIDATES *********************************/
+//
+// Puts the candidates back in object list order (by slot, then by when they were attached),
+// so that results come out in exactly the same order as a full scan.
+//
+
+static void SortCollisionCandidates(CollisionScanType *scan)
+{
+	ObjNode** list = scan->candidates;
+
+	for (int i = 1; i < scan->numCandidates; i++)
+	{
+		ObjNode* node = list[i];
+		int j = i - 1;
+
+		while (j >= 0
+			&& (list[j]->Slot > node->Slot
+				|| (list[j]->Slot == node->Slot && list[j]->AttachSerial > node->AttachSerial)))
+		{
+			list[j + 1] = list[j];
+			j--;
+		}
+
+		list[j + 1] = node;
+	}
+}
+
+
+/******************** BEGIN COLLISION SCAN *********************************/
+//
+// Sets up a scan of every object that might touch the given x/z region.
+// Falls back to walking the whole object list if there's no grid or the region is huge.
+//
+
+static Boolean BeginCollisionScan(CollisionScanType *scan, Boolean useGrid, float left, float right, float back, float front)
+{
+	scan->candidates = nil;
+	scan->numCandidates = 0;
+	scan->nextCandidate = 0;
+	scan->nextNode = gFirstNodePtr;
+
+	if (!useGrid || !gCollisionGrid)
+		return false;
+
+	if (!(left <= right && back <= front))							// also catches NaN
+		return false;
+
+			/* GET RANGE OF CELLS THAT CAN HOLD OVERLAPPING OBJECTS */
+			//
+			// An object's extents are never more than half a cell outside the cell it's in.
+			//
+
+	const float halfCell = COLLISION_GRID_CELL_SIZE * 0.5f + COLLISION_GRID_MARGIN;
+	float colMinF = floorf((left - halfCell) * (1.0f / COLLISION_GRID_CELL_SIZE)) - 1;
+	float colMaxF = floorf((right + halfCell) * (1.0f / COLLISION_GRID_CELL_SIZE));
+	float rowMinF = floorf((back - halfCell) * (1.0f / COLLISION_GRID_CELL_SIZE)) - 1;
+	float rowMaxF = floorf((front + halfCell) * (1.0f / COLLISION_GRID_CELL_SIZE));
+
+	int colMin = colMinF < 0 ? 0 : (int) colMinF;
+	int rowMin = rowMinF < 0 ? 0 : (int) rowMinF;
+	int colMax = colMaxF >= gCollisionGridWidth ? gCollisionGridWidth - 1 : (int) colMaxF;
+	int rowMax = rowMaxF >= gCollisionGridDepth ? gCollisionGridDepth - 1 : (int) rowMaxF;
+
+			/* GATHER CANDIDATES */
+
+	scan->candidates = gCollisionCandidates;
+
+	if (!AddCollisionCandidates(scan, gCollisionGridLooseCell))
+		goto too_many;
+
+	for (int row = rowMin; row <= rowMax; row++)
+	{
+		for (int col = colMin; col <= colMax; col++)
+		{
+			if (!AddCollisionCandidates(scan, row * gCollisionGridWidth + col))
+				goto too_many;
+		}
+	}
+
+	SortCollisionCandidates(scan);
+	return true;
+
+too_many:
+	scan->candidates = nil;
+	scan->numCandidates = 0;
+	return false;
+}
+
+
+/******************** BEGIN CLOSEST OBJECT SCAN *********************************/
+//
+// Gathers cells in rings around the point until nothing farther out could be closer
+// than the closest object of the given type found so far.
+//
+// This relies on an object's coord being inside its cell's bounds,
+// which holds as long as the coord was last set via UpdateObject.
+//
+
+static Boolean BeginClosestObjectScan(CollisionScanType *scan, const TQ3Point3D *pt, u_long cType)
+{
+	scan->candidates = nil;
+	scan->numCandidates = 0;
+	scan->nextCandidate = 0;
+	scan->nextNode = gFirstNodePtr;
+
+	if (!gCollisionGrid)
+		return false;
+
+	float colF = floorf(pt->x * (1.0f / COLLISION_GRID_CELL_SIZE));
+	float rowF = floorf(pt->z * (1.0f / COLLISION_GRID_CELL_SIZE));
+	if (!(fabsf(colF) < 100000 && fabsf(rowF) < 100000))			// way off the map (or NaN)
+		return false;
+
+	int ptCol = (int) colF;
+	int ptRow = (int) rowF;
+
+	int maxRing = 0;												// ring that reaches the farthest corner of the grid
+	int d;
+	d = abs(ptCol);								if (d > maxRing) maxRing = d;
+	d = abs(gCollisionGridWidth - 1 - ptCol);	if (d > maxRing) maxRing = d;
+	d = abs(ptRow);								if (d > maxRing) maxRing = d;
+	d = abs(gCollisionGridDepth - 1 - ptRow);	if (d > maxRing) maxRing = d;
+
+	scan->candidates = gCollisionCandidates;
+
+	if (!AddCollisionCandidates(scan, gCollisionGridLooseCell))
+		goto too_many;
+
+	float bestDist = 10000000;
+	int numChecked = 0;
+
+	for (int ring = 0; ring <= maxRing; ring++)
+	{
+		for (int row = ptRow - ring; row <= ptRow + ring; row++)
+		{
+			if (row < 0 || row >= gCollisionGridDepth)
+				continue;
+
+			int colStep = (row == ptRow - ring || row == ptRow + ring) ? 1 : 2 * ring;	// whole edge rows, just the ends otherwise
+			if (colStep == 0)
+				colStep = 1;
+
+			for (int col = ptCol - ring; col <= ptCol + ring; col += colStep)
+			{
+				if (col < 0 || col >= gCollisionGridWidth)
+					continue;
+				if (!AddCollisionCandidates(scan, row * gCollisionGridWidth + col))
+					goto too_many;
+			}
+		}
+
+				/* SEE IF WE CAN STOP */
+
+		for ( ; numChecked < scan->numCandidates; numChecked++)
+		{
+			const ObjNode* node = scan->candidates[numChecked];
+			if (node->CType & cType)
+			{
+				float dist = CalcQuickDistance(pt->x, pt->z, node->Coord.x, node->Coord.z);
+				if (dist < bestDist)
+					bestDist = dist;
+			}
+		}
+
+		float unvisitedDist = (ring - 0.5f) * COLLISION_GRID_CELL_SIZE - COLLISION_GRID_MARGIN;	// no closer than this in the next rings
+		if (bestDist < unvisitedDist)
+			break;
+	}
+
+	SortCollisionCandidates(scan);
+	return true;
+
+too_many:
+	scan->candidates = nil;
+	scan->numCandidates = 0;
+	return false;
+}
+
+
+/******************** FIND CLOSEST OBJECT OF TYPE *********************************/
+//
+// OUTPUT: nil if no objects with any of the given CType bits below SLOT_OF_DUMB
+//
+
+ObjNode *FindClosestObjectOfType(TQ3Point3D *pt, u_long cType, float *dist)
+{
+	if (gCommandLine.checkCollisionGrid && gCollisionGrid)
+	{
+		float	bruteDist, gridDist;
+		ObjNode	*bruteBest = FindClosestObjectOfType_Scan(pt, cType, &bruteDist, false);
+		ObjNode	*gridBest = FindClosestObjectOfType_Scan(pt, cType, &gridDist, true);
+
+		GAME_ASSERT_MESSAGE(bruteBest == gridBest && bruteDist == gridDist, "Collision grid mismatch in FindClosestObjectOfType");
+
+		*dist = gridDist;
+		return(gridBest);
+	}
+
+	return(FindClosestObjectOfType_Scan(pt, cType, dist, true));
+}
+
+
+static ObjNode *FindClosestObjectOfType_Scan(TQ3Point3D *pt, u_long cType, float *dist, Boolean useGrid)
+{
+ObjNode		*thisNodePtr,*best = nil;
+float	d,minDist = 10000000;
+CollisionScanType	scan;
+
+	if (useGrid)
+		BeginClosestObjectScan(&scan, pt, cType);
+	else
+		BeginCollisionScan(&scan, false, 0, 0, 0, 0);
+
+	while ((thisNodePtr = NextCollisionScanNode(&scan)) != nil)
+	{
+		if (thisNodePtr->Slot >= SLOT_OF_DUMB)					// see if reach end of usable list
+			break;
+	
+		if (thisNodePtr->CType & cType)
+		{
+			d = CalcQuickDistance(pt->x,pt->z,thisNodePtr->Coord.x, thisNodePtr->Coord.z);
+			if (d < minDist)
+			{
+				minDist = d;
+				best = thisNodePtr;
+			}
+		}	
+	}
+
+	*dist = minDist;
+	return(best);
+}
+
+
+/******************** CHECK COLLISION SCAN RESULTS *********************************/
+//
+// For --check-collision-grid: the grid scan that just ran must match the brute force results passed in.
+//
+
+static void CheckCollisionScanResults(const char *what, short numCollisions, const CollisionRec *collisionList, Byte totalSides)
+{
+	Boolean same = (numCollisions == gNumCollisions) && (totalSides == gTotalSides);
+
+	for (int i = 0; same && i < numCollisions; i++)
+	{
+		same = collisionList[i].baseBox		== gCollisionList[i].baseBox
+			&& collisionList[i].targetBox	== gCollisionList[i].targetBox
+			&& collisionList[i].sides		== gCollisionList[i].sides
+			&& collisionList[i].objectPtr	== gCollisionList[i].objectPtr;
+	}
+
+	if (!same)
+		DoFatalAlert("Collision grid mismatch in %s: %d vs %d hits", what, numCollisions, gNumCollisions);
+}
+
+
 #pragma mark ========== TERRAIN COLLISION ==========
 
 
@@ -84,6 +84,46 @@ float	g3DTileSize, g3DMinY, g3DMaxY;
 
 int		gCurrentSaveSlot = -1;
 
+/******************* GET SKELETON NAME *******************/
+//
+// OUTPUT:	name of the skeleton's files in the Skeletons folder (without extension)
+//
+
+const char* GetSkeletonName(short skeletonType)
+{
+	switch(skeletonType)
+	{
+		case	SKELETON_TYPE_BOXERFLY:		return "BoxerFly";
+		case	SKELETON_TYPE_ME:			return "DoodleBug";
+		case	SKELETON_TYPE_SLUG:			return "Slug";
+		case	SKELETON_TYPE_ANT:			return "Ant";
+		case	SKELETON_TYPE_FIREANT:		return "WingedFireAnt";
+		case	SKELETON_TYPE_WATERBUG:		return "WaterBug";
+		case	SKELETON_TYPE_DRAGONFLY:	return "DragonFly";
+		case	SKELETON_TYPE_PONDFISH:		return "PondFish";
+		case	SKELETON_TYPE_MOSQUITO:		return "Mosquito";
+		case	SKELETON_TYPE_FOOT:			return "Foot";
+		case	SKELETON_TYPE_SPIDER:		return "Spider";
+		case	SKELETON_TYPE_CATERPILLER:	return "Caterpillar";
+		case	SKELETON_TYPE_FIREFLY:		return "FireFly";
+		case	SKELETON_TYPE_BAT:			return "Bat";
+		case	SKELETON_TYPE_LADYBUG:		return "LadyBug";
+		case	SKELETON_TYPE_ROOTSWING:	return "RootSwing";
+		case	SKELETON_TYPE_LARVA:		return "Larva";
+		case	SKELETON_TYPE_FLYINGBEE:	return "FlyingBee";
+		case	SKELETON_TYPE_WORKERBEE:	return "WorkerBee";
+		case	SKELETON_TYPE_QUEENBEE:		return "QueenBee";
+		case	SKELETON_TYPE_ROACH:		return "Roach";
+		case	SKELETON_TYPE_BUDDY:		return "Buddy";
+		case	SKELETON_TYPE_SKIPPY:		return "Skippy";
+		case	SKELETON_TYPE_KINGANT:		return "AntKing";
+		default:
+				DoFatalAlert("GetSkeletonName: Unknown skeletonType!");
+				return NULL;
+	}
+}
+
+
 /******************* LOAD SKELETON *******************/
 //
 // Loads a skeleton file & creates storage for it.
@@ -105,37 +145,7 @@ char		pathBuf[128];
 
 				/* SET CORRECT FILENAME */
 
-	switch(skeletonType)
-	{
-		case	SKELETON_TYPE_BOXERFLY:		modelName = "BoxerFly";			break;
-		case	SKELETON_TYPE_ME:			modelName = "DoodleBug";		break;
-		case	SKELETON_TYPE_SLUG:			modelName = "Slug";				break;
-		case	SKELETON_TYPE_ANT:			modelName = "Ant";				break;
-		case	SKELETON_TYPE_FIREANT:		modelName = "WingedFireAnt";	break;
-		case	SKELETON_TYPE_WATERBUG:		modelName = "WaterBug";			break;
-		case	SKELETON_TYPE_DRAGONFLY:	modelName = "DragonFly";		break;
-		case	SKELETON_TYPE_PONDFISH:		modelName = "PondFish";			break;
-		case	SKELETON_TYPE_MOSQUITO:		modelName = "Mosquito";			break;
-		case	SKELETON_TYPE_FOOT:			modelName = "Foot";				break;
-		case	SKELETON_TYPE_SPIDER:		modelName = "Spider";			break;
-		case	SKELETON_TYPE_CATERPILLER:	modelName = "Caterpillar";		break;
-		case	SKELETON_TYPE_FIREFLY:		modelName = "FireFly";			break;
-		case	SKELETON_TYPE_BAT:			modelName = "Bat";				break;
-		case	SKELETON_TYPE_LADYBUG:		modelName = "LadyBug";			break;
-		case	SKELETON_TYPE_ROOTSWING:	modelName = "RootSwing";		break;
-		case	SKELETON_TYPE_LARVA:		modelName = "Larva";			break;
-		case	SKELETON_TYPE_FLYINGBEE:	modelName = "FlyingBee";		break;
-		case	SKELETON_TYPE_WORKERBEE:	modelName = "WorkerBee";		break;
-		case	SKELETON_TYPE_QUEENBEE:		modelName = "QueenBee";			break;
-		case	SKELETON_TYPE_ROACH:		modelName = "Roach";			break;
-		case	SKELETON_TYPE_BUDDY:		modelName = "Buddy";			break;
-		case	SKELETON_TYPE_SKIPPY:		modelName = "Skippy";			break;
-		case	SKELETON_TYPE_KINGANT:		modelName = "AntKing";			break;
-		default:
-				DoFatalAlert("LoadSkeleton: Unknown skeletonType!");
-	}
-
-
+	modelName = GetSkeletonName(skeletonType);
 
 	snprintf(pathBuf, sizeof(pathBuf), ":Skeletons:%s.skeleton", modelName);
 	FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, pathBuf, &fsSpecSkeleton);
@@ -779,6 +789,15 @@ short	fRefNum;
 			/* PRECALC THE TILE SPLIT MODE MATRIX */
 			
 	CalculateSplitModeMatrix();
+	BuildTerrainPlaneCache();
+
+
+			/* PRE-ORIENT THE TILES USED BY THE MAPS */
+			//
+			// (and with --bake-terrain, load or bake the lit supertile geometry too)
+			//
+
+	LoadOrBakeTerrain(specPtr);
 
 		
 	BuildTerrainItemList();	
@@ -23,6 +23,10 @@ static void PlayArea(void);
 static void DoDeathReset(void);
 static void PlayGame(void);
 static void CheckForCheats(void);
+static void MoveWorld(void);
+static void MoveWorldFixedSteps(float frameFrac);
+static void DrawInterpolatedScene(void);
+static void PlayRecordedSession(void);
 
 
 /****************************/
@@ -31,6 +35,10 @@ static void CheckForCheats(void);
 
 #define	KILL_DELAY	4
 
+#define	MAX_SIM_STEPS_PER_FRAME	8					// fixed timestep: drop time rather than spiral when a frame takes too long
+
+#define	RECORDED_SESSION_SEED	0x2a80ce30			// random seed for --record-input & --benchmark
+
 typedef struct
 {
 	Byte	levelType;
@@ -78,6 +86,10 @@ Boolean		gPlayerGotKilledFlag,gWonGameFlag,gRestoringSavedGame = false;
 
 QD3DSetupOutputType		*gGameViewInfoPtr = nil;
 
+static float		gSimStepFrac = 0;							// fixed timestep duration (0 = simulation runs on frame time)
+static float		gSimAccumulator = 0;						// real time not yet simulated
+static TQ3Point3D	gStepStartCameraFrom, gStepStartCameraTo;	// camera at start of last fixed step
+
 PrefsType	gGamePrefs;
 
 FSSpec		gDataSpec;
@@ -363,33 +375,43 @@ float fps;
 		/* MAIN GAME LOOP */
 		/******************/
 
+	gSimStepFrac = 0;
+	if (gCommandLine.fixedTimestepHz > 0 && InputRecording_GetMode() == INPUT_RECORDING_OFF)	// (recorded sessions have their own fixed frame time)
+		gSimStepFrac = 1.0f / gCommandLine.fixedTimestepHz;
+	gSimAccumulator = gSimStepFrac;					// if running a fixed timestep, do one step on the 1st frame
+
 	while(true)
 	{
-		fps = gFramesPerSecondFrac;
-		UpdateInput();
+		if (InputRecording_GetMode() != INPUT_RECORDING_OFF)	// recorded sessions run on a fixed frame time so they replay the same
+		{
+			gFramesPerSecond = INPUT_RECORDING_FPS;
+			gFramesPerSecondFrac = 1.0f / INPUT_RECORDING_FPS;
+		}
 
-				/* SPECIFIC MAINTENANCE */
+		fps = gFramesPerSecondFrac;
 
-		CheckPlayerMorph();				
-		UpdateLiquidAnimation();
-		UpdateHoneyTubeTextureAnimation();
-		UpdateRootSwings();
-		
-	
-				/* MOVE OBJECTS */
-				
-		MoveObjects();
-		MoveSplineObjects();
-		QD3D_MoveShards();
-		MoveParticleGroups();
-		UpdateCamera();
+		if (gSimStepFrac > 0)
+			MoveWorldFixedSteps(fps);
+		else
+		{
+			UpdateInput();
+			if (!InputRecording_DoFrame())				// replay is over
+				break;
+			MoveWorld();
+		}
 	
 			/* DRAW OBJECTS & TERRAIN */
 					
 		UpdateInfobar();
 
+		Profiler_BeginZone(PROFILER_ZONE_TERRAIN_UPDATE);
 		DoMyTerrainUpdate();
-		QD3D_DrawScene(gGameViewInfoPtr,DrawTerrain);
+		Profiler_EndZone(PROFILER_ZONE_TERRAIN_UPDATE);
+
+		if (gSimStepFrac > 0)
+			DrawInterpolatedScene();
+		else
+			QD3D_DrawScene(gGameViewInfoPtr,DrawTerrain);
 
 		QD3D_CalcFramesPerSecond();
 		DoSDLMaintenance();
@@ -399,6 +421,9 @@ float fps;
 
 		if (GetNewKeyState(kKey_Pause) || IsCmdQPressed())		// see if pause/abort
 		{
+			if (InputRecording_GetMode() != INPUT_RECORDING_OFF)	// pausing ends a recorded session
+				break;
+
 			CaptureMouse(false);
 			DoPaused();
 			CaptureMouse(true);
@@ -441,6 +466,170 @@ float fps;
 }
 
 
+/******************** MOVE WORLD *************************/
+//
+// Advances the game by one frame (or one fixed step) of gFramesPerSecondFrac seconds.
+//
+
+static void MoveWorld(void)
+{
+			/* SPECIFIC MAINTENANCE */
+
+	CheckPlayerMorph();				
+	UpdateLiquidAnimation();
+	UpdateHoneyTubeTextureAnimation();
+	UpdateRootSwings();
+	
+
+			/* MOVE OBJECTS */
+			
+	Profiler_BeginZone(PROFILER_ZONE_MOVE_OBJECTS);
+	MoveObjects();
+	Profiler_EndZone(PROFILER_ZONE_MOVE_OBJECTS);
+
+	MoveSplineObjects();
+	QD3D_MoveShards();
+
+	Profiler_BeginZone(PROFILER_ZONE_PARTICLES);
+	MoveParticleGroups();
+	Profiler_EndZone(PROFILER_ZONE_PARTICLES);
+
+	Profiler_BeginZone(PROFILER_ZONE_CAMERA);
+	UpdateCamera();
+	Profiler_EndZone(PROFILER_ZONE_CAMERA);
+}
+
+
+/******************** MOVE WORLD FIXED STEPS *************************/
+//
+// With --fixed-timestep, the simulation always moves in steps of 1/N seconds no matter the frame rate.
+// Runs as many steps as the time elapsed since the last frame calls for; the leftover fraction
+// of a step is used by DrawInterpolatedScene.
+//
+
+static void MoveWorldFixedSteps(float frameFrac)
+{
+float	realFPS = gFramesPerSecond;
+int		numSteps;
+
+	gSimAccumulator += frameFrac;
+
+	numSteps = gSimAccumulator / gSimStepFrac;
+	if (numSteps > MAX_SIM_STEPS_PER_FRAME)				// way behind -- forget about the rest
+	{
+		numSteps = MAX_SIM_STEPS_PER_FRAME;
+		gSimAccumulator = numSteps * gSimStepFrac;
+	}
+
+			/* READ INPUT */
+			//
+			// Only poll the devices on frames that step the simulation, and only let the
+			// 1st step see new key presses. Frames with no step just let the old presses lapse.
+			//
+
+	if (numSteps == 0)
+	{
+		AgeInputState();
+		return;
+	}
+
+	UpdateInput();
+
+			/* STEP */
+
+	for (int i = 0; i < numSteps; i++)
+	{
+		SaveObjectStepCoords();
+		gStepStartCameraFrom	= gGameViewInfoPtr->currentCameraCoords;
+		gStepStartCameraTo		= gGameViewInfoPtr->currentCameraLookAt;
+
+		gFramesPerSecond		= gCommandLine.fixedTimestepHz;
+		gFramesPerSecondFrac	= gSimStepFrac;
+		MuteNewKeyStates(i > 0);
+		MoveWorld();
+
+		gSimAccumulator -= gSimStepFrac;
+	}
+
+	MuteNewKeyStates(false);
+	gFramesPerSecond		= realFPS;					// the rest of the frame runs on real time
+	gFramesPerSecondFrac	= frameFrac;
+}
+
+
+/******************** DRAW INTERPOLATED SCENE *************************/
+//
+// Draws the objects & camera partway between where they were at the start of the last
+// simulation step and where they are now, according to how much time is left over.
+//
+
+static void DrawInterpolatedScene(void)
+{
+float		alpha = gSimAccumulator / gSimStepFrac;
+TQ3Point3D	from = gGameViewInfoPtr->currentCameraCoords;
+TQ3Point3D	to = gGameViewInfoPtr->currentCameraLookAt;
+
+	if (alpha < 0.0f)
+		alpha = 0.0f;
+	else
+	if (alpha > 1.0f)
+		alpha = 1.0f;
+
+	gGameViewInfoPtr->currentCameraCoords.x = gStepStartCameraFrom.x + (from.x - gStepStartCameraFrom.x) * alpha;
+	gGameViewInfoPtr->currentCameraCoords.y = gStepStartCameraFrom.y + (from.y - gStepStartCameraFrom.y) * alpha;
+	gGameViewInfoPtr->currentCameraCoords.z = gStepStartCameraFrom.z + (from.z - gStepStartCameraFrom.z) * alpha;
+	gGameViewInfoPtr->currentCameraLookAt.x = gStepStartCameraTo.x + (to.x - gStepStartCameraTo.x) * alpha;
+	gGameViewInfoPtr->currentCameraLookAt.y = gStepStartCameraTo.y + (to.y - gStepStartCameraTo.y) * alpha;
+	gGameViewInfoPtr->currentCameraLookAt.z = gStepStartCameraTo.z + (to.z - gStepStartCameraTo.z) * alpha;
+	ApplyObjectInterpolation(alpha);
+
+	QD3D_DrawScene(gGameViewInfoPtr,DrawTerrain);
+
+	RemoveObjectInterpolation();
+	gGameViewInfoPtr->currentCameraCoords = from;
+	gGameViewInfoPtr->currentCameraLookAt = to;
+}
+
+
+/******************** PLAY RECORDED SESSION ************************/
+//
+// --record-input & --benchmark: play one level from a fresh game, on a fixed frame time
+// and random seed, either recording the player's input or replaying a recording.
+// The benchmark prints how long each frame took in the end.
+//
+
+static void PlayRecordedSession(void)
+{
+	InitInventoryForGame();
+	gGameOverFlag = false;
+	gWonGameFlag = false;
+
+	gRealLevel = gCommandLine.recordedSessionLevel;
+	GAME_ASSERT_MESSAGE(gRealLevel >= 0 && gRealLevel < NUM_LEVELS, "no such level");
+	gLevelType = gLevelTable[gRealLevel].levelType;
+	gAreaNum = gLevelTable[gRealLevel].areaNum;
+
+	if (gCommandLine.benchmarkInputFile)
+		InputRecording_StartReplay(gCommandLine.benchmarkInputFile, gRealLevel);
+	else
+		InputRecording_StartRecording(gCommandLine.recordInputFile, gRealLevel);
+
+	SetMyRandomSeed(RECORDED_SESSION_SEED);
+	InitArea();
+
+	if (gCommandLine.benchmarkInputFile)
+		Profiler_StartRun();
+
+	PlayArea();
+
+	if (gCommandLine.benchmarkInputFile)
+		Profiler_EndRun();
+
+	InputRecording_Finish();
+	CleanupLevel();
+}
+
+
 /***************** INIT AREA ************************/
 
 static void InitArea(void)
@@ -594,6 +783,7 @@ QD3DSetupInputType	viewDef;
 
 			/* INIT OTHER MANAGERS */
 
+	InitCollisionGrid();
 	CreateSuperTileMemoryList();
 
 	QD3D_InitShards();
@@ -630,6 +820,7 @@ static void CleanupLevel(void)
 	StopAllEffectChannels();
  	EmptySplineObjectList();
 	DeleteAllObjects();
+	DisposeCollisionGrid();
 	gCyclorama = nil;
 	FreeAllSkeletonFiles(-1);
 	DisposeSuperTileMemoryList();
@@ -833,6 +1024,18 @@ unsigned long	someLong;
 	GetDateTime ((unsigned long *)(&someLong));		// init random seed
 	SetMyRandomSeed(someLong);
 
+	if (gCommandLine.benchmarkSkinning)
+	{
+		BenchmarkSkinning();
+		CleanQuit();
+	}
+
+	if (gCommandLine.recordInputFile || gCommandLine.benchmarkInputFile)
+	{
+		PlayRecordedSession();
+		CleanQuit();
+	}
+
 
 
 			/* DO INTRO */
@@ -18,6 +18,8 @@
 
 static void FlushObjectDeleteQueue(int queueID);
 static void DisposeObjNodeMemory(ObjNode* node);
+static Boolean IsInstanceable(const ObjNode* theNode);
+static void SubmitInstancedNodes(int numNodes);
 
 
 /****************************/
@@ -27,6 +29,10 @@ static void DisposeObjNodeMemory(ObjNode* node);
 #define	OBJ_DEL_Q_SIZE	100
 #define	OBJ_BUDGET		500
 
+#define	INTERP_MAX_STEP_DIST	300.0f				// objects moving farther than this in one simulation step aren't interpolated
+
+#define	NUM_INSTANCE_BUCKETS	(MAX_3DMF_GROUPS * MAX_OBJECTS_IN_GROUP)		// one per model in gObjectGroupList
+
 
 /**********************/
 /*     VARIABLES      */
@@ -41,6 +47,7 @@ ObjNode		*gFirstNodePtr = nil;
 
 ObjNode		*gCurrentNode,*gMostRecentlyAddedNode,*gNextNode;
 int			gNumObjNodes = 0;
+static uint32_t	gNextAttachSerial = 0;
 
 NewObjectDefinitionType	gNewObjectDefinition;
 
@@ -57,6 +64,11 @@ static int			gObjectDeleteQueueFlipFlop = 0;
 Boolean		gDoAutoFade;
 float		gAutoFadeStartDist;
 
+			/* INSTANCED TERRAIN ITEMS (REBUILT EVERY FRAME IN DrawObjects) */
+
+static ObjNode*			gInstancedNodes[OBJ_BUDGET];
+static RenderInstance	gRenderInstances[OBJ_BUDGET];		// must stay valid until the render queue is flushed
+
 
 //============================================================================================================
 //============================================================================================================
@@ -93,6 +105,7 @@ void InitObjectManager(void)
 		.EffectChannel			= -1,						// no effect channel yet
 		.ParticleGroup			= -1,						// no particle group
 		.SplineObjectIndex		= -1,						// no index yet
+		.CollisionGridCell		= -1,						// not in collision grid
 		.StatusBits				= STATUS_BIT_DETACHED,		// not attached to linked list yet
 	};
 
@@ -154,6 +167,7 @@ ObjNode	*MakeNewObject(NewObjectDefinitionType *newObjDef)
 	newNodePtr->Coord		= newObjDef->coord;
 	newNodePtr->InitCoord	= newObjDef->coord;
 	newNodePtr->OldCoord	= newObjDef->coord;
+	newNodePtr->StepStartCoord = newObjDef->coord;
 
 	newNodePtr->Scale.x		= scale;
 	newNodePtr->Scale.y		= scale;
@@ -367,6 +381,10 @@ ObjNode		*thisNodePtr;
 
 
 
+			/* MOVE SHADOWS UNDER EVERYTHING THAT MOVED */
+
+	UpdateShadows();
+
 			/* CALL SOUND MAINTENANCE HERE FOR CONVENIENCE */
 			
 	DoSoundMaintenance();
@@ -387,10 +405,13 @@ void DrawObjects(const QD3DSetupOutputType *setupInfo)
 ObjNode		*theNode;
 unsigned long	statusBits;
 float			cameraX, cameraZ;
+int				numInstancedNodes = 0;
 
 	if (gFirstNodePtr == nil)									// see if there are any objects
 		return;
 
+	Profiler_BeginZone(PROFILER_ZONE_DRAW_OBJECTS);
+
 				/* FIRST DO OUR CULLING */
 				
 	CheckAllObjectsInConeOfVision();
@@ -451,16 +472,19 @@ float			cameraX, cameraZ;
 		switch(theNode->Genre)
 		{
 			case	SKELETON_GENRE:
-					UpdateSkinnedGeometry(theNode);													// update skeleton geometry
-					Render_SubmitMeshList(															// submit each trimesh of it
-							theNode->NumMeshes,
-							theNode->MeshList,
-							nil,		// Don't mult matrix with BaseTransformMatrix -- skeleton code already does it
-							&theNode->RenderModifiers,
-							&theNode->Coord);
+					if (IsGPUSkinningAvailable(theNode))
+						SubmitGPUSkinnedGeometry(theNode);
+					else
+						SubmitCPUSkinnedGeometry(theNode);										// update skeleton geometry & submit each trimesh of it
 					break;
 			
 			case	DISPLAY_GROUP_GENRE:
+					if (numInstancedNodes < OBJ_BUDGET && IsInstanceable(theNode))		// defer: will be drawn along with its twins
+					{
+						gInstancedNodes[numInstancedNodes++] = theNode;
+						break;
+					}
+
 					Render_SubmitMeshList(
 							theNode->NumMeshes,
 							theNode->MeshList,
@@ -482,6 +506,138 @@ float			cameraX, cameraZ;
 next:
 		theNode = (ObjNode *)theNode->NextNode;
 	}while (theNode != nil);
+
+			/* SUBMIT TERRAIN ITEMS THAT SHARE MODELS */
+
+	SubmitInstancedNodes(numInstancedNodes);
+
+	Profiler_EndZone(PROFILER_ZONE_DRAW_OBJECTS);
+}
+
+
+/******************** IS INSTANCEABLE ************************/
+//
+// Terrain items (grass, clover, weeds...) that draw an unmodified model from gObjectGroupList
+// can be batched together with other items of the same type.
+//
+
+static Boolean IsInstanceable(const ObjNode* theNode)
+{
+	if (!theNode->TerrainItemPtr
+		|| (theNode->StatusBits & STATUS_BIT_CLONE)
+		|| theNode->Group >= MAX_3DMF_GROUPS
+		|| theNode->Type >= gNumObjectsInGroupList[theNode->Group])
+	{
+		return false;
+	}
+
+	const TQ3TriMeshFlatGroup* model = &gObjectGroupList[theNode->Group][theNode->Type];
+
+	if (theNode->NumMeshes != model->numMeshes)					// extra geometry was attached
+		return false;
+
+	for (int i = 0; i < model->numMeshes; i++)
+	{
+		if (theNode->MeshList[i] != model->meshes[i])
+			return false;
+	}
+
+	return true;
+}
+
+
+/******************** SUBMIT INSTANCED NODES ************************/
+//
+// Buckets the deferred nodes by model, then submits each group of nodes
+// that share a model AND identical render modifiers as one instanced batch.
+//
+
+static Boolean SameRenderModifiers(const RenderModifiers* a, const RenderModifiers* b)
+{
+	return a->statusBits == b->statusBits
+		&& a->diffuseColor.r == b->diffuseColor.r
+		&& a->diffuseColor.g == b->diffuseColor.g
+		&& a->diffuseColor.b == b->diffuseColor.b
+		&& a->diffuseColor.a == b->diffuseColor.a
+		&& a->autoFadeFactor == b->autoFadeFactor
+		&& a->drawOrder == b->drawOrder;
+}
+
+static void SubmitInstancedNodes(int numNodes)
+{
+static int		bucketStart[NUM_INSTANCE_BUCKETS + 1];
+static int		bucketFill[NUM_INSTANCE_BUCKETS];
+static ObjNode*	sortedNodes[OBJ_BUDGET];
+int				numRenderInstances = 0;
+
+	if (numNodes == 0)
+		return;
+
+			/* COUNTING SORT BY MODEL */
+
+	memset(bucketStart, 0, sizeof(bucketStart));
+
+	for (int i = 0; i < numNodes; i++)
+	{
+		const ObjNode* node = gInstancedNodes[i];
+		bucketStart[node->Group * MAX_OBJECTS_IN_GROUP + node->Type + 1]++;
+	}
+
+	for (int b = 0; b < NUM_INSTANCE_BUCKETS; b++)
+	{
+		bucketStart[b + 1] += bucketStart[b];
+		bucketFill[b] = bucketStart[b];
+	}
+
+	for (int i = 0; i < numNodes; i++)
+	{
+		ObjNode* node = gInstancedNodes[i];
+		sortedNodes[bucketFill[node->Group * MAX_OBJECTS_IN_GROUP + node->Type]++] = node;
+	}
+
+			/* SUBMIT EACH BUCKET */
+
+	for (int b = 0; b < NUM_INSTANCE_BUCKETS; b++)
+	{
+		ObjNode** nodes = &sortedNodes[bucketStart[b]];
+		int n = bucketStart[b + 1] - bucketStart[b];
+
+		while (n > 0)
+		{
+			ObjNode* head = nodes[0];
+			RenderInstance* instances = &gRenderInstances[numRenderInstances];
+			int numInstances = 0;
+			int numLeft = 0;
+
+			for (int i = 0; i < n; i++)							// pull out all nodes with the same mods as the head
+			{
+				ObjNode* node = nodes[i];
+
+				if (SameRenderModifiers(&head->RenderModifiers, &node->RenderModifiers))
+				{
+					instances[numInstances].transform = &node->BaseTransformMatrix;
+					instances[numInstances].centerCoord = &node->Coord;
+					numInstances++;
+				}
+				else
+				{
+					nodes[numLeft++] = node;						// keep it for the next round
+				}
+			}
+
+			Render_SubmitMeshListInstanced(
+					head->NumMeshes,
+					head->MeshList,
+					&head->RenderModifiers,
+					numInstances,
+					instances);
+
+			numRenderInstances += numInstances;
+			n = numLeft;
+		}
+	}
+
+	GAME_ASSERT(numRenderInstances == numNodes);
 }
 
 
@@ -501,6 +657,88 @@ void MoveStaticObject(ObjNode *theNode)
 
 
 
+//============================================================================================================
+//============================================================================================================
+//============================================================================================================
+
+#pragma mark ----- RENDER INTERPOLATION ------
+
+//
+// When the simulation runs at a fixed rate, the frame drawn usually falls somewhere between the
+// last two simulation steps. Each node remembers where it was at the start of the last step, and
+// right before drawing we slide its BaseTransformMatrix back along the path it took during that step.
+//
+
+
+/******************* SAVE OBJECT STEP COORDS ********************/
+//
+// Call right before each fixed simulation step.
+//
+
+void SaveObjectStepCoords(void)
+{
+	for (ObjNode *theNode = gFirstNodePtr; theNode != nil; theNode = theNode->NextNode)
+		theNode->StepStartCoord = theNode->Coord;
+}
+
+
+/******************* APPLY OBJECT INTERPOLATION ********************/
+//
+// alpha: 0 = draw objects where they were at the start of the last step, 1 = where they are now.
+// Must be undone with RemoveObjectInterpolation before the next simulation step.
+//
+
+void ApplyObjectInterpolation(float alpha)
+{
+	for (ObjNode *theNode = gFirstNodePtr; theNode != nil; theNode = theNode->NextNode)
+	{
+		float	dx = theNode->Coord.x - theNode->StepStartCoord.x;
+		float	dy = theNode->Coord.y - theNode->StepStartCoord.y;
+		float	dz = theNode->Coord.z - theNode->StepStartCoord.z;
+		float	t = alpha - 1.0f;
+
+		theNode->InterpApplied = false;
+
+		if (theNode->CType == INVALID_NODE_FLAG)
+			continue;
+
+		if (dx*dx + dy*dy + dz*dz > INTERP_MAX_STEP_DIST*INTERP_MAX_STEP_DIST)	// don't smear teleports across the screen
+			continue;
+
+		TQ3Matrix4x4 *m = &theNode->BaseTransformMatrix;
+
+		theNode->InterpSavedTranslation.x = m->value[3][0];
+		theNode->InterpSavedTranslation.y = m->value[3][1];
+		theNode->InterpSavedTranslation.z = m->value[3][2];
+		theNode->InterpApplied = true;
+
+		m->value[3][0] += dx * t;
+		m->value[3][1] += dy * t;
+		m->value[3][2] += dz * t;
+	}
+}
+
+
+/******************* REMOVE OBJECT INTERPOLATION ********************/
+
+void RemoveObjectInterpolation(void)
+{
+	for (ObjNode *theNode = gFirstNodePtr; theNode != nil; theNode = theNode->NextNode)
+	{
+		if (!theNode->InterpApplied)
+			continue;
+
+		TQ3Matrix4x4 *m = &theNode->BaseTransformMatrix;
+
+		m->value[3][0] = theNode->InterpSavedTranslation.x;
+		m->value[3][1] = theNode->InterpSavedTranslation.y;
+		m->value[3][2] = theNode->InterpSavedTranslation.z;
+		theNode->InterpApplied = false;
+	}
+}
+
+
+
 //============================================================================================================
 //============================================================================================================
 //============================================================================================================
@@ -677,6 +915,8 @@ void DetachObject(ObjNode *theNode)
 	theNode->NextNode = nil;
 	
 	theNode->StatusBits |= STATUS_BIT_DETACHED;	
+
+	RemoveObjectFromCollisionGrid(theNode);
 }
 
 
@@ -741,6 +981,9 @@ out:
 	
 	
 	theNode->StatusBits &= ~STATUS_BIT_DETACHED;	
+
+	theNode->AttachSerial = gNextAttachSerial++;			// keeps collision grid results in list order
+	UpdateObjectCollisionGrid(theNode);
 }
 
 
@@ -751,6 +994,8 @@ static void DisposeObjNodeMemory(ObjNode* node)
 {
 	GAME_ASSERT(node != NULL);
 
+	CancelShadowUpdate(node);
+
 	ptrdiff_t poolIndex = node - gObjNodeMemory;
 
 	if (poolIndex >= 0 && poolIndex < OBJ_BUDGET)
@@ -16,6 +16,11 @@
 /*    PROTOTYPES            */
 /****************************/
 
+static void MoveShadowUnderObject(ObjNode *theNode, Boolean useBlockerGrid);
+static void BuildShadowBlockerGrid(void);
+static inline int GetShadowBlockerCol(float x);
+static inline int GetShadowBlockerRow(float z);
+static ObjNode *FindShadowBlocker(long x, long y, long z, Boolean useGrid);
 
 
 /****************************/
@@ -24,12 +29,45 @@
 
 #define	SHADOW_Y_OFF	6.0f
 
+#define	MAX_PENDING_SHADOWS				500						// shadows queued by UpdateShadow
+#define	MAX_SHADOW_BLOCKERS				256
+#define	MAX_SHADOW_BLOCKER_ENTRIES		2048					// blocker/cell pairs in the shadow blocker grid
+#define	SHADOW_BLOCKER_GRID_MAX_SIZE	64						// max cells across; cells grow past a supertile on huge levels
+#define	SHADOW_BLOCKER_MAX_CELLS		16						// blockers covering more cells than this go in the loose list
+
+
+/****************************/
+/*    TYPES                 */
+/****************************/
+
+typedef struct
+{
+	ObjNode	*node;
+	float	left, right, back, front, bottom;					// copy of its 1st collision box
+	int		colMin, colMax, rowMin, rowMax;						// cells it covers (colMin > colMax = loose)
+} ShadowBlockerType;
+
+
 /**********************/
 /*     VARIABLES      */
 /**********************/
 
 #define	CheckForBlockers	Flag[0]
 
+static ObjNode				*gPendingShadows[MAX_PENDING_SHADOWS];
+static int					gNumPendingShadows = 0;
+
+static ShadowBlockerType	gShadowBlockers[MAX_SHADOW_BLOCKERS];
+static int					gNumShadowBlockers = 0;
+static short				gLooseShadowBlockers[MAX_SHADOW_BLOCKERS];
+static int					gNumLooseShadowBlockers = 0;
+static int					gShadowBlockerCellStart[SHADOW_BLOCKER_GRID_MAX_SIZE * SHADOW_BLOCKER_GRID_MAX_SIZE + 1];	// [cell] -> 1st entry
+static short				gShadowBlockerEntries[MAX_SHADOW_BLOCKER_ENTRIES];	// indices into gShadowBlockers
+static float				gShadowBlockerCellSize;
+static int					gShadowBlockerGridWidth = 1;
+static int					gShadowBlockerGridDepth = 1;
+static Boolean				gShadowBlockerGridValid = false;
+
 
 //============================================================================================================
 //============================================================================================================
@@ -63,6 +101,8 @@ void AllocateCollisionBoxMemory(ObjNode *theNode, short numBoxes)
 	theNode->OldCollisionBoxes	= (CollisionBoxType *) NewPtr(sizeof(CollisionBoxType) * numBoxes);
 	GAME_ASSERT(theNode->CollisionBoxes);
 	GAME_ASSERT(theNode->OldCollisionBoxes);
+
+	SetObjectCollisionGridLoose(theNode);						// boxes aren't filled in yet
 }
 
 
@@ -79,6 +119,8 @@ void KeepOldCollisionBoxes(ObjNode *theNode)
 	}
 
 	theNode->OldCoord = theNode->Coord;			// remember coord also
+
+	UpdateObjectCollisionGrid(theNode);			// catches boxes that were filled in by hand
 }
 
 
@@ -105,6 +147,7 @@ CollisionBoxType *boxPtr;
 	boxPtr->top 	= theNode->Coord.y + (float)theNode->TopOff;
 	boxPtr->bottom 	= theNode->Coord.y + (float)theNode->BottomOff;
 
+	UpdateObjectCollisionGrid(theNode);
 }
 
 
@@ -133,6 +176,8 @@ CollisionBoxType *boxPtr;
 	boxPtr->front 	= gCoord.z  + (float)theNode->FrontOff;
 	boxPtr->top 	= gCoord.y  + (float)theNode->TopOff;
 	boxPtr->bottom 	= gCoord.y  + (float)theNode->BottomOff;
+
+	UpdateObjectCollisionGrid(theNode);
 }
 
 
@@ -243,16 +288,93 @@ ObjNode	*shadowObj;
 
 
 /************************ UPDATE SHADOW *************************/
+//
+// Queues the object's shadow to be moved under it by UpdateShadows,
+// which runs once after all the objects have moved.
+//
 
 void UpdateShadow(ObjNode *theNode)
 {
-ObjNode *shadowNode,*thisNodePtr;
-long	x,y,z;
-float	dist;
-
 	if (theNode == nil)
 		return;
 
+	if (theNode->ShadowNode == nil)
+		return;
+
+	if (theNode->ShadowUpdatePending)									// already queued
+		return;
+
+	if (gNumPendingShadows >= MAX_PENDING_SHADOWS)						// queue full, do it now the slow way
+	{
+		MoveShadowUnderObject(theNode, false);
+		return;
+	}
+
+	theNode->ShadowUpdatePending = true;
+	gPendingShadows[gNumPendingShadows++] = theNode;
+}
+
+
+/************************ UPDATE SHADOWS *************************/
+//
+// Moves all the shadows queued by UpdateShadow.
+// MoveObjects & MoveSplineObjects call this when they're done.
+//
+
+void UpdateShadows(void)
+{
+	if (gNumPendingShadows == 0)
+		return;
+
+	BuildShadowBlockerGrid();
+
+	for (int i = 0; i < gNumPendingShadows; i++)
+	{
+		ObjNode* theNode = gPendingShadows[i];
+
+		theNode->ShadowUpdatePending = false;
+
+		if (theNode->CType == INVALID_NODE_FLAG)						// deleted since it was queued
+			continue;
+
+		MoveShadowUnderObject(theNode, true);
+	}
+
+	gNumPendingShadows = 0;
+}
+
+
+/************************ CANCEL SHADOW UPDATE *************************/
+//
+// Takes a node out of the shadow queue before its memory goes away.
+//
+
+void CancelShadowUpdate(ObjNode *theNode)
+{
+	if (!theNode->ShadowUpdatePending)
+		return;
+
+	for (int i = 0; i < gNumPendingShadows; i++)
+	{
+		if (gPendingShadows[i] == theNode)
+		{
+			gPendingShadows[i] = gPendingShadows[--gNumPendingShadows];	// order doesn't matter
+			break;
+		}
+	}
+
+	theNode->ShadowUpdatePending = false;
+}
+
+
+/************************ MOVE SHADOW UNDER OBJECT *************************/
+
+static void MoveShadowUnderObject(ObjNode *theNode, Boolean useBlockerGrid)
+{
+ObjNode *shadowNode,*blocker;
+long	x,y,z;
+float	dist;
+
 	shadowNode = theNode->ShadowNode;
 	if (shadowNode == nil)
 		return;
@@ -288,47 +410,34 @@ float	dist;
 		
 	if (shadowNode->CheckForBlockers)
 	{
-		thisNodePtr = gFirstNodePtr;
-		do
+		if (gCommandLine.checkCollisionGrid && useBlockerGrid)
+		{
+			blocker = FindShadowBlocker(x, y, z, true);
+			if (blocker != FindShadowBlocker(x, y, z, false))
+				DoFatalAlert("Shadow blocker grid mismatch at %ld,%ld,%ld", x, y, z);
+		}
+		else
+			blocker = FindShadowBlocker(x, y, z, useBlockerGrid);
+
+		if (blocker)
 		{
-			if (thisNodePtr->CType & CTYPE_BLOCKSHADOW)						// look for things which can block the shadow
+				/* SHADOW IS ON OBJECT  */
+
+			// Use same draw order as object we're standing on top of
+			shadowNode->RenderModifiers.drawOrder = blocker->RenderModifiers.drawOrder;
+
+			shadowNode->Coord.y = blocker->CollisionBoxes[0].top + SHADOW_Y_OFF;
+			
+			if (blocker->CType & CTYPE_LIQUID)							// if liquid, move to top
 			{
-				if (thisNodePtr->CollisionBoxes)
-				{
-					if (y < thisNodePtr->CollisionBoxes[0].bottom)
-						goto next;
-					if (x < thisNodePtr->CollisionBoxes[0].left)
-						goto next;
-					if (x > thisNodePtr->CollisionBoxes[0].right)
-						goto next;
-					if (z > thisNodePtr->CollisionBoxes[0].front)
-						goto next;
-					if (z < thisNodePtr->CollisionBoxes[0].back)
-						goto next;
-
-						/* SHADOW IS ON OBJECT  */
-
-					// Use same draw order as object we're standing on top of
-					shadowNode->RenderModifiers.drawOrder = thisNodePtr->RenderModifiers.drawOrder;
-
-					shadowNode->Coord.y = thisNodePtr->CollisionBoxes[0].top + SHADOW_Y_OFF;
-					
-					if (thisNodePtr->CType & CTYPE_LIQUID)						// if liquid, move to top
-					{
-						shadowNode->Coord.y += gLiquidCollisionTopOffset[thisNodePtr->Kind];
-					}
-					
-					shadowNode->Scale.x = shadowNode->SpecialF[0];				// use preset scale
-					shadowNode->Scale.z = shadowNode->SpecialF[1];
-					UpdateObjectTransforms(shadowNode);
-					return;
-					
-				}
-			}		
-	next:					
-			thisNodePtr = (ObjNode *)thisNodePtr->NextNode;		// next node
+				shadowNode->Coord.y += gLiquidCollisionTopOffset[blocker->Kind];
+			}
+			
+			shadowNode->Scale.x = shadowNode->SpecialF[0];				// use preset scale
+			shadowNode->Scale.z = shadowNode->SpecialF[1];
+			UpdateObjectTransforms(shadowNode);
+			return;
 		}
-		while (thisNodePtr != nil);
 	}		
 		
 			/************************/
@@ -353,6 +462,206 @@ float	dist;
 }
 
 
+/************************ BUILD SHADOW BLOCKER GRID *************************/
+//
+// Snapshots the 1st collision box of every CTYPE_BLOCKSHADOW object (in object list order)
+// and buckets them by the cells of a coarse x/z grid they overlap, so that FindShadowBlocker
+// only has to look at the blockers in one cell.
+// Blockers that cover too many cells go in a "loose" list that every lookup checks.
+// If there are too many blockers for the tables, gShadowBlockerGridValid stays false
+// and lookups walk the object list like they used to.
+//
+
+static void BuildShadowBlockerGrid(void)
+{
+int	numEntries = 0;
+
+	gShadowBlockerGridValid = false;
+	gNumShadowBlockers = 0;
+	gNumLooseShadowBlockers = 0;
+
+			/* SIZE THE GRID TO THE TERRAIN */
+			//
+			// No terrain (e.g. on the title screen) gives a single cell.
+			//
+
+	gShadowBlockerCellSize = TERRAIN_SUPERTILE_UNIT_SIZE;
+	while (gTerrainUnitWidth > gShadowBlockerCellSize * SHADOW_BLOCKER_GRID_MAX_SIZE
+		|| gTerrainUnitDepth > gShadowBlockerCellSize * SHADOW_BLOCKER_GRID_MAX_SIZE)
+	{
+		gShadowBlockerCellSize *= 2;
+	}
+
+	gShadowBlockerGridWidth = (int) ((gTerrainUnitWidth + gShadowBlockerCellSize - 1) / gShadowBlockerCellSize);
+	gShadowBlockerGridDepth = (int) ((gTerrainUnitDepth + gShadowBlockerCellSize - 1) / gShadowBlockerCellSize);
+	if (gShadowBlockerGridWidth < 1)
+		gShadowBlockerGridWidth = 1;
+	if (gShadowBlockerGridDepth < 1)
+		gShadowBlockerGridDepth = 1;
+
+	int numCells = gShadowBlockerGridWidth * gShadowBlockerGridDepth;
+
+			/* GATHER BLOCKERS */
+
+	for (ObjNode* node = gFirstNodePtr; node != nil; node = node->NextNode)
+	{
+		if (!(node->CType & CTYPE_BLOCKSHADOW) || !node->CollisionBoxes)
+			continue;
+
+		if (gNumShadowBlockers >= MAX_SHADOW_BLOCKERS)
+			return;
+
+		ShadowBlockerType* blocker = &gShadowBlockers[gNumShadowBlockers++];
+		const CollisionBoxType* box = &node->CollisionBoxes[0];
+
+		blocker->node	= node;
+		blocker->left	= box->left;
+		blocker->right	= box->right;
+		blocker->back	= box->back;
+		blocker->front	= box->front;
+		blocker->bottom	= box->bottom;
+		blocker->colMin	= GetShadowBlockerCol(box->left);
+		blocker->colMax	= GetShadowBlockerCol(box->right);
+		blocker->rowMin	= GetShadowBlockerRow(box->back);
+		blocker->rowMax	= GetShadowBlockerRow(box->front);
+
+		int numCellsCovered = (blocker->colMax - blocker->colMin + 1) * (blocker->rowMax - blocker->rowMin + 1);
+
+		if (!(box->left <= box->right && box->back <= box->front)				// empty or NaN box: let the loose list deal with it
+			|| numCellsCovered > SHADOW_BLOCKER_MAX_CELLS)
+		{
+			gLooseShadowBlockers[gNumLooseShadowBlockers++] = gNumShadowBlockers - 1;
+			blocker->colMin = 1;
+			blocker->colMax = 0;
+		}
+		else
+			numEntries += numCellsCovered;
+	}
+
+	if (numEntries > MAX_SHADOW_BLOCKER_ENTRIES)
+		return;
+
+			/* COUNT ENTRIES PER CELL */
+
+	memset(gShadowBlockerCellStart, 0, (numCells + 1) * sizeof(gShadowBlockerCellStart[0]));
+
+	for (int i = 0; i < gNumShadowBlockers; i++)
+	{
+		const ShadowBlockerType* blocker = &gShadowBlockers[i];
+		for (int row = blocker->rowMin; row <= blocker->rowMax && blocker->colMin <= blocker->colMax; row++)
+			for (int col = blocker->colMin; col <= blocker->colMax; col++)
+				gShadowBlockerCellStart[row * gShadowBlockerGridWidth + col + 1]++;
+	}
+
+	for (int cell = 0; cell < numCells; cell++)
+		gShadowBlockerCellStart[cell + 1] += gShadowBlockerCellStart[cell];
+
+			/* FILL CELLS IN BLOCKER ORDER */
+			//
+			// So each cell lists its blockers in object list order.
+			//
+
+	static int fill[SHADOW_BLOCKER_GRID_MAX_SIZE * SHADOW_BLOCKER_GRID_MAX_SIZE];
+	memcpy(fill, gShadowBlockerCellStart, numCells * sizeof(fill[0]));
+
+	for (int i = 0; i < gNumShadowBlockers; i++)
+	{
+		const ShadowBlockerType* blocker = &gShadowBlockers[i];
+		for (int row = blocker->rowMin; row <= blocker->rowMax && blocker->colMin <= blocker->colMax; row++)
+			for (int col = blocker->colMin; col <= blocker->colMax; col++)
+				gShadowBlockerEntries[fill[row * gShadowBlockerGridWidth + col]++] = i;
+	}
+
+	gShadowBlockerGridValid = true;
+}
+
+
+/************************ GET SHADOW BLOCKER COL/ROW *************************/
+//
+// Coords off the grid clamp to the edge cells, which keeps lookups exact for blockers off the map too.
+//
+
+static inline int GetShadowBlockerCol(float x)
+{
+	float col = floorf(x / gShadowBlockerCellSize);
+	if (!(col >= 0))												// (also catches NaN)
+		return 0;
+	if (col >= gShadowBlockerGridWidth)
+		return gShadowBlockerGridWidth - 1;
+	return (int) col;
+}
+
+static inline int GetShadowBlockerRow(float z)
+{
+	float row = floorf(z / gShadowBlockerCellSize);
+	if (!(row >= 0))
+		return 0;
+	if (row >= gShadowBlockerGridDepth)
+		return gShadowBlockerGridDepth - 1;
+	return (int) row;
+}
+
+
+/************************ FIND SHADOW BLOCKER *************************/
+//
+// Returns the first CTYPE_BLOCKSHADOW object in the object list whose 1st collision box
+// is under the given point, or nil if the shadow goes on the terrain.
+//
+
+static inline Boolean IsPointOnShadowBlocker(const ShadowBlockerType* blocker, long x, long y, long z)
+{
+	return !(y < blocker->bottom
+			|| x < blocker->left
+			|| x > blocker->right
+			|| z > blocker->front
+			|| z < blocker->back);
+}
+
+static ObjNode *FindShadowBlocker(long x, long y, long z, Boolean useGrid)
+{
+	if (!useGrid || !gShadowBlockerGridValid)
+	{
+		for (ObjNode* node = gFirstNodePtr; node != nil; node = node->NextNode)
+		{
+			if (!(node->CType & CTYPE_BLOCKSHADOW) || !node->CollisionBoxes)		// look for things which can block the shadow
+				continue;
+
+			const CollisionBoxType* box = &node->CollisionBoxes[0];
+			if (y < box->bottom || x < box->left || x > box->right || z > box->front || z < box->back)
+				continue;
+
+			return node;
+		}
+		return nil;
+	}
+
+	int best = gNumShadowBlockers;
+	int cell = GetShadowBlockerRow(z) * gShadowBlockerGridWidth + GetShadowBlockerCol(x);
+
+	for (int k = gShadowBlockerCellStart[cell]; k < gShadowBlockerCellStart[cell + 1]; k++)
+	{
+		int i = gShadowBlockerEntries[k];
+		if (IsPointOnShadowBlocker(&gShadowBlockers[i], x, y, z))
+		{
+			best = i;
+			break;
+		}
+	}
+
+	for (int k = 0; k < gNumLooseShadowBlockers && gLooseShadowBlockers[k] < best; k++)
+	{
+		int i = gLooseShadowBlockers[k];
+		if (IsPointOnShadowBlocker(&gShadowBlockers[i], x, y, z))
+		{
+			best = i;
+			break;
+		}
+	}
+
+	return best < gNumShadowBlockers ? gShadowBlockers[best].node : nil;
+}
+
+
 
 //============================================================================================================
 //============================================================================================================
@@ -0,0 +1,298 @@
+// PROFILER.C
+// This file is part of Bugdom. https://github.com/jorio/bugdom
+//
+// Times a few subsystems every frame. The rolling averages and 99th percentiles
+// are shown in the --stats overlay, and pressing F9 records the next few seconds
+// of zones to a Chrome trace file (chrome://tracing) in the prefs folder.
+// A benchmark run keeps every frame's timings and prints a summary at the end.
+//
+// Only CPU time is measured: GL work shows up wherever the driver decides to block,
+// usually in the swap.
+//
+
+#include "game.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define PROFILER_HISTORY_FRAMES		300					// rolling window for averages & percentiles
+#define PROFILER_TRACE_FRAMES		300					// how many frames F9 records
+#define PROFILER_TRACE_MAX_EVENTS	(PROFILER_TRACE_FRAMES * 64)
+#define PROFILER_TRACE_EVENT_CHARS	96					// generous upper bound of one event's JSON
+#define PROFILER_TRACE_FILE_NAME	"Trace.json"
+#define PROFILER_RUN_MAX_FRAMES		(60 * 60 * 15)		// 15 minutes @ 60 fps
+#define PROFILER_RUN_FRAME_ZONE		NUM_PROFILER_ZONES	// extra "zone" for whole frames in run samples
+
+typedef struct
+{
+	uint64_t	start;
+	uint64_t	duration;
+	int			zone;								// -1 = whole frame
+} ProfilerTraceEvent;
+
+static const char* kZoneNames[NUM_PROFILER_ZONES] =
+{
+	[PROFILER_ZONE_INPUT]			= "UpdateInput",
+	[PROFILER_ZONE_MOVE_OBJECTS]	= "MoveObjects",
+	[PROFILER_ZONE_PARTICLES]		= "MoveParticleGroups",
+	[PROFILER_ZONE_CAMERA]			= "UpdateCamera",
+	[PROFILER_ZONE_TERRAIN_UPDATE]	= "DoMyTerrainUpdate",
+	[PROFILER_ZONE_DRAW_TERRAIN]	= "DrawTerrain",
+	[PROFILER_ZONE_DRAW_OBJECTS]	= "DrawObjects",
+	[PROFILER_ZONE_FLUSH_QUEUE]		= "Render_FlushQueue",
+	[PROFILER_ZONE_SWAP]			= "SDL_GL_SwapWindow",
+};
+
+static uint64_t		gFrequency = 0;
+static uint64_t		gFrameStart = 0;
+static uint64_t		gZoneStart[NUM_PROFILER_ZONES];				// 0 = zone isn't running
+static uint64_t		gZoneFrameTicks[NUM_PROFILER_ZONES];		// total time spent in each zone this frame
+
+static float		gHistoryMS[NUM_PROFILER_ZONES][PROFILER_HISTORY_FRAMES];
+static int			gHistoryNext = 0;
+static int			gHistoryCount = 0;
+
+static ProfilerTraceEvent*	gTraceEvents = NULL;
+static int			gNumTraceEvents = 0;
+static int			gTraceFramesLeft = 0;
+static uint64_t		gTraceStart = 0;
+
+static float*		gRunSamplesMS[NUM_PROFILER_ZONES + 1];		// every frame of a benchmark run (NULL = no run)
+static int			gRunNumFrames = 0;
+
+static void WriteTrace(void);
+
+//-----------------------------------------------------------------------------
+
+static bool IsProfiling(void)
+{
+	return gDebugMode != DEBUG_MODE_OFF || gTraceFramesLeft > 0 || gRunSamplesMS[0] != NULL;
+}
+
+static void AddTraceEvent(int zone, uint64_t start, uint64_t end)
+{
+	if (gTraceFramesLeft <= 0 || gNumTraceEvents >= PROFILER_TRACE_MAX_EVENTS)
+		return;
+
+	ProfilerTraceEvent* event = &gTraceEvents[gNumTraceEvents++];
+	event->zone = zone;
+	event->start = start;
+	event->duration = end - start;
+}
+
+void Profiler_BeginZone(int zone)
+{
+	GAME_ASSERT(zone >= 0 && zone < NUM_PROFILER_ZONES);
+
+	gZoneStart[zone] = IsProfiling() ? SDL_GetPerformanceCounter() : 0;
+}
+
+void Profiler_EndZone(int zone)
+{
+	GAME_ASSERT(zone >= 0 && zone < NUM_PROFILER_ZONES);
+
+	if (gZoneStart[zone] == 0)						// profiling was off when the zone began
+		return;
+
+	uint64_t now = SDL_GetPerformanceCounter();
+	gZoneFrameTicks[zone] += now - gZoneStart[zone];
+	AddTraceEvent(zone, gZoneStart[zone], now);
+	gZoneStart[zone] = 0;
+}
+
+void Profiler_EndFrame(void)
+{
+	if (gFrequency == 0)
+		gFrequency = SDL_GetPerformanceFrequency();
+
+	uint64_t now = SDL_GetPerformanceCounter();
+
+	if (IsProfiling())
+	{
+		bool keepRunSample = gRunSamplesMS[0] != NULL && gFrameStart != 0 && gRunNumFrames < PROFILER_RUN_MAX_FRAMES;
+
+		for (int zone = 0; zone < NUM_PROFILER_ZONES; zone++)
+		{
+			gHistoryMS[zone][gHistoryNext] = gZoneFrameTicks[zone] * 1000.0f / gFrequency;
+			if (keepRunSample)
+				gRunSamplesMS[zone][gRunNumFrames] = gHistoryMS[zone][gHistoryNext];
+			gZoneFrameTicks[zone] = 0;
+		}
+
+		if (keepRunSample)
+		{
+			gRunSamplesMS[PROFILER_RUN_FRAME_ZONE][gRunNumFrames] = (now - gFrameStart) * 1000.0f / gFrequency;
+			gRunNumFrames++;
+		}
+
+		gHistoryNext = (gHistoryNext + 1) % PROFILER_HISTORY_FRAMES;
+		if (gHistoryCount < PROFILER_HISTORY_FRAMES)
+			gHistoryCount++;
+
+		if (gFrameStart != 0)
+			AddTraceEvent(-1, gFrameStart, now);
+
+		if (gTraceFramesLeft > 0 && --gTraceFramesLeft == 0)
+			WriteTrace();
+	}
+	else
+	{
+		gHistoryCount = 0;							// start over with fresh numbers next time
+		gHistoryNext = 0;
+	}
+
+	gFrameStart = now;
+}
+
+//-----------------------------------------------------------------------------
+
+static int CompareFloats(const void* a, const void* b)
+{
+	float fa = *(const float*) a;
+	float fb = *(const float*) b;
+	return (fa > fb) - (fa < fb);
+}
+
+void Profiler_GetStatsText(char* buf, size_t bufSize)
+{
+	static float sorted[PROFILER_HISTORY_FRAMES];
+	size_t len = 0;
+
+	buf[0] = '\0';
+
+	if (gHistoryCount == 0)
+		return;
+
+	for (int zone = 0; zone < NUM_PROFILER_ZONES && len < bufSize; zone++)
+	{
+		float total = 0;
+		for (int i = 0; i < gHistoryCount; i++)
+		{
+			sorted[i] = gHistoryMS[zone][i];
+			total += sorted[i];
+		}
+
+		qsort(sorted, gHistoryCount, sizeof(float), CompareFloats);
+
+		int p99Index = (gHistoryCount * 99 + 99) / 100 - 1;		// nearest rank
+
+		len += snprintf(buf + len, bufSize - len, "%s: %.2f / %.2fms\n",
+				kZoneNames[zone],
+				total / gHistoryCount,
+				sorted[p99Index]);
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+void Profiler_StartRun(void)
+{
+	GAME_ASSERT(gRunSamplesMS[0] == NULL);
+
+	for (int zone = 0; zone <= NUM_PROFILER_ZONES; zone++)
+		gRunSamplesMS[zone] = (float*) AllocPtr(sizeof(float) * PROFILER_RUN_MAX_FRAMES);
+
+	gRunNumFrames = 0;
+	gFrameStart = 0;								// don't count the partial frame we're in
+}
+
+void Profiler_EndRun(void)
+{
+	GAME_ASSERT(gRunSamplesMS[0] != NULL);
+
+	printf("\n%d frames%s\n", gRunNumFrames, gRunNumFrames == PROFILER_RUN_MAX_FRAMES ? " (stopped counting)" : "");
+	printf("%-20s %8s %8s %8s %8s\n", "ms", "avg", "median", "p99", "max");
+
+	for (int zone = 0; zone <= NUM_PROFILER_ZONES && gRunNumFrames > 0; zone++)
+	{
+		float* samples = gRunSamplesMS[zone];
+		float total = 0;
+
+		for (int i = 0; i < gRunNumFrames; i++)
+			total += samples[i];
+
+		qsort(samples, gRunNumFrames, sizeof(float), CompareFloats);
+
+		printf("%-20s %8.3f %8.3f %8.3f %8.3f\n",
+				zone == PROFILER_RUN_FRAME_ZONE ? "Frame" : kZoneNames[zone],
+				total / gRunNumFrames,
+				samples[gRunNumFrames / 2],
+				samples[(gRunNumFrames * 99 + 99) / 100 - 1],
+				samples[gRunNumFrames - 1]);
+	}
+
+	for (int zone = 0; zone <= NUM_PROFILER_ZONES; zone++)
+	{
+		DisposePtr((Ptr) gRunSamplesMS[zone]);
+		gRunSamplesMS[zone] = NULL;
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+void Profiler_StartTrace(void)
+{
+	if (gTraceFramesLeft > 0)						// already recording
+		return;
+
+	if (!gTraceEvents)
+		gTraceEvents = (ProfilerTraceEvent*) AllocPtr(sizeof(ProfilerTraceEvent) * PROFILER_TRACE_MAX_EVENTS);
+
+	gNumTraceEvents = 0;
+	gTraceFramesLeft = PROFILER_TRACE_FRAMES;
+	gTraceStart = SDL_GetPerformanceCounter();
+	gFrameStart = 0;								// don't record the partial frame we're in
+}
+
+static void WriteTrace(void)
+{
+	size_t	bufSize = (size_t) (gNumTraceEvents + 2) * PROFILER_TRACE_EVENT_CHARS;
+	char*	buf = AllocPtr(bufSize);
+	size_t	len = 0;
+	FSSpec	spec;
+	short	refNum;
+	long	count;
+	OSErr	iErr;
+
+	len += snprintf(buf + len, bufSize - len, "{\"traceEvents\":[\n");
+
+	for (int i = 0; i < gNumTraceEvents; i++)
+	{
+		const ProfilerTraceEvent* event = &gTraceEvents[i];
+
+		len += snprintf(buf + len, bufSize - len,
+				"{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.1f,\"dur\":%.1f}%s\n",
+				event->zone < 0 ? "Frame" : kZoneNames[event->zone],
+				(event->start - gTraceStart) * 1e6 / gFrequency,
+				event->duration * 1e6 / gFrequency,
+				i == gNumTraceEvents - 1 ? "" : ",");
+	}
+
+	len += snprintf(buf + len, bufSize - len, "]}\n");
+	GAME_ASSERT(len < bufSize);
+
+			/* WRITE THE FILE */
+
+	MakePrefsFSSpec(PROFILER_TRACE_FILE_NAME, true, &spec);
+	FSpDelete(&spec);
+
+	iErr = FSpCreate(&spec, 'BalZ', 'TEXT', smSystemScript);
+	if (iErr == noErr)
+		iErr = FSpOpenDF(&spec, fsRdWrPerm, &refNum);
+
+	if (iErr == noErr)
+	{
+		count = len;
+		iErr = FSWrite(refNum, &count, buf);
+		FSClose(refNum);
+	}
+
+	if (iErr != noErr)
+		printf("Couldn't write %s (error %d)\n", PROFILER_TRACE_FILE_NAME, iErr);
+	else
+		printf("Wrote %d profiler events to %s\n", gNumTraceEvents, PROFILER_TRACE_FILE_NAME);
+
+	DisposePtr(buf);
+	DisposePtr((Ptr) gTraceEvents);
+	gTraceEvents = NULL;
+	gNumTraceEvents = 0;
+}
@@ -11,7 +11,8 @@ char						gTypedAsciiKey = '\0';
 static const uint32_t	kDebugTextUpdateInterval = 0;//50;
 static uint32_t			gDebugTextFrameAccumulator = 0;
 static uint32_t			gDebugTextLastUpdatedAt = 0;
-static char				gDebugTextBuffer[1024];
+static char				gDebugTextBuffer[2048];
+static char				gProfilerTextBuffer[1024];
 
 static void UpdateDebugStats(void)
 {
@@ -33,20 +34,36 @@ static void UpdateDebugStats(void)
 			case 3: debugModeName = "show splines"; break;
 		}
 
+		int tileCacheImages, tileCacheKB;
+		float tileCacheBuildMS, tileCacheSavedMS;
+		GetTileTextureCacheStats(&tileCacheImages, &tileCacheKB, &tileCacheBuildMS, &tileCacheSavedMS);
+
+		Profiler_GetStatsText(gProfilerTextBuffer, sizeof(gProfilerTextBuffer));
+
 		snprintf(
 				gDebugTextBuffer, sizeof(gDebugTextBuffer),
-				"fps: %d\ntris: %d\nmeshes: %d+%d\ntiles: %ld/%ld%s\nnodes: %d\nheap: %dK, %dp\n\nx: %d\nz: %d\ny: %.3f %s%s\n%s\n%s\n\n\n\n\n\n\n\n\n"
+				"fps: %d\ntris: %d\nmeshes: %d+%d\ndraws: %d (%d merged)\nstate chg: %d\nqueue: %d/%d\ntiles: %ld/%ld%s\ntile cache: %d, %dK\n  built %.1fms, saved %.1fms\nnodes: %d\nheap: %dK, %dp\n\n%s\nx: %d\nz: %d\ny: %.3f %s%s\n%s\n%s\n\n\n\n\n\n"
 				"Bugdom %s\nOpenGL %s, %s @ %dx%d",
 				(int)roundf(fps),
 				gRenderStats.triangles,
 				gRenderStats.meshesPass1,
 				gRenderStats.meshesPass2,
+				gRenderStats.drawCalls,
+				gRenderStats.batchedMeshes,
+				gRenderStats.stateChanges,
+				gRenderStats.queueHighWaterMark,
+				gRenderStats.queueCapacity,
 				gSupertileBudget - gNumFreeSupertiles,
 				gSupertileBudget,
 				gSuperTileMemoryListExists ? "" : " (no terrain)",
+				tileCacheImages,
+				tileCacheKB,
+				tileCacheBuildMS,
+				tileCacheSavedMS,
 				gNumObjNodes,
 				(int)(Pomme_GetHeapSize() / 1024),
 				(int)Pomme_GetNumAllocs(),
+				gProfilerTextBuffer,
 				(int)(gPlayerObj? gPlayerObj->Coord.x: 0),
 				(int)(gPlayerObj? gPlayerObj->Coord.z: 0),
 				gPlayerObj? gPlayerObj->Coord.y: 0,
@@ -151,4 +168,9 @@ void DoSDLMaintenance(void)
 
 		glPolygonMode(GL_FRONT_AND_BACK, gDebugMode == DEBUG_MODE_WIREFRAME? GL_LINE: GL_FILL);
 	}
+
+	if (GetNewKeyState_SDL(SDL_SCANCODE_F9))			// record a profiler trace
+	{
+		Profiler_StartTrace();
+	}
 }
@@ -54,6 +54,9 @@ static struct
 #define MOUSE_DELTA_MAX 250
 #define MOUSE_DELTA_MAX_SQUARED (MOUSE_DELTA_MAX*MOUSE_DELTA_MAX)
 
+#define INPUT_RECORDING_MAGIC		'BInp'
+#define INPUT_RECORDING_VERSION		1
+
 #define SDLKEYSTATEBUF_SIZE SDL_NUM_SCANCODES
 
 static const float kMouseSensitivityTable[NUM_MOUSE_SENSITIVITY_LEVELS] =
@@ -78,6 +81,28 @@ enum
 	KEYSTATE_IGNOREHELD		= KEYSTATE_OFF | KEYSTATE_IGNORE_BIT,
 };
 
+typedef struct
+{
+	KeyState	keys[kKey_MAX];
+	KeyState	rawKeys[SDLKEYSTATEBUF_SIZE];
+	KeyState	mouseButtons[NUM_MOUSE_BUTTONS];
+	Boolean		playerUsingKeyControl;
+	Boolean		hasController;
+	int			mouseDX, mouseDY;					// smoothed mouse delta
+	TQ3Vector2D	leftStick;
+	TQ3Vector2D	cameraControlDelta;
+} RecordedInputFrame;
+
+typedef struct
+{
+	uint32_t	magic;								// INPUT_RECORDING_MAGIC
+	uint32_t	version;
+	uint32_t	frameSize;							// sizeof(RecordedInputFrame) (rejects files from builds with other key tables)
+	int32_t		level;
+	uint32_t	numFrames;
+	PrefsType	prefs;								// the player's settings at the time (control options affect the game)
+} InputRecordingHeader;
+
 
 /**********************/
 /*     VARIABLES      */
@@ -87,6 +112,15 @@ long				gEatMouse = 0;
 static KeyState		gMouseButtonState[NUM_MOUSE_BUTTONS];
 static KeyState		gKeyStates[kKey_MAX];
 static KeyState		gRawKeyboardState[SDLKEYSTATEBUF_SIZE];
+static Boolean		gMuteNewKeyStates = false;
+
+static int					gInputRecordingMode = INPUT_RECORDING_OFF;
+static const char*			gInputRecordingPath = NULL;
+static InputRecordingHeader	gInputRecordingHeader;
+static RecordedInputFrame*	gRecordedFrames = NULL;
+static uint32_t				gRecordedFramesCapacity = 0;
+static uint32_t				gCurrentRecordedFrame = 0;
+static const RecordedInputFrame*	gReplayFrame = NULL;		// frame being replayed (overrides the devices)
 
 Boolean				gPlayerUsingKeyControl 	= false;
 
@@ -179,6 +213,11 @@ TQ3Vector2D GetThumbStickVector(bool rightStick)
 	(void) rightStick;
 	return (TQ3Vector2D) {0,0};
 #else
+	if (gReplayFrame && !rightStick)				// (the right stick only feeds gCameraControlDelta, which is replayed as is)
+	{
+		return gReplayFrame->leftStick;
+	}
+
 	if (!gSDLController)
 	{
 		return (TQ3Vector2D) { 0, 0 };
@@ -227,6 +266,8 @@ TQ3Vector2D GetThumbStickVector(bool rightStick)
 
 void UpdateInput(void)
 {
+	Profiler_BeginZone(PROFILER_ZONE_INPUT);
+
 	SDL_PumpEvents();
 
 		/* CHECK FOR NEW MOUSE BUTTONS */
@@ -282,6 +323,8 @@ void UpdateInput(void)
 
 	if (GetKeyState(kKey_SwivelCameraRight))
 		gCameraControlDelta.x += 2.0f;
+
+	Profiler_EndZone(PROFILER_ZONE_INPUT);
 }
 
 
@@ -311,6 +354,37 @@ void InvalidateKeyState(int need)
 }
 
 
+/**************** AGE INPUT STATE *************/
+//
+// Turns the last presses/releases into plain held/off states without polling the devices again,
+// for frames that don't run a simulation step (so that the next step still sees new presses).
+//
+
+void AgeInputState(void)
+{
+	for (int i = 0; i < kKey_MAX; i++)
+		gKeyStates[i] &= ~KEYSTATE_CHANGE_BIT;
+
+	for (int i = 0; i < SDLKEYSTATEBUF_SIZE; i++)
+		gRawKeyboardState[i] &= ~KEYSTATE_CHANGE_BIT;
+
+	for (int i = 0; i < NUM_MOUSE_BUTTONS; i++)
+		gMouseButtonState[i] &= ~KEYSTATE_CHANGE_BIT;
+}
+
+
+/**************** MUTE NEW KEY STATES *************/
+//
+// While muted, GetNewKeyState doesn't report this frame's presses (the keys still read as held).
+// Used for the extra simulation steps of a frame so that they don't act on the same press twice.
+//
+
+void MuteNewKeyStates(Boolean mute)
+{
+	gMuteNewKeyStates = mute;
+}
+
+
 
 /**************** UPDATE KEY MAP *************/
 //
@@ -400,14 +474,14 @@ Boolean GetKeyState_SDL(unsigned short key)
 Boolean GetNewKeyState(unsigned short key)
 {
 	GAME_ASSERT(key < kKey_MAX);
-	return gKeyStates[key] == KEYSTATE_PRESSED;
+	return !gMuteNewKeyStates && gKeyStates[key] == KEYSTATE_PRESSED;
 }
 
 Boolean GetNewKeyState_SDL(unsigned short key)
 {
 	if (key >= SDLKEYSTATEBUF_SIZE)
 		return false;
-	return gRawKeyboardState[key] == KEYSTATE_PRESSED;
+	return !gMuteNewKeyStates && gRawKeyboardState[key] == KEYSTATE_PRESSED;
 }
 
 /******* DOES USER WANT TO SKIP TO NEXT SCREEN *******/
@@ -497,7 +571,7 @@ void GetMouseDelta(float *dx, float *dy)
 
 		/* SEE IF OVERRIDE MOUSE WITH JOYSTICK MOVEMENT */
 
-	if (gSDLController)
+	if (gReplayFrame ? gReplayFrame->hasController : (gSDLController != NULL))
 	{
 		TQ3Vector2D lsVec = GetThumbStickVector(false);
 		if (lsVec.x != 0 || lsVec.y != 0)
@@ -518,7 +592,13 @@ void GetMouseDelta(float *dx, float *dy)
 
 	const float mouseSensitivity = 1600.0f * kMouseSensitivityTable[gGamePrefs.mouseSensitivityLevel];
 	int mdx, mdy;
-	MouseSmoothing_GetDelta(&mdx, &mdy);
+	if (gReplayFrame)
+	{
+		mdx = gReplayFrame->mouseDX;
+		mdy = gReplayFrame->mouseDY;
+	}
+	else
+		MouseSmoothing_GetDelta(&mdx, &mdy);
 
 	if (mdx != 0 && mdy != 0)
 	{
@@ -713,3 +793,173 @@ void WarpMouseToCenter(void)
 
 	SDL_WarpMouseInWindow(gSDLWindow, windowPointWidth/2, windowPointHeight/2);
 }
+
+
+
+#pragma mark -
+
+/********************* START INPUT RECORDING ***********************/
+//
+// Every call to InputRecording_DoFrame will snapshot the input state so it can be
+// saved to the given file by InputRecording_Finish.
+//
+
+void InputRecording_StartRecording(const char* path, int level)
+{
+	GAME_ASSERT(gInputRecordingMode == INPUT_RECORDING_OFF);
+
+	memset(&gInputRecordingHeader, 0, sizeof(gInputRecordingHeader));
+	gInputRecordingHeader.magic		= INPUT_RECORDING_MAGIC;
+	gInputRecordingHeader.version	= INPUT_RECORDING_VERSION;
+	gInputRecordingHeader.frameSize	= sizeof(RecordedInputFrame);
+	gInputRecordingHeader.level		= level;
+	gInputRecordingHeader.prefs		= gGamePrefs;
+
+	gRecordedFramesCapacity	= 60 * 60;								// a minute's worth to start with
+	gRecordedFrames			= (RecordedInputFrame*) AllocPtr(gRecordedFramesCapacity * sizeof(RecordedInputFrame));
+	gCurrentRecordedFrame	= 0;
+	gInputRecordingPath		= path;
+	gInputRecordingMode		= INPUT_RECORDING_RECORD;
+}
+
+
+/********************* START INPUT REPLAY ***********************/
+//
+// Loads a file made with InputRecording_StartRecording. From now on, InputRecording_DoFrame
+// replaces the state read from the devices with the recorded one.
+// The recorded settings replace the player's (they're not saved).
+//
+
+void InputRecording_StartReplay(const char* path, int level)
+{
+	GAME_ASSERT(gInputRecordingMode == INPUT_RECORDING_OFF);
+
+	FILE* file = fopen(path, "rb");
+	if (!file)
+		DoFatalAlert("Can't open input recording %s", path);
+
+	if (1 != fread(&gInputRecordingHeader, sizeof(gInputRecordingHeader), 1, file)
+		|| gInputRecordingHeader.magic != INPUT_RECORDING_MAGIC
+		|| gInputRecordingHeader.version != INPUT_RECORDING_VERSION
+		|| gInputRecordingHeader.frameSize != sizeof(RecordedInputFrame))
+	{
+		DoFatalAlert("%s isn't an input recording made by this version of the game", path);
+	}
+
+	if (gInputRecordingHeader.level != level)
+		DoFatalAlert("%s was recorded on level %d", path, gInputRecordingHeader.level + 1);
+
+	gRecordedFramesCapacity	= gInputRecordingHeader.numFrames;
+	gRecordedFrames			= (RecordedInputFrame*) AllocPtr((gRecordedFramesCapacity + 1) * sizeof(RecordedInputFrame));
+
+	if (gRecordedFramesCapacity != fread(gRecordedFrames, sizeof(RecordedInputFrame), gRecordedFramesCapacity, file))
+		DoFatalAlert("Input recording %s is truncated", path);
+
+	fclose(file);
+
+	gGamePrefs				= gInputRecordingHeader.prefs;
+	gCurrentRecordedFrame	= 0;
+	gInputRecordingPath		= path;
+	gInputRecordingMode		= INPUT_RECORDING_REPLAY;
+}
+
+
+/********************* INPUT RECORDING: DO FRAME ***********************/
+//
+// Call right after UpdateInput on each frame of the recorded session.
+// Returns false when a replay has run out of frames.
+//
+
+Boolean InputRecording_DoFrame(void)
+{
+	RecordedInputFrame* frame;
+
+	switch (gInputRecordingMode)
+	{
+		case INPUT_RECORDING_RECORD:
+			if (gCurrentRecordedFrame == gRecordedFramesCapacity)			// grow the buffer
+			{
+				RecordedInputFrame* bigger = (RecordedInputFrame*) AllocPtr(2 * gRecordedFramesCapacity * sizeof(RecordedInputFrame));
+				memcpy(bigger, gRecordedFrames, gRecordedFramesCapacity * sizeof(RecordedInputFrame));
+				DisposePtr((Ptr) gRecordedFrames);
+				gRecordedFrames = bigger;
+				gRecordedFramesCapacity *= 2;
+			}
+
+			frame = &gRecordedFrames[gCurrentRecordedFrame++];
+			memcpy(frame->keys, gKeyStates, sizeof(frame->keys));
+			memcpy(frame->rawKeys, gRawKeyboardState, sizeof(frame->rawKeys));
+			memcpy(frame->mouseButtons, gMouseButtonState, sizeof(frame->mouseButtons));
+			frame->playerUsingKeyControl	= gPlayerUsingKeyControl;
+			frame->hasController			= gSDLController != NULL;
+			frame->leftStick				= GetThumbStickVector(false);
+			frame->cameraControlDelta		= gCameraControlDelta;
+			MouseSmoothing_GetDelta(&frame->mouseDX, &frame->mouseDY);
+			return true;
+
+		case INPUT_RECORDING_REPLAY:
+			if (gCurrentRecordedFrame == gRecordedFramesCapacity)
+			{
+				gReplayFrame = NULL;
+				return false;
+			}
+
+			frame = &gRecordedFrames[gCurrentRecordedFrame++];
+			memcpy(gKeyStates, frame->keys, sizeof(frame->keys));
+			memcpy(gRawKeyboardState, frame->rawKeys, sizeof(frame->rawKeys));
+			memcpy(gMouseButtonState, frame->mouseButtons, sizeof(frame->mouseButtons));
+			gPlayerUsingKeyControl	= frame->playerUsingKeyControl;
+			gCameraControlDelta		= frame->cameraControlDelta;
+			gReplayFrame			= frame;
+			return true;
+
+		default:
+			return true;
+	}
+}
+
+
+/********************* FINISH INPUT RECORDING ***********************/
+//
+// Saves the recording (if recording) and goes back to reading the devices.
+//
+
+void InputRecording_Finish(void)
+{
+	if (gInputRecordingMode == INPUT_RECORDING_RECORD)
+	{
+		gInputRecordingHeader.numFrames = gCurrentRecordedFrame;
+
+		FILE* file = fopen(gInputRecordingPath, "wb");
+		if (!file
+			|| 1 != fwrite(&gInputRecordingHeader, sizeof(gInputRecordingHeader), 1, file)
+			|| gCurrentRecordedFrame != fwrite(gRecordedFrames, sizeof(RecordedInputFrame), gCurrentRecordedFrame, file))
+		{
+			DoAlert("Couldn't save the input recording.");
+		}
+		else
+		{
+			printf("Recorded %u frames of input to %s\n", gCurrentRecordedFrame, gInputRecordingPath);
+		}
+
+		if (file)
+			fclose(file);
+	}
+
+	if (gRecordedFrames)
+		DisposePtr((Ptr) gRecordedFrames);
+
+	gRecordedFrames			= NULL;
+	gRecordedFramesCapacity	= 0;
+	gReplayFrame			= NULL;
+	gInputRecordingPath		= NULL;
+	gInputRecordingMode		= INPUT_RECORDING_OFF;
+}
+
+
+/********************* GET INPUT RECORDING MODE ***********************/
+
+int InputRecording_GetMode(void)
+{
+	return gInputRecordingMode;
+}
@@ -10,13 +10,6 @@
 #include "game.h"
 
 
-/****************************/
-/*    PROTOTYPES            */
-/****************************/
-
-static void SubmitFence(int f, float camX, float camZ);
-
-
 /****************************/
 /*    CONSTANTS             */
 /****************************/
@@ -24,6 +17,10 @@ static void SubmitFence(int f, float camX, float camZ);
 #define MAX_FENCES			60
 #define	MAX_NUBS_IN_FENCE	40
 
+#define	FENCE_GRID_CELL_SIZE		TERRAIN_SUPERTILE_UNIT_SIZE		// world units per fence segment grid cell
+#define	FENCE_GRID_MARGIN			2.0								// slop for the not-quite-unit line normal & rounding
+#define	MAX_FENCE_CANDIDATES		256								// if a query finds more than this, it checks every segment
+
 #define	NUM_FENCE_SHADERS	9
 
 
@@ -43,6 +40,29 @@ enum
 };
 
 
+/****************************/
+/*    TYPES                 */
+/****************************/
+
+typedef struct
+{
+	int			numCandidates;
+	uint16_t	candidates[MAX_FENCE_CANDIDATES];					// fence * MAX_NUBS_IN_FENCE + segment, sorted
+} FenceSegmentQueryType;
+
+
+/****************************/
+/*    PROTOTYPES            */
+/****************************/
+
+static void SubmitFence(int f, float camX, float camZ);
+static void BuildFenceSegmentGrid(void);
+static void DisposeFenceSegmentGrid(void);
+static void DoFenceCollision_Scan(ObjNode *theNode, float radiusScale, Boolean useGrid);
+static Boolean GatherFenceSegments(FenceSegmentQueryType *query, double oldX, double oldZ, double newX, double newZ, double radius);
+static int NextFenceSegmentCandidate(const FenceSegmentQueryType *query, int fence, int segment);
+
+
 /**********************/
 /*     VARIABLES      */
 /**********************/
@@ -55,6 +75,17 @@ static TQ3TriMeshData*			gFenceTriMeshDataPtrs[MAX_FENCES];
 static RenderModifiers			gFenceRenderMods[MAX_FENCES];
 static GLuint					gFenceTypeTextures[NUM_FENCE_SHADERS];
 
+			/* FENCE SEGMENT GRID */
+			//
+			// Each cell lists the fence segments whose bounding boxes touch it, in fence/segment order.
+			// Segments off the edge of the map are filed in the nearest edge cell.
+			//
+
+static int						gFenceGridWidth = 0;
+static int						gFenceGridDepth = 0;
+static int32_t					*gFenceGridCellStart = nil;		// [cell] -> index of cell's 1st entry in gFenceGridEntries ([numCells] = total)
+static uint16_t					*gFenceGridEntries = nil;		// fence * MAX_NUBS_IN_FENCE + segment
+
 
 static Boolean gFenceOnThisLevel[NUM_LEVEL_TYPES][NUM_FENCE_SHADERS] =
 {
@@ -154,6 +185,8 @@ void DisposeFences(void)
 			gFenceTriMeshDataPtrs[f] = nil;
 		}
 	}
+
+	DisposeFenceSegmentGrid();
 }
 
 
@@ -272,6 +305,124 @@ FencePointType			*nubs;
 			tmd->triangles[j+1].pointIndices[2] = 2 + j;
 		}
 	}
+
+			/* BUCKET THE SEGMENTS FOR COLLISION */
+
+	BuildFenceSegmentGrid();
+}
+
+
+/******************** GET FENCE GRID CELL RANGE ***********************/
+//
+// Clamped to the grid, so anything off the map lands in an edge cell.
+//
+
+static void GetFenceGridCellRange(double left, double right, double back, double front,
+								int *colMin, int *colMax, int *rowMin, int *rowMax)
+{
+	double c0 = floor(left / FENCE_GRID_CELL_SIZE);
+	double c1 = floor(right / FENCE_GRID_CELL_SIZE);
+	double r0 = floor(back / FENCE_GRID_CELL_SIZE);
+	double r1 = floor(front / FENCE_GRID_CELL_SIZE);
+
+	*colMin = c0 < 0 ? 0 : (c0 >= gFenceGridWidth ? gFenceGridWidth - 1 : (int) c0);
+	*colMax = c1 < 0 ? 0 : (c1 >= gFenceGridWidth ? gFenceGridWidth - 1 : (int) c1);
+	*rowMin = r0 < 0 ? 0 : (r0 >= gFenceGridDepth ? gFenceGridDepth - 1 : (int) r0);
+	*rowMax = r1 < 0 ? 0 : (r1 >= gFenceGridDepth ? gFenceGridDepth - 1 : (int) r1);
+}
+
+
+/******************** BUILD FENCE SEGMENT GRID ***********************/
+//
+// Called from PrimeFences once the nubs are in world coords.
+//
+
+static void BuildFenceSegmentGrid(void)
+{
+int		colMin, colMax, rowMin, rowMax;
+
+	DisposeFenceSegmentGrid();
+
+	if (gNumFences == 0)
+		return;
+
+	gFenceGridWidth = (int) ((gTerrainUnitWidth + FENCE_GRID_CELL_SIZE - 1) / FENCE_GRID_CELL_SIZE);
+	gFenceGridDepth = (int) ((gTerrainUnitDepth + FENCE_GRID_CELL_SIZE - 1) / FENCE_GRID_CELL_SIZE);
+	if (gFenceGridWidth < 1)
+		gFenceGridWidth = 1;
+	if (gFenceGridDepth < 1)
+		gFenceGridDepth = 1;
+
+	const int numCells = gFenceGridWidth * gFenceGridDepth;
+
+	gFenceGridCellStart = (int32_t*) AllocPtr((numCells + 1) * sizeof(int32_t));
+	GAME_ASSERT(gFenceGridCellStart);
+
+			/* PASS 1: COUNT ENTRIES PER CELL, PASS 2: FILL THEM IN */
+
+	for (int pass = 0; pass < 2; pass++)
+	{
+		for (int f = 0; f < gNumFences; f++)
+		{
+			const FencePointType* nubs = *gFenceList[f].nubList;
+
+			for (int i = 0; i < gFenceList[f].numNubs - 1; i++)
+			{
+				GetFenceGridCellRange(
+						fmin(nubs[i].x, nubs[i+1].x), fmax(nubs[i].x, nubs[i+1].x),
+						fmin(nubs[i].z, nubs[i+1].z), fmax(nubs[i].z, nubs[i+1].z),
+						&colMin, &colMax, &rowMin, &rowMax);
+
+				for (int row = rowMin; row <= rowMax; row++)
+				{
+					for (int col = colMin; col <= colMax; col++)
+					{
+						int cell = row * gFenceGridWidth + col;
+						if (pass == 0)
+							gFenceGridCellStart[cell + 1]++;
+						else
+							gFenceGridEntries[gFenceGridCellStart[cell]++] = f * MAX_NUBS_IN_FENCE + i;
+					}
+				}
+			}
+		}
+
+		if (pass == 0)											// turn counts into start indices
+		{
+			for (int cell = 0; cell < numCells; cell++)
+				gFenceGridCellStart[cell + 1] += gFenceGridCellStart[cell];
+
+			gFenceGridEntries = (uint16_t*) AllocPtr((gFenceGridCellStart[numCells] + 1) * sizeof(uint16_t));
+			GAME_ASSERT(gFenceGridEntries);
+		}
+		else													// filling in advanced each start to the next cell's start, so shift back
+		{
+			for (int cell = numCells; cell > 0; cell--)
+				gFenceGridCellStart[cell] = gFenceGridCellStart[cell - 1];
+			gFenceGridCellStart[0] = 0;
+		}
+	}
+}
+
+
+/******************** DISPOSE FENCE SEGMENT GRID ***********************/
+
+static void DisposeFenceSegmentGrid(void)
+{
+	if (gFenceGridCellStart)
+	{
+		DisposePtr((Ptr) gFenceGridCellStart);
+		gFenceGridCellStart = nil;
+	}
+
+	if (gFenceGridEntries)
+	{
+		DisposePtr((Ptr) gFenceGridEntries);
+		gFenceGridEntries = nil;
+	}
+
+	gFenceGridWidth = 0;
+	gFenceGridDepth = 0;
 }
 
 
@@ -350,6 +501,32 @@ drawit:
 //
 
 void DoFenceCollision(ObjNode *theNode, float radiusScale)
+{
+	if (gCommandLine.checkCollisionGrid && gFenceGridCellStart)
+	{
+		TQ3Point3D	startCoord = gCoord;
+		TQ3Vector3D	startDelta = gDelta;
+
+		DoFenceCollision_Scan(theNode, radiusScale, false);		// check every segment first
+
+		TQ3Point3D	bruteCoord = gCoord;
+		TQ3Vector3D	bruteDelta = gDelta;
+
+		gCoord = startCoord;
+		gDelta = startDelta;
+		DoFenceCollision_Scan(theNode, radiusScale, true);
+
+		GAME_ASSERT_MESSAGE(0 == memcmp(&bruteCoord, &gCoord, sizeof(gCoord)) && 0 == memcmp(&bruteDelta, &gDelta, sizeof(gDelta)),
+							"Fence grid mismatch in DoFenceCollision");
+	}
+	else
+	{
+		DoFenceCollision_Scan(theNode, radiusScale, true);
+	}
+}
+
+
+static void DoFenceCollision_Scan(ObjNode *theNode, float radiusScale, Boolean useGrid)
 {
 double			fromX,fromZ,toX,toZ;
 long			f,numFenceSegments,i,numReScans;
@@ -360,6 +537,7 @@ double			intersectX,intersectZ;
 TQ3Vector2D		lineNormal;
 double			radius;
 double			oldX,oldZ,newX,newZ;
+FenceSegmentQueryType	query;
 
 	letGoOver = false;
 
@@ -371,6 +549,8 @@ double			oldX,oldZ,newX,newZ;
 	newZ = gCoord.z;
 	radius = theNode->BoundingSphere.radius * radiusScale;
 
+	if (useGrid)													// find the segments near our path
+		useGrid = GatherFenceSegments(&query, oldX, oldZ, newX, newZ, radius);
 
 
 			/****************************************/
@@ -428,6 +608,18 @@ double			oldX,oldZ,newX,newZ;
 		numReScans = 0;	
 		for (i = 0; i < numFenceSegments; i++)
 		{
+					/* SKIP SEGMENTS THAT AREN'T NEAR OUR PATH */
+					//
+					// They can't intersect the motion line & their endpoints can't be within the radius.
+					//
+
+			if (useGrid)
+			{
+				i = NextFenceSegmentCandidate(&query, f, i);
+				if (i < 0)
+					break;
+			}
+
 					/* GET LINE SEG ENDPOINTS */
 					
 			segFromX = nubs[i].x;
@@ -500,6 +692,8 @@ double			oldX,oldZ,newX,newZ;
 						
 				newX = gCoord.x;
 				newZ = gCoord.z;
+				if (useGrid)												// our path changed, so find the segments near it again
+					useGrid = GatherFenceSegments(&query, oldX, oldZ, newX, newZ, radius);
 				if (++numReScans < 5)
 					i = -1;							// reset segment index to scan all again (reset to -1 because for loop will auto-inc to 0 for us)
 			}
@@ -543,6 +737,95 @@ next_fence:;
 }
 
 
+
+/******************** GATHER FENCE SEGMENTS **************************/
+//
+// Finds the fence segments whose cells touch the bounding box of the motion from old to new coord,
+// grown by the radius (the motion line is pushed out by the radius & endpoints within the radius count).
+//
+// Returns false if there are too many, in which case the caller should just check them all.
+//
+
+static Boolean GatherFenceSegments(FenceSegmentQueryType *query, double oldX, double oldZ, double newX, double newZ, double radius)
+{
+int		colMin, colMax, rowMin, rowMax;
+
+	query->numCandidates = 0;
+
+	if (!gFenceGridCellStart)
+		return false;
+
+	double grow = radius + FENCE_GRID_MARGIN;
+	double left		= fmin(oldX, newX) - grow;
+	double right	= fmax(oldX, newX) + grow;
+	double back		= fmin(oldZ, newZ) - grow;
+	double front	= fmax(oldZ, newZ) + grow;
+
+	if (!(left <= right && back <= front))							// NaN
+		return false;
+
+	GetFenceGridCellRange(left, right, back, front, &colMin, &colMax, &rowMin, &rowMax);
+
+	for (int row = rowMin; row <= rowMax; row++)
+	{
+		for (int col = colMin; col <= colMax; col++)
+		{
+			int cell = row * gFenceGridWidth + col;
+
+			for (int e = gFenceGridCellStart[cell]; e < gFenceGridCellStart[cell + 1]; e++)
+			{
+				uint16_t key = gFenceGridEntries[e];
+
+					/* INSERT IN ORDER, SKIPPING DUPLICATES (LONG SEGMENTS ARE IN SEVERAL CELLS) */
+
+				int j = query->numCandidates;
+				while (j > 0 && query->candidates[j - 1] > key)
+					j--;
+
+				if (j > 0 && query->candidates[j - 1] == key)
+					continue;
+
+				if (query->numCandidates >= MAX_FENCE_CANDIDATES)
+					return false;
+
+				memmove(&query->candidates[j + 1], &query->candidates[j], (query->numCandidates - j) * sizeof(uint16_t));
+				query->candidates[j] = key;
+				query->numCandidates++;
+			}
+		}
+	}
+
+	return true;
+}
+
+
+/******************** NEXT FENCE SEGMENT CANDIDATE **************************/
+//
+// OUTPUT: 1st candidate segment of the fence at or after the given segment, or -1 if none
+//
+
+static int NextFenceSegmentCandidate(const FenceSegmentQueryType *query, int fence, int segment)
+{
+	const int key = fence * MAX_NUBS_IN_FENCE + segment;
+
+	int lo = 0;
+	int hi = query->numCandidates;
+	while (lo < hi)													// binary search for 1st candidate >= key
+	{
+		int mid = (lo + hi) / 2;
+		if (query->candidates[mid] < key)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	if (lo >= query->numCandidates || query->candidates[lo] / MAX_NUBS_IN_FENCE != fence)
+		return -1;
+
+	return query->candidates[lo] % MAX_NUBS_IN_FENCE;
+}
+
+
 /******************** SUBMIT FENCE **************************/
 //
 // Visibility checks have already been done, so there's a good chance the fence is visible
@@ -17,6 +17,9 @@
 /****************************/
 
 static Boolean NilPrime(long splineNum, SplineItemType *itemPtr);
+static void BuildSplineSupertileGrid(void);
+static void WakeSplinesNearActiveSupertiles(void);
+static void CheckDormantSplineObject(ObjNode *theNode);
 
 
 /****************************/
@@ -26,6 +29,10 @@ static Boolean NilPrime(long splineNum, SplineItemType *itemPtr);
 #define	MAX_SPLINE_OBJECTS		100
 #define MAX_PLACEMENT			(1.0f - EPS)		// 0 <= placement <= 0.999, in order to avoid buffer overruns when accessing spline point list
 
+#define	SPLINE_GRID_WIDTH		MAX_SUPERTILES_WIDE	// spline grid lines up with gTerrainScrollBuffer
+#define	SPLINE_GRID_DEPTH		MAX_SUPERTILES_DEEP
+#define	SPLINE_GRID_SLOP		1.0f				// world units, covers float error in GetCoordOnSpline's lerp
+
 
 /**********************/
 /*     VARIABLES      */
@@ -37,6 +44,10 @@ long			gNumSplines = 0;
 static long		gNumSplineObjects = 0;
 static ObjNode	*gSplineObjectList[MAX_SPLINE_OBJECTS];
 
+static int32_t	*gSplineGridCellStart = nil;		// [SPLINE_GRID_DEPTH*SPLINE_GRID_WIDTH + 1] cell's first entry in gSplineGridEntries
+static uint16_t	*gSplineGridEntries = nil;			// # of each spline that passes through the cell
+static Boolean	*gSplineAwake = nil;				// [gNumSplines] true if spline passes through an active supertile this frame
+
 
 /**********************/
 /*     TABLES         */
@@ -157,6 +168,10 @@ SplinePointType	*points;
 				itemPtr->flags |= ITEM_FLAGS_INUSE;				// set in-use flag	
 		}
 	}
+
+			/* BUCKET THE SPLINES BY SUPERTILE */
+
+	BuildSplineSupertileGrid();
 }
 
 
@@ -174,6 +189,193 @@ static Boolean NilPrime(long splineNum, SplineItemType *itemPtr)
 }
 
 
+/******************** GET SPLINE GRID CELL RANGE ***********************/
+//
+// Same row/col math as IsSplineItemVisible, clamped to the scroll buffer.
+//
+
+static void GetSplineGridCellRange(float minX, float maxX, float minZ, float maxZ,
+								int *colMin, int *colMax, int *rowMin, int *rowMax)
+{
+	long c0 = (minX - SPLINE_GRID_SLOP) * (1.0f/TERRAIN_SUPERTILE_UNIT_SIZE);
+	long c1 = (maxX + SPLINE_GRID_SLOP) * (1.0f/TERRAIN_SUPERTILE_UNIT_SIZE);
+	long r0 = (minZ - SPLINE_GRID_SLOP) * (1.0f/TERRAIN_SUPERTILE_UNIT_SIZE);
+	long r1 = (maxZ + SPLINE_GRID_SLOP) * (1.0f/TERRAIN_SUPERTILE_UNIT_SIZE);
+
+	*colMin = c0 < 0 ? 0 : (c0 >= SPLINE_GRID_WIDTH ? SPLINE_GRID_WIDTH - 1 : (int) c0);
+	*colMax = c1 < 0 ? 0 : (c1 >= SPLINE_GRID_WIDTH ? SPLINE_GRID_WIDTH - 1 : (int) c1);
+	*rowMin = r0 < 0 ? 0 : (r0 >= SPLINE_GRID_DEPTH ? SPLINE_GRID_DEPTH - 1 : (int) r0);
+	*rowMax = r1 < 0 ? 0 : (r1 >= SPLINE_GRID_DEPTH ? SPLINE_GRID_DEPTH - 1 : (int) r1);
+}
+
+
+/******************** BUILD SPLINE SUPERTILE GRID ***********************/
+//
+// Lists which splines pass through each supertile, so that MoveSplineObjects
+// can tell which splines are anywhere near the active supertiles.
+// Every span is bucketed including the one from the last point back to the first,
+// since GetCoordOnSpline lerps across it too.
+//
+
+static void BuildSplineSupertileGrid(void)
+{
+int		colMin, colMax, rowMin, rowMax;
+const int numCells = SPLINE_GRID_WIDTH * SPLINE_GRID_DEPTH;
+
+	DisposeSplineSupertileGrid();
+
+	if (gNumSplines == 0)
+		return;
+
+	GAME_ASSERT(gNumSplines <= 0xFFFF);
+
+	gSplineGridCellStart = (int32_t*) AllocPtr((numCells + 1) * sizeof(int32_t));
+	GAME_ASSERT(gSplineGridCellStart);
+
+	gSplineAwake = (Boolean*) AllocPtr(gNumSplines * sizeof(Boolean));
+	GAME_ASSERT(gSplineAwake);
+
+	int32_t* lastSplineInCell = (int32_t*) AllocPtr(numCells * sizeof(int32_t));		// spline #+1, so a spline only goes in each cell once
+	GAME_ASSERT(lastSplineInCell);
+
+			/* PASS 1: COUNT ENTRIES PER CELL, PASS 2: FILL THEM IN */
+
+	for (int pass = 0; pass < 2; pass++)
+	{
+		memset(lastSplineInCell, 0, numCells * sizeof(int32_t));
+
+		for (int s = 0; s < gNumSplines; s++)
+		{
+			const SplineDefType* spline = &(*gSplineList)[s];
+			const SplinePointType* points = *spline->pointList;
+			const int numPoints = spline->numPoints;
+
+			for (int i = 0; i < numPoints; i++)
+			{
+				int j = (i < numPoints - 1) ? (i + 1) : 0;
+
+				GetSplineGridCellRange(
+						fminf(points[i].x, points[j].x), fmaxf(points[i].x, points[j].x),
+						fminf(points[i].z, points[j].z), fmaxf(points[i].z, points[j].z),
+						&colMin, &colMax, &rowMin, &rowMax);
+
+				for (int row = rowMin; row <= rowMax; row++)
+				{
+					for (int col = colMin; col <= colMax; col++)
+					{
+						int cell = row * SPLINE_GRID_WIDTH + col;
+						if (lastSplineInCell[cell] == s + 1)
+							continue;
+						lastSplineInCell[cell] = s + 1;
+
+						if (pass == 0)
+							gSplineGridCellStart[cell + 1]++;
+						else
+							gSplineGridEntries[gSplineGridCellStart[cell]++] = s;
+					}
+				}
+			}
+		}
+
+		if (pass == 0)											// turn counts into start indices
+		{
+			for (int cell = 0; cell < numCells; cell++)
+				gSplineGridCellStart[cell + 1] += gSplineGridCellStart[cell];
+
+			gSplineGridEntries = (uint16_t*) AllocPtr((gSplineGridCellStart[numCells] + 1) * sizeof(uint16_t));
+			GAME_ASSERT(gSplineGridEntries);
+		}
+		else													// filling in advanced each start to the next cell's start, so shift back
+		{
+			for (int cell = numCells; cell > 0; cell--)
+				gSplineGridCellStart[cell] = gSplineGridCellStart[cell - 1];
+			gSplineGridCellStart[0] = 0;
+		}
+	}
+
+	DisposePtr((Ptr) lastSplineInCell);
+}
+
+
+/******************** DISPOSE SPLINE SUPERTILE GRID ***********************/
+
+void DisposeSplineSupertileGrid(void)
+{
+	if (gSplineGridCellStart)
+	{
+		DisposePtr((Ptr) gSplineGridCellStart);
+		gSplineGridCellStart = nil;
+	}
+
+	if (gSplineGridEntries)
+	{
+		DisposePtr((Ptr) gSplineGridEntries);
+		gSplineGridEntries = nil;
+	}
+
+	if (gSplineAwake)
+	{
+		DisposePtr((Ptr) gSplineAwake);
+		gSplineAwake = nil;
+	}
+}
+
+
+/******************** WAKE SPLINES NEAR ACTIVE SUPERTILES ***********************/
+//
+// Marks every spline that passes through a supertile that's in the scroll buffer.
+// Only the window around gCurrentSuperTileRow/Col can be in use, plus a row/col
+// of slack on each side in case the terrain scrolled in between.
+//
+
+static void WakeSplinesNearActiveSupertiles(void)
+{
+	memset(gSplineAwake, 0, gNumSplines * sizeof(Boolean));
+
+	long rowMin = gCurrentSuperTileRow - 1;
+	long rowMax = gCurrentSuperTileRow + SUPERTILE_DIST_DEEP;
+	long colMin = gCurrentSuperTileCol - 1;
+	long colMax = gCurrentSuperTileCol + SUPERTILE_DIST_WIDE;
+
+	if (rowMin < 0) rowMin = 0;
+	if (colMin < 0) colMin = 0;
+	if (rowMax >= SPLINE_GRID_DEPTH) rowMax = SPLINE_GRID_DEPTH - 1;
+	if (colMax >= SPLINE_GRID_WIDTH) colMax = SPLINE_GRID_WIDTH - 1;
+
+	for (long row = rowMin; row <= rowMax; row++)
+	{
+		for (long col = colMin; col <= colMax; col++)
+		{
+			if (gTerrainScrollBuffer[row][col] == EMPTY_SUPERTILE)
+				continue;
+
+			int cell = row * SPLINE_GRID_WIDTH + col;
+			for (int i = gSplineGridCellStart[cell]; i < gSplineGridCellStart[cell + 1]; i++)
+				gSplineAwake[gSplineGridEntries[i]] = true;
+		}
+	}
+}
+
+
+/******************** CHECK DORMANT SPLINE OBJECT ***********************/
+//
+// --check-collision-grid: a dormant object must be somewhere IsSplineItemVisible would say is invisible.
+//
+
+static void CheckDormantSplineObject(ObjNode *theNode)
+{
+float	x,z;
+
+	GetObjectCoordOnSpline(theNode, &x, &z);
+
+	long row = z * (1.0f/TERRAIN_SUPERTILE_UNIT_SIZE);
+	long col = x * (1.0f/TERRAIN_SUPERTILE_UNIT_SIZE);
+
+	if (gTerrainScrollBuffer[row][col] != EMPTY_SUPERTILE)
+		DoFatalAlert("Dormant spline object on active supertile %ld,%ld (spline %d)", row, col, theNode->SplineNum);
+}
+
+
 
 /*********************** GET COORD ON SPLINE **********************/
 
@@ -274,6 +476,20 @@ void AddToSplineObjectList(ObjNode *theNode)
 }
 
 
+/******************* SET SPLINE OBJECT DORMANT SPEED ***************************/
+//
+// Optional, for spline objects whose move routine does nothing but IncreaseSplineIndex(speed)
+// and GetObjectCoordOnSpline while they're invisible.  When its spline doesn't touch any
+// active supertile, MoveSplineObjects just advances such an object along the spline
+// instead of calling its SplineMoveCall.
+//
+
+void SetSplineObjectDormantSpeed(ObjNode *theNode, float speed)
+{
+	theNode->SplineDormantSpeed = speed;
+}
+
+
 /****************** REMOVE FROM SPLINE OBJECT LIST **********************/
 //
 // OUTPUT:  true = the obj was on a spline and it was removed from it
@@ -290,6 +506,7 @@ Boolean RemoveFromSplineObjectList(ObjNode *theNode)
 		theNode->SplineObjectIndex = -1;
 		theNode->SplineItemPtr = nil;
 		theNode->SplineMoveCall = nil;
+		theNode->SplineDormantSpeed = 0;
 		return(true);
 	}
 	else
@@ -326,16 +543,44 @@ void MoveSplineObjects(void)
 {
 long	i;
 ObjNode	*theNode;
+Boolean	useGrid = gSplineGridCellStart != nil;
+
+	if (useGrid)
+		WakeSplinesNearActiveSupertiles();
 
 	for (i = 0; i < gNumSplineObjects; i++)
 	{
 		theNode = gSplineObjectList[i];
 		if (theNode)
 		{
-			if (theNode->SplineMoveCall)
-				theNode->SplineMoveCall(theNode);				// call object's spline move routine
+			if (!theNode->SplineMoveCall)
+				continue;
+
+					/* SEE IF IT CAN STAY DORMANT */
+					//
+					// Its spline doesn't touch any active supertile, so it was invisible
+					// last frame and will be again: just keep its placement going.
+					//
+
+			if (useGrid && theNode->SplineDormantSpeed != 0.0f && (theNode->StatusBits & STATUS_BIT_DETACHED))
+			{
+				if (!gSplineAwake[theNode->SplineNum])
+				{
+					if (gCommandLine.checkCollisionGrid)
+						CheckDormantSplineObject(theNode);
+
+					IncreaseSplineIndex(theNode, theNode->SplineDormantSpeed);
+					continue;
+				}
+
+				GetObjectCoordOnSpline(theNode, &theNode->Coord.x, &theNode->Coord.z);	// catch up Coord for IsSplineItemVisible
+			}
+
+			theNode->SplineMoveCall(theNode);				// call object's spline move routine
 		}
 	}
+
+	UpdateShadows();
 }
 
 
@@ -12,6 +12,36 @@
 #include "game.h"
 #include <stdio.h>
 
+#include "simd4.h"
+
+
+/****************************/
+/*  TYPES                  */
+/****************************/
+
+typedef struct
+{
+	float			ambientR,ambientG,ambientB;
+	float			fillR[2],fillG[2],fillB[2];
+	TQ3Vector3D		fillDir[2];
+	Byte			numFillLights;
+} SuperTileLightingType;									// snapshot of the lights, so supertiles can be lit off the main thread
+
+typedef struct
+{
+	TQ3Point3D		workGrid[SUPERTILE_SIZE+1][SUPERTILE_SIZE+1];
+	TQ3Vector3D		faceNormal[NUM_TRIS_IN_SUPERTILE];
+	uint16_t		*textureBuffer;							// full 160x160 (or 224x224) buffer that tiles are drawn into
+	uint32_t		numTilesDrawn;							// texture assembly stats for the last supertile
+	Uint64			assemblyTicks;
+} SuperTileScratchType;										// each thread that builds supertiles has its own
+
+typedef struct
+{
+	int32_t					superTileNum;
+	SuperTileLightingType	lighting;
+} SuperTileJobType;
+
 
 /****************************/
 /*  PROTOTYPES             */
@@ -25,11 +55,39 @@ static short GetFreeSuperTileMemory(void);
 static inline void ReleaseSuperTileObject(int32_t superTileNum);
 static void CalcNewItemDeleteWindow(void);
 static short	BuildTerrainSuperTile(long	startCol, long startRow);
+static void GetSuperTileLighting(SuperTileLightingType *lighting);
+static void CookSuperTile(SuperTileMemoryType *superTilePtr, const SuperTileLightingType *lighting, SuperTileScratchType *scratch);
+static void CookSuperTileGeometry(long startCol, long startRow, int layer, const SuperTileLightingType *lighting,
+								SuperTileScratchType *scratch, TQ3TriMeshData *triMeshData,
+								Byte splitModes[SUPERTILE_SIZE][SUPERTILE_SIZE], float *outMinY, float *outMaxY);
+static void SetSuperTileTriangles(int layer, const Byte splitModes[SUPERTILE_SIZE][SUPERTILE_SIZE], TQ3TriMeshTriangleData *triangleList);
+static Boolean ApplyBakedSuperTile(long startCol, long startRow, int layer, TQ3TriMeshData *triMeshData, float *outMinY, float *outMaxY);
+static uint64_t HashBakedTerrainSource(void);
+static Boolean ReadBakedTerrain(const FSSpec *cacheSpec, uint64_t sourceHash);
+static void BakeTerrain(const FSSpec *cacheSpec, uint64_t sourceHash);
+static void DisposeBakedTerrain(void);
+static void CalcTerrainTilePlane(long layer, int row, int col, int triangle, TQ3PlaneEquation *planeEq);
+static void UploadSuperTile(SuperTileMemoryType *superTilePtr);
+static void UploadSuperTileTexture(SuperTileMemoryType *superTilePtr, int layer, int lod);
+static void CreateSuperTileAtlas(int numLayers);
+static void DisposeSuperTileAtlas(void);
+static void StartSuperTileBuilder(void);
+static void DisposeSuperTileBuilder(void);
+static int SDLCALL SuperTileBuilderThread(void *unused);
+static void WaitForSuperTileBuilder(void);
+static int32_t ClaimPrefetchedSuperTile(long tileCol, long tileRow);
+static void PrefetchSuperTiles(long x, long y);
 static Boolean IsSuperTileVisible(int32_t superTileNum, Byte layer);
 static void DrawTileIntoMipmap(uint16_t tile, int row, int col, uint16_t* buffer);
+static void OrientTile(const uint16_t *tileData, uint16_t flipRotBits, uint16_t *buffer, int bufWidth);
 static void	ShrinkSuperTileTextureMap(const u_short *srcPtr,u_short *destPtr);
 //static void	ShrinkSuperTileTextureMapTo64(u_short *srcPtr,u_short *destPtr);
 static void ShrinkHalf(const uint16_t* input, uint16_t* output, int outputSize);
+static void ShrinkHalf_Scalar(const uint16_t* input, uint16_t* output, int inputWidth, int outputWidth, int numCols, int numRows);
+#if _DEBUG
+static void CheckShrinkHalf(void);
+#endif
+static int GetNumEagerLODs(void);
 static inline void ReleaseAllSuperTiles(void);
 static void BuildSuperTileLOD(SuperTileMemoryType *superTilePtr, short lod);
 
@@ -137,8 +195,97 @@ static const	Byte			gTileTriangleWinding[2][3] =
 
 
 
-TQ3Point3D		gWorkGrid[SUPERTILE_SIZE+1][SUPERTILE_SIZE+1];
-uint16_t		*gTempTextureBuffer = nil;
+static SuperTileScratchType	gMainThreadScratch;
+static SuperTileScratchType	gBuilderThreadScratch;
+
+			/* SUPERTILE BUILDER THREAD */
+
+static Boolean			gSuperTileBuilderRunning = false;
+static SDL_mutex		*gSuperTileJobMutex = nil;
+static SDL_cond			*gSuperTileJobQueuedCond = nil;
+static SDL_cond			*gSuperTileJobDoneCond = nil;
+static SuperTileJobType	gSuperTileJobQueue[MAX_SUPERTILES];			// ring buffer
+static int				gSuperTileJobQueueHead = 0;
+static int				gNumQueuedSuperTileJobs = 0;				// waiting to be picked up by the thread
+static int				gNumPendingSuperTileJobs = 0;				// queued + currently being built
+
+static long				gPrefetchPrevX = 0, gPrefetchPrevY = 0;
+static int				gPrefetchDirX = 0, gPrefetchDirY = 0;		// last way the scroll window moved on each axis (-1/0/+1)
+static long				gPrefetchRow = -1, gPrefetchCol = -1;		// leading row & column of supertiles (-1: none)
+
+			/* SUPERTILE TEXTURE ATLAS */
+			//
+			// All supertiles share one big texture per LOD, with a fixed cell for each supertile layer,
+			// so that the whole terrain is drawn without switching textures.
+			//
+
+static Boolean			gSuperTileAtlasActive = false;
+static GLuint			gSuperTileAtlasTextures[MAX_LODS];
+static int				gSuperTileAtlasCols = 0;
+static int				gSuperTileAtlasWidth = 0;					// LOD 0 dimensions
+static int				gSuperTileAtlasHeight = 0;
+static int				gSuperTileAtlasGutter = 0;					// LOD 0 border around each cell (edge pixels repeated to mimic GL_CLAMP_TO_EDGE)
+static uint16_t			*gSuperTileAtlasUploadBuffer = nil;			// cell + gutter, main thread only
+
+			/* TILE TEXTURE CACHE */
+			//
+			// Every tile image used by the level's maps, pre-flipped & pre-rotated at load time,
+			// so that supertile textures can be assembled with plain row copies.
+			//
+
+#define	TILE_CACHE_VARIANTS		16											// one per combination of flip & rotate bits
+#define	TILE_CACHE_PIXELS		(OREOMAP_TILE_SIZE * OREOMAP_TILE_SIZE)
+
+static int32_t			*gTileCacheIndex = nil;						// [texMapNum * TILE_CACHE_VARIANTS + variant] -> image # or -1
+static uint16_t			*gTileCachePixels = nil;
+static int				gTileCacheNumImages = 0;
+static Uint64			gTileCacheBuildTicks = 0;
+static Uint64			gTileCacheOrientTicks = 0;					// time spent flipping/rotating while building the cache
+static uint32_t			gTileCacheTilesDrawn = 0;					// guarded by gSuperTileJobMutex
+static Uint64			gTileCacheAssemblyTicks = 0;				// guarded by gSuperTileJobMutex
+
+			/* BAKED TERRAIN CACHE */
+			//
+			// Lit supertile geometry for the whole level plus the tile texture cache,
+			// saved to the prefs folder so that later runs can skip cooking (--bake-terrain).
+			//
+
+#define	BAKED_TERRAIN_MAGIC		'BTer'
+#define	BAKED_TERRAIN_VERSION	1
+
+typedef struct
+{
+	uint32_t		magic;
+	uint32_t		version;
+	uint32_t		endianCheck;									// 0x01020304 as written by the machine that baked it
+	uint32_t		recordSize;										// sizeof(BakedSuperTileType), catches layout changes
+	uint64_t		sourceHash;										// hash of everything the bake was derived from
+	int32_t			numSuperTilesWide, numSuperTilesDeep;
+	int32_t			numLayers;
+	int32_t			numTileCacheKeys;
+	int32_t			numTileCacheImages;
+	uint32_t		orientNanosPerImage;							// for the debug overlay's time-saved estimate
+} BakedTerrainHeader;
+
+typedef struct
+{
+	TQ3Point3D		points[NUM_VERTICES_IN_SUPERTILE];
+	TQ3Vector3D		normals[NUM_VERTICES_IN_SUPERTILE];
+	TQ3ColorRGB		colors[NUM_VERTICES_IN_SUPERTILE];
+	float			minY, maxY;
+	Byte			splitModes[SUPERTILE_SIZE][SUPERTILE_SIZE];
+} BakedSuperTileType;
+
+static Ptr						gBakedTerrainData = nil;		// file contents after the header
+static const BakedSuperTileType	*gBakedSuperTiles = nil;		// [layer][superRow][superCol], points into gBakedTerrainData
+
+			/* TERRAIN PLANE CACHE */
+			//
+			// The plane equations of both triangles of every tile, so height queries
+			// don't have to rebuild them from the corner heights each time.
+			//
+
+static TQ3PlaneEquation	*gTerrainPlanes[MAX_LAYERS] = {nil, nil};	// [(row * gTerrainTileWidth + col) * 2 + triangle]
 
 TQ3Vector3D		gRecentTerrainNormal[2];							// from _Planar
 
@@ -159,13 +306,22 @@ void InitTerrainManager(void)
 			// This is the full 160x160 buffer that tiles are drawn into.
 			//
 			
-	if (gTempTextureBuffer == nil)
+	if (gMainThreadScratch.textureBuffer == nil)
 	{
-		gTempTextureBuffer = (uint16_t*) AllocPtr(SUPERTILE_TEXSIZE_MAX * SUPERTILE_TEXSIZE_MAX * sizeof(uint16_t));
-		GAME_ASSERT(gTempTextureBuffer);
+		gMainThreadScratch.textureBuffer = (uint16_t*) AllocPtr(SUPERTILE_TEXSIZE_MAX * SUPERTILE_TEXSIZE_MAX * sizeof(uint16_t));
+		GAME_ASSERT(gMainThreadScratch.textureBuffer);
 	}
 
 
+			/* START SUPERTILE BUILDER THREAD */
+
+	StartSuperTileBuilder();
+
+#if _DEBUG
+	CheckShrinkHalf();
+#endif
+
+
 			/* INIT RENDER MODIFIERS */
 
 	Render_SetDefaultModifiers(&gTerrainRenderMods);
@@ -215,6 +371,12 @@ void DisposeTerrain(void)
 {
 int	i;
 
+	WaitForSuperTileBuilder();								// builder thread may still be reading the map
+
+	DisposeTileTextureCache();
+	DisposeBakedTerrain();
+	DisposeTerrainPlaneCache();
+
 	if (gTileDataHandle)
 	{
 		DisposeHandle((Handle)gTileDataHandle);
@@ -281,6 +443,8 @@ int	i;
 		gSplineList = nil;										// make sure to clear handle to prevent double-free next time
 	}
 
+	DisposeSplineSupertileGrid();
+
 			/* NUKE FENCE DATA */
 
 	if (gFenceList)
@@ -313,6 +477,9 @@ static	TQ3Param2D				uvs[NUM_VERTICES_IN_SUPERTILE];
 
 	gSupertileBudget = gSuperTileActiveRange * gSuperTileActiveRange * 4;		// calc # supertiles we will need
 
+	if (gSuperTileBuilderRunning)
+		gSupertileBudget += SUPERTILE_PREFETCH_SLOTS;							// room for the edges built ahead of scrolling
+
 	long upperBound = gNumSuperTilesDeep * gNumSuperTilesWide;					// if we have the budget to show the entire map at once,
 	if (gSupertileBudget > upperBound)											// cap supertile budget to # of supertiles in map
 		gSupertileBudget = upperBound;
@@ -416,6 +583,11 @@ retryParseLODPref:
 	}
 #endif
 
+			/* TRY TO FIT ALL SUPERTILE TEXTURES IN AN ATLAS */
+
+	CreateSuperTileAtlas(numLayers);
+
+
 			/********************************************/
 			/* FOR EACH POSSIBLE SUPERTILE ALLOC MEMORY */
 			/********************************************/
@@ -435,6 +607,10 @@ retryParseLODPref:
 
 		for (int layer = 0; layer < numLayers; layer++)							// do it for floor & ceiling trimeshes
 		{
+			int atlasCell = i * numLayers + layer;								// fixed spot in the atlas
+			superTile->atlasCol[layer] = atlasCell % gSuperTileAtlasCols;
+			superTile->atlasRow[layer] = atlasCell / gSuperTileAtlasCols;
+
 				/*****************************/
 				/* DO OUR OWN FAUX-LOD THING */
 				/*****************************/
@@ -453,6 +629,12 @@ retryParseLODPref:
 				superTile->textureData[layer][lod] = (uint16_t*) NewPtrClear(size * size * sizeof(uint16_t));	// alloc memory for texture
 				GAME_ASSERT(superTile->textureData[layer][lod]);
 
+				if (gSuperTileAtlasActive)
+				{
+					superTile->glTextureName[layer][lod] = gSuperTileAtlasTextures[lod];
+					continue;
+				}
+
 				superTile->glTextureName[layer][lod] = Render_LoadTexture(		// create texture from buffer
 						TILE_TEXTURE_INTERNAL_FORMAT,
 						size,
@@ -480,6 +662,19 @@ retryParseLODPref:
 			memcpy(tmd->triangles,		newTriangle,	sizeof(tmd->triangles[0]) * NUM_TRIS_IN_SUPERTILE);
 			memcpy(tmd->vertexUVs,		uvs,			sizeof(tmd->vertexUVs[0]) * NUM_VERTICES_IN_SUPERTILE);
 
+			if (gSuperTileAtlasActive)											// remap UVs into this supertile's atlas cell
+			{
+				int		cellSize = gTextureSizePerLOD[0] + 2 * gSuperTileAtlasGutter;
+				float	x0 = superTile->atlasCol[layer] * cellSize + gSuperTileAtlasGutter;
+				float	y0 = superTile->atlasRow[layer] * cellSize + gSuperTileAtlasGutter;
+
+				for (int k = 0; k < NUM_VERTICES_IN_SUPERTILE; k++)
+				{
+					tmd->vertexUVs[k].u = (x0 + uvs[k].u * gTextureSizePerLOD[0]) / gSuperTileAtlasWidth;
+					tmd->vertexUVs[k].v = (y0 + uvs[k].v * gTextureSizePerLOD[0]) / gSuperTileAtlasHeight;
+				}
+			}
+
 			tmd->bBox.isEmpty = kQ3False;										// calc bounding box
 			tmd->bBox.min.x = tmd->bBox.min.y = tmd->bBox.min.z = 0;
 			tmd->bBox.max.x = tmd->bBox.max.y = tmd->bBox.max.z = TERRAIN_SUPERTILE_UNIT_SIZE;
@@ -488,6 +683,8 @@ retryParseLODPref:
 			tmd->texturingMode = kQ3TexturingModeOpaque;
 
 			gSuperTileMemoryList[i].triMeshDataPtrs[layer] = tmd;
+
+			Render_UploadStaticMesh(tmd);										// allocate GPU buffers up front
 		}
 	}
 
@@ -504,6 +701,8 @@ int		numLayers;
 	if (gSuperTileMemoryListExists == false)
 		return;
 
+	WaitForSuperTileBuilder();
+
 	if (gDoCeiling)
 		numLayers = 2;
 	else
@@ -530,20 +729,23 @@ int		numLayers;
 				superTile->textureData[layer][lod] = nil;
 				superTile->hasLOD[lod] = false;
 
-				if (superTile->glTextureName[layer][lod])
+				if (superTile->glTextureName[layer][lod] && !gSuperTileAtlasActive)	// atlas textures are shared, nuked below
 				{
 					glDeleteTextures(1, &superTile->glTextureName[layer][lod]);
-					superTile->glTextureName[layer][lod] = 0;
 				}
+				superTile->glTextureName[layer][lod] = 0;
 			}
 
 				/* NUKE TRIMESH DATA */
 
+			Render_ReleaseStaticMesh(gSuperTileMemoryList[i].triMeshDataPtrs[layer]);
 			Q3TriMeshData_Dispose(gSuperTileMemoryList[i].triMeshDataPtrs[layer]);
 			gSuperTileMemoryList[i].triMeshDataPtrs[layer] = nil;
 		}
 	}
-	
+
+	DisposeSuperTileAtlas();
+
 	gSuperTileMemoryListExists = false;
 }
 
@@ -571,6 +773,19 @@ static short GetFreeSuperTileMemory(void)
 		}
 	}
 
+				/* NONE FREE, SO RECYCLE A SUPERTILE THAT WAS PREFETCHED FOR NOTHING */
+
+	WaitForSuperTileBuilder();
+
+	for (int32_t i = 0; i < gSupertileBudget; i++)
+	{
+		if (gSuperTileMemoryList[i].mode == SUPERTILE_MODE_PREFETCHED)
+		{
+			gSuperTileMemoryList[i].mode = SUPERTILE_MODE_USED;			// prefetched ones weren't counted as free
+			return(i);
+		}
+	}
+
 	DoFatalAlert("No Free Supertiles!");
 	return(-1);											// ERROR, NO FREE BLOCKS!!!! SHOULD NEVER GET HERE!
 }
@@ -580,7 +795,8 @@ static short GetFreeSuperTileMemory(void)
 
 /******************* BUILD TERRAIN SUPERTILE *******************/
 //
-// Builds a new supertile which has scrolled on
+// Builds a new supertile which has scrolled on.
+// If the builder thread already made it, we only have to upload it.
 //
 // INPUT: startCol = starting column in map
 //		  startRow = starting row in map
@@ -590,42 +806,108 @@ static short GetFreeSuperTileMemory(void)
 
 static short	BuildTerrainSuperTile(long	startCol, long startRow)
 {
-long	 			row,col,row2,col2;
 int32_t				superTileNum;
-float				height,miny,maxy;
-TQ3TriMeshData		*triMeshData;
-TQ3Vector3D			*vertexNormalList;
-u_short				tile;
-TQ3Point3D			*pointList;
-TQ3TriMeshTriangleData	*triangleList;
 SuperTileMemoryType	*superTilePtr;
-TQ3ColorRGBA		*vertexColorList;
-float				brightness;
-float				ambientR,ambientG,ambientB;
-float				fillR0,fillG0,fillB0;
-float				fillR1,fillG1,fillB1;
-TQ3Vector3D			*fillDir0,*fillDir1;
-Byte				numFillLights, numLayers;
+SuperTileLightingType	lighting;
 
-static TQ3Vector3D	faceNormal[NUM_TRIS_IN_SUPERTILE];
-
-	if (gDoCeiling)
-		numLayers = 2;
+	superTileNum = ClaimPrefetchedSuperTile(startCol, startRow);
+	if (superTileNum >= 0)
+	{
+		superTilePtr = &gSuperTileMemoryList[superTileNum];
+	}
 	else
-		numLayers = 1;
+	{
+		superTileNum = GetFreeSuperTileMemory();					// get memory block for the data
+		superTilePtr = &gSuperTileMemoryList[superTileNum];			// get ptr to it
+
+		superTilePtr->tileCol = startCol;
+		superTilePtr->tileRow = startRow;
 
+		GetSuperTileLighting(&lighting);
+		CookSuperTile(superTilePtr, &lighting, &gMainThreadScratch);
 
-	superTileNum = GetFreeSuperTileMemory();					// get memory block for the data
-	superTilePtr = &gSuperTileMemoryList[superTileNum];			// get ptr to it
+		if (gSuperTileBuilderRunning)
+			SDL_LockMutex(gSuperTileJobMutex);
+		gTileCacheTilesDrawn += gMainThreadScratch.numTilesDrawn;
+		gTileCacheAssemblyTicks += gMainThreadScratch.assemblyTicks;
+		if (gSuperTileBuilderRunning)
+			SDL_UnlockMutex(gSuperTileJobMutex);
+	}
 
 	if (gDisableHiccupTimer)
 		superTilePtr->hiccupTimer = 0;
 	else
 		superTilePtr->hiccupTimer = (gHiccupEliminator++ & 0x3) + 1;	// set hiccup timer to aleiviate hiccup caused by massive texture uploading
 
+	UploadSuperTile(superTilePtr);
+
+	return(superTileNum);
+}
+
+
+/******************* GET SUPERTILE LIGHTING *******************/
+
+static void GetSuperTileLighting(SuperTileLightingType *lighting)
+{
+float	brightness;
+
+	brightness = gGameViewInfoPtr->lightList.ambientBrightness;					// get ambient brightness
+	lighting->ambientR = gGameViewInfoPtr->lightList.ambientColor.r * brightness;	// calc ambient color
+	lighting->ambientG = gGameViewInfoPtr->lightList.ambientColor.g * brightness;
+	lighting->ambientB = gGameViewInfoPtr->lightList.ambientColor.b * brightness;
+
+	lighting->numFillLights = gGameViewInfoPtr->lightList.numFillLights;
+
+	for (int i = 0; i < 2; i++)
+	{
+		if (i < lighting->numFillLights)
+		{
+			brightness = gGameViewInfoPtr->lightList.fillBrightness[i];				// get fill brightness
+			lighting->fillR[i] = gGameViewInfoPtr->lightList.fillColor[i].r * brightness;
+			lighting->fillG[i] = gGameViewInfoPtr->lightList.fillColor[i].g * brightness;
+			lighting->fillB[i] = gGameViewInfoPtr->lightList.fillColor[i].b * brightness;
+			lighting->fillDir[i] = gGameViewInfoPtr->lightList.fillDirection[i];	// get fill direction
+		}
+		else
+		{
+			lighting->fillR[i] = lighting->fillG[i] = lighting->fillB[i] = 0;
+			lighting->fillDir[i] = (TQ3Vector3D) {0, 0, 0};
+		}
+	}
+}
+
+
+/******************* COOK SUPERTILE *******************/
+//
+// Generates the geometry, vertex colors and LOD 0 pixels of a supertile
+// at superTilePtr->tileCol/tileRow.
+//
+// Doesn't touch OpenGL or any mutable global state, so the builder thread can call this.
+// Each thread must pass in its own scratch buffers.
+//
+
+static void CookSuperTile(SuperTileMemoryType *superTilePtr, const SuperTileLightingType *lighting, SuperTileScratchType *scratch)
+{
+long	 			row,col,row2,col2;
+float				miny,maxy;
+TQ3TriMeshData		*triMeshData;
+u_short				tile;
+Byte				numLayers;
+uint16_t			*textureBuffer = scratch->textureBuffer;
+const long			startCol = superTilePtr->tileCol;
+const long			startRow = superTilePtr->tileRow;
+
+	if (gDoCeiling)
+		numLayers = 2;
+	else
+		numLayers = 1;
+
 	for (int lod = 0; lod < MAX_LODS; lod++)
 		superTilePtr->hasLOD[lod] = false;						// LOD isnt built yet
 
+	scratch->numTilesDrawn = 0;
+	scratch->assemblyTicks = 0;
+
 	for (int layer = 0; layer < MAX_LAYERS; layer++)
 	{
 		superTilePtr->coord[layer] = (TQ3Point3D)				// also remember world coords
@@ -640,36 +922,6 @@ static TQ3Vector3D	faceNormal[NUM_TRIS_IN_SUPERTILE];
 	superTilePtr->back = (startRow * TERRAIN_POLYGON_SIZE);
 
 
-		/* GET LIGHT DATA */
-
-	brightness = gGameViewInfoPtr->lightList.ambientBrightness;				// get ambient brightness
-	ambientR = gGameViewInfoPtr->lightList.ambientColor.r * brightness;		// calc ambient color
-	ambientG = gGameViewInfoPtr->lightList.ambientColor.g * brightness;		
-	ambientB = gGameViewInfoPtr->lightList.ambientColor.b * brightness;
-
-	brightness = gGameViewInfoPtr->lightList.fillBrightness[0];				// get fill brightness 0
-	fillR0 = gGameViewInfoPtr->lightList.fillColor[0].r * brightness;		// calc ambient color
-	fillG0 = gGameViewInfoPtr->lightList.fillColor[0].g * brightness;		
-	fillB0 = gGameViewInfoPtr->lightList.fillColor[0].b * brightness;		
-	fillDir0 = &gGameViewInfoPtr->lightList.fillDirection[0];		// get fill direction
-
-	numFillLights = gGameViewInfoPtr->lightList.numFillLights;
-	if (numFillLights > 1)
-	{
-		brightness = gGameViewInfoPtr->lightList.fillBrightness[1];			// get fill brightness 1
-		fillR1 = gGameViewInfoPtr->lightList.fillColor[1].r * brightness;	// calc ambient color
-		fillG1 = gGameViewInfoPtr->lightList.fillColor[1].g * brightness;		
-		fillB1 = gGameViewInfoPtr->lightList.fillColor[1].b * brightness;		
-		fillDir1 = &gGameViewInfoPtr->lightList.fillDirection[1];
-	}
-	else
-	{
-		fillR1 = 0;
-		fillG1 = 0;
-		fillB1 = 0;
-		fillDir1 = nil;
-	}
-
 		/***********************************************************/
 		/*                DO FLOOR & CEILING LAYERS                */
 		/***********************************************************/
@@ -680,241 +932,22 @@ static TQ3Vector3D	faceNormal[NUM_TRIS_IN_SUPERTILE];
 					/* GET THE TRIMESH */
 					/*******************/
 					
-		triMeshData = gSuperTileMemoryList[superTileNum].triMeshDataPtrs[layer];	// get ptr to triMesh data
-		pointList = triMeshData->points;									// get ptr to point/vertex list
-		triangleList = triMeshData->triangles;								// get ptr to triangle index list
-		vertexColorList = triMeshData->vertexColors;						// get ptr to vertex color
-		vertexNormalList = triMeshData->vertexNormals;						// get ptr to vertex normals
-
-		miny = 1000000;														// init bbox counters
-		maxy = -miny;
-				
-	
-				/**********************************/
-				/* CREATE VERTICES FOR THIS LAYER */
-				/**********************************/
-	
-		for (row2 = 0; row2 <= SUPERTILE_SIZE; row2++)
-		{
-			row = row2 + startRow;
-			
-			for (col2 = 0; col2 <= SUPERTILE_SIZE; col2++)
-			{
-				col = col2 + startCol;
-				
-				if ((row >= gTerrainTileDepth) || (col >= gTerrainTileWidth)) // check for edge vertices (off map array)
-					height = 0;
-				else
-					height = gMapYCoords[row][col].layerY[layer];			// get pixel height here
-	
-				gWorkGrid[row2][col2].x = (col*TERRAIN_POLYGON_SIZE);
-				gWorkGrid[row2][col2].z = (row*TERRAIN_POLYGON_SIZE);
-				gWorkGrid[row2][col2].y = height;							// save height @ this tile's upper left corner
-					
-				
-				if (height > maxy)											// keep track of min/max
-					maxy = height;
-				if (height < miny)
-					miny = height;			
-			}
-		}	
-	
-				/*********************************/
-				/* CREATE TERRAIN MESH POLYGONS  */
-				/*********************************/
-
-		int i;
-						/* SET VERTEX COORDS */
-
-		i = 0;			
-		for (row = 0; row < (SUPERTILE_SIZE+1); row++)
-		{
-			for (col = 0; col < (SUPERTILE_SIZE+1); col++)
-				pointList[i++] = gWorkGrid[row][col];						// copy from other list
-		}
-	
-					/* UPDATE TRIMESH DATA WITH NEW INFO */
-#if _DEBUG
-		memset(gTempTextureBuffer, 0xFF, SUPERTILE_TEXSIZE_MAX * SUPERTILE_TEXSIZE_MAX * sizeof(uint16_t));
-#endif
+		triMeshData = superTilePtr->triMeshDataPtrs[layer];					// get ptr to triMesh data
 
-		i = 0;
-		for (row2 = 0; row2 < SUPERTILE_SIZE; row2++)
-		{
-			row = row2 + startRow;
-	
-			for (col2 = 0; col2 < SUPERTILE_SIZE; col2++)
-			{
-	
-				col = col2 + startCol;
-	
-						/* SET SPLITTING INFO */
-
-				const Byte* tri1;
-				const Byte* tri2;
-
-				if (gMapInfoMatrix[row][col].splitMode[layer] == SPLIT_BACKWARD)	// set coords & uv's based on splitting
-				{
-						/* \ */
-					tri1 = gTileTriangles1_B[row2][col2];
-					tri2 = gTileTriangles2_B[row2][col2];
-				}
-				else
-				{
-						/* / */
-					tri1 = gTileTriangles1_A[row2][col2];
-					tri2 = gTileTriangles2_A[row2][col2];
-				}
-
-				triangleList[i].pointIndices[0] 	= tri1[gTileTriangleWinding[layer][0]];
-				triangleList[i].pointIndices[1] 	= tri1[gTileTriangleWinding[layer][1]];
-				triangleList[i++].pointIndices[2] 	= tri1[gTileTriangleWinding[layer][2]];
-				triangleList[i].pointIndices[0] 	= tri2[gTileTriangleWinding[layer][0]];
-				triangleList[i].pointIndices[1] 	= tri2[gTileTriangleWinding[layer][1]];
-				triangleList[i++].pointIndices[2] 	= tri2[gTileTriangleWinding[layer][2]];
-			}
-		}
-
-							/* CALC FACE NORMALS */
-						
-		for (i = 0; i < NUM_TRIS_IN_SUPERTILE; i++)
-		{
-			CalcFaceNormal( &pointList[triangleList[i].pointIndices[0]],
-							&pointList[triangleList[i].pointIndices[1]],
-							&pointList[triangleList[i].pointIndices[2]],
-							&faceNormal[i]);
-		}
-
-				/******************************/
-				/* CALCULATE VERTEX NORMALS   */
-				/******************************/
-	
-		i = 0;
-		for (row = 0; row <= SUPERTILE_SIZE; row++)
-		{
-			for (col = 0; col <= (SUPERTILE_SIZE*2); col += 2)
-			{
-				TQ3Vector3D	*n1,*n2;
-				float		avX,avY,avZ;
-				TQ3Vector3D	nA,nB;
-				long		ro,co;
-				
-				/* SCAN 4 TILES AROUND THIS TILE TO CALC AVERAGE NORMAL FOR THIS VERTEX */
-				//
-				// We use the face normal already calculated for triangles inside the supertile,
-				// but for tiles/tris outside the supertile (on the borders), we need to calculate
-				// the face normals there.
-				//
-				
-				avX = avY = avZ = 0;									// init the normal	
-				
-				for (ro = -1; ro <= 0; ro++)
-				{
-					for (co = -2; co <= 0; co+=2)
-					{
-						long	cc = col + co;
-						long	rr = row + ro;
-						
-						if ((cc >= 0) && (cc < (SUPERTILE_SIZE*2)) && (rr >= 0) && (rr < SUPERTILE_SIZE)) // see if this vertex is in supertile bounds							 
-						{					
-							n1 = &faceNormal[rr * (SUPERTILE_SIZE*2) + cc];					// average 2 triangles...
-							n2 = n1+1;
-							avX += n1->x + n2->x;											// ...and average with current average
-							avY += n1->y + n2->y;
-							avZ += n1->z + n2->z;
-						}
-						else																// tile is out of supertile, so calc face normal & average
-						{
-							CalcTileNormals(layer, rr+startRow, (cc>>1)+startCol, &nA,&nB);	// calculate the 2 face normals for this tile
-							avX += nA.x + nB.x;												// average with current average
-							avY += nA.y + nB.y;
-							avZ += nA.z + nB.z;
-						}
-					}
-				}
-				FastNormalizeVector(avX, avY, avZ, &vertexNormalList[i++]);					// normalize the vertex normal	
-			}
-		}
-		
-		if (vertexColorList)
+		if (!ApplyBakedSuperTile(startCol, startRow, layer, triMeshData, &miny, &maxy))	// use baked geometry if we have it
 		{
-				/*****************************/
-				/* CALCULATE VERTEX COLORS   */
-				/*****************************/
-					
-			i = 0;
-			for (row = 0; row <= SUPERTILE_SIZE; row++)
-			{
-				for (col = 0; col <= SUPERTILE_SIZE; col++)
-				{
-					u_short	color = gVertexColors[layer][row+startRow][col+startCol];
-					float	r,g,b,dot;
-					float	lr,lg,lb;
-					
-							/* GET VERTEX DIFFUSE COLOR */
-							
-					r = (float)(color>>11) * (1.0f/32.0f);
-					g = (float)((color>>5) & 0x3f) * (1.0f/64.0f);
-					b = (float)(color&0x1f) * (1.0f/32.0f);
-	
-							/* APPLY LIGHTING TO THE VERTEX */
-					
-					lr = ambientR;												// factor in the ambient
-					lg = ambientG;
-					lb = ambientB;
-					
-					dot = vertexNormalList[i].x * fillDir0->x;					// calc dot product of fill #0
-					dot += vertexNormalList[i].y * fillDir0->y;
-					dot += vertexNormalList[i].z * fillDir0->z;
-					dot = -dot;
-	
-					if (dot > 0.0f)
-					{					
-						lr += fillR0 * dot;
-						lg += fillG0 * dot;
-						lb += fillB0 * dot;					
-					}
-	
-					if (numFillLights > 1)
-					{
-						dot = vertexNormalList[i].x * fillDir1->x;				// calc dot product of fill #1
-						dot += vertexNormalList[i].y * fillDir1->y;
-						dot += vertexNormalList[i].z * fillDir1->z;
-						dot = -dot;
-						
-						if (dot > 0.0f)
-						{					
-							lr += fillR1 * dot;
-							lg += fillG1 * dot;
-							lb += fillB1 * dot;					
-						}
-					}
-					
-					r *= lr;													// apply final lighting to diffuse color
-					if (r > 1.0f)
-						r = 1.0f;
-					g *= lg;
-					if (g > 1.0f)
-						g = 1.0f;
-					b *= lb;
-					if (b > 1.0f)
-						b = 1.0f;
-										
-	
-							/* SAVE COLOR INTO LIST */
-							
-					vertexColorList[i].r = r;
-					vertexColorList[i].g = g;
-					vertexColorList[i].b = b;
-					i++;
-				}
-			}
+			Byte splitModes[SUPERTILE_SIZE][SUPERTILE_SIZE];
+			CookSuperTileGeometry(startCol, startRow, layer, lighting, scratch, triMeshData, splitModes, &miny, &maxy);
 		}
 
 					/********************/
 					/* ASSEMBLE TEXTURE */
 					/********************/
 
+#if _DEBUG
+		memset(textureBuffer, 0xFF, SUPERTILE_TEXSIZE_MAX * SUPERTILE_TEXSIZE_MAX * sizeof(uint16_t));
+#endif
+
 		int textureMinRow = 0;
 		int textureMinCol = 0;
 		int textureMaxRow = textureMinRow + SUPERTILE_SIZE;
@@ -928,6 +961,8 @@ static TQ3Vector3D	faceNormal[NUM_TRIS_IN_SUPERTILE];
 			textureMaxCol++;
 		}
 
+		Uint64 assemblyStart = SDL_GetPerformanceCounter();
+
 		for (row2 = textureMinRow; row2 < textureMaxRow; row2++)
 		{
 			row = row2 + startRow;
@@ -954,15 +989,18 @@ static TQ3Vector3D	faceNormal[NUM_TRIS_IN_SUPERTILE];
 
 				if (gTerrainTextureDetail == SUPERTILE_DETAIL_SEAMLESS)
 				{
-					DrawTileIntoMipmap(tile, row2+1, col2+1, gTempTextureBuffer);		// draw into mipmap
+					DrawTileIntoMipmap(tile, row2+1, col2+1, textureBuffer);		// draw into mipmap
 				}
 				else
 				{
-					DrawTileIntoMipmap(tile, row2, col2, gTempTextureBuffer);		// draw into mipmap
+					DrawTileIntoMipmap(tile, row2, col2, textureBuffer);		// draw into mipmap
 				}
+				scratch->numTilesDrawn++;
 			}
 		}
 
+		scratch->assemblyTicks += SDL_GetPerformanceCounter() - assemblyStart;
+
 				/************************/
 				/* UPDATE TEXTURE LOD 0 */
 				/************************/
@@ -970,32 +1008,22 @@ static TQ3Vector3D	faceNormal[NUM_TRIS_IN_SUPERTILE];
 				// If we are in low-memory mode, then we shrink the texture to LOD #1 instead of LOD #0 and we shrink it to 64x64
 				//
 
+		if (gTerrainTextureDetail == SUPERTILE_DETAIL_LOSSLESS
+				|| gTerrainTextureDetail == SUPERTILE_DETAIL_SEAMLESS)
 		{
-			if (gTerrainTextureDetail == SUPERTILE_DETAIL_LOSSLESS
-					|| gTerrainTextureDetail == SUPERTILE_DETAIL_SEAMLESS)
-			{
-				memcpy(superTilePtr->textureData[layer][0], gTempTextureBuffer, sizeof(gTempTextureBuffer[0]) * gTextureSizePerLOD[0] * gTextureSizePerLOD[0]);
-			}
-			else
-			{
-				ShrinkSuperTileTextureMap(gTempTextureBuffer, superTilePtr->textureData[layer][0]);				// shrink to 128x128
-			}
-
-			superTilePtr->hasLOD[0] = true;
-
-			Render_UpdateTexture(
-					superTilePtr->glTextureName[layer][0],
-					0,
-					0,
-					gTextureSizePerLOD[0],
-					gTextureSizePerLOD[0],
-					TILE_TEXTURE_FORMAT,
-					TILE_TEXTURE_TYPE,
-					superTilePtr->textureData[layer][0],
-					0);
+			memcpy(superTilePtr->textureData[layer][0], textureBuffer, sizeof(textureBuffer[0]) * gTextureSizePerLOD[0] * gTextureSizePerLOD[0]);
+		}
+		else
+		{
+			ShrinkSuperTileTextureMap(textureBuffer, superTilePtr->textureData[layer][0]);				// shrink to 128x128
 		}
 
+				/* BUILD OTHER LODS NOW IF WE DON'T WANT TO DO IT IN DRAWTERRAIN */
 
+		for (int lod = 1; lod < GetNumEagerLODs(); lod++)
+		{
+			ShrinkHalf(superTilePtr->textureData[layer][lod-1], superTilePtr->textureData[layer][lod], gTextureSizePerLOD[lod]);
+		}
 
 
 				/**********************/
@@ -1004,11 +1032,11 @@ static TQ3Vector3D	faceNormal[NUM_TRIS_IN_SUPERTILE];
 	
 				/* SET BOUNDING BOX */
 				
-		triMeshData->bBox.min.x = gWorkGrid[0][0].x;
+		triMeshData->bBox.min.x = startCol * TERRAIN_POLYGON_SIZE;
 		triMeshData->bBox.max.x = triMeshData->bBox.min.x+TERRAIN_SUPERTILE_UNIT_SIZE;
 		triMeshData->bBox.min.y = miny;
 		triMeshData->bBox.max.y = maxy;
-		triMeshData->bBox.min.z = gWorkGrid[0][0].z;
+		triMeshData->bBox.min.z = startRow * TERRAIN_POLYGON_SIZE;
 		triMeshData->bBox.max.z = triMeshData->bBox.min.z + TERRAIN_SUPERTILE_UNIT_SIZE;
 
 
@@ -1025,23 +1053,341 @@ static TQ3Vector3D	faceNormal[NUM_TRIS_IN_SUPERTILE];
 		superTilePtr->radius[layer] = 0.5f * Q3Point3D_Distance(&triMeshData->bBox.min, &triMeshData->bBox.max);
 
 	}	// j (layer)
-									
-	return(superTileNum);
 }
 
 
-
-/********************** BUILD SUPERTILE LEVEL OF DETAIL ********************/
+/******************* COOK SUPERTILE GEOMETRY *******************/
 //
-// Called from DrawTerrain to generate the LOD's from the source LOD=0 geometry
+// Generates the points, triangles, vertex normals & lit vertex colors of one layer of a supertile.
+// Thread-safe, like CookSuperTile.
 //
 
-static void BuildSuperTileLOD(SuperTileMemoryType *superTilePtr, short lod)
+static void CookSuperTileGeometry(long startCol, long startRow, int layer, const SuperTileLightingType *lighting,
+								SuperTileScratchType *scratch, TQ3TriMeshData *triMeshData,
+								Byte splitModes[SUPERTILE_SIZE][SUPERTILE_SIZE], float *outMinY, float *outMaxY)
 {
-	if (superTilePtr->hasLOD[lod])									// see if already has LOD
-		return;
+long	 			row,col,row2,col2;
+float				height,miny,maxy;
+TQ3Vector3D			*vertexNormalList;
+TQ3Point3D			*pointList;
+TQ3TriMeshTriangleData	*triangleList;
+TQ3ColorRGBA		*vertexColorList;
+float				ambientR,ambientG,ambientB;
+float				fillR0,fillG0,fillB0;
+float				fillR1,fillG1,fillB1;
+const TQ3Vector3D	*fillDir0,*fillDir1;
+Byte				numFillLights;
+TQ3Point3D			(*workGrid)[SUPERTILE_SIZE+1] = scratch->workGrid;
+TQ3Vector3D			*faceNormal = scratch->faceNormal;
 
-	GAME_ASSERT_MESSAGE(lod != 0, "Cannot use BuildSuperTileLOD for LOD 0!");
+	pointList = triMeshData->points;										// get ptr to point/vertex list
+	triangleList = triMeshData->triangles;									// get ptr to triangle index list
+	vertexColorList = triMeshData->vertexColors;							// get ptr to vertex color
+	vertexNormalList = triMeshData->vertexNormals;							// get ptr to vertex normals
+
+		/* GET LIGHT DATA */
+
+	ambientR = lighting->ambientR;
+	ambientG = lighting->ambientG;
+	ambientB = lighting->ambientB;
+
+	fillR0 = lighting->fillR[0];
+	fillG0 = lighting->fillG[0];
+	fillB0 = lighting->fillB[0];
+	fillDir0 = &lighting->fillDir[0];
+
+	numFillLights = lighting->numFillLights;
+	fillR1 = lighting->fillR[1];
+	fillG1 = lighting->fillG[1];
+	fillB1 = lighting->fillB[1];
+	fillDir1 = &lighting->fillDir[1];
+
+	miny = 1000000;														// init bbox counters
+	maxy = -miny;
+			
+
+			/**********************************/
+			/* CREATE VERTICES FOR THIS LAYER */
+			/**********************************/
+
+	for (row2 = 0; row2 <= SUPERTILE_SIZE; row2++)
+	{
+		row = row2 + startRow;
+		
+		for (col2 = 0; col2 <= SUPERTILE_SIZE; col2++)
+		{
+			col = col2 + startCol;
+			
+			if ((row >= gTerrainTileDepth) || (col >= gTerrainTileWidth)) // check for edge vertices (off map array)
+				height = 0;
+			else
+				height = gMapYCoords[row][col].layerY[layer];			// get pixel height here
+
+			workGrid[row2][col2].x = (col*TERRAIN_POLYGON_SIZE);
+			workGrid[row2][col2].z = (row*TERRAIN_POLYGON_SIZE);
+			workGrid[row2][col2].y = height;							// save height @ this tile's upper left corner
+				
+			
+			if (height > maxy)											// keep track of min/max
+				maxy = height;
+			if (height < miny)
+				miny = height;			
+		}
+	}	
+
+			/*********************************/
+			/* CREATE TERRAIN MESH POLYGONS  */
+			/*********************************/
+
+	int i;
+					/* SET VERTEX COORDS */
+
+	i = 0;			
+	for (row = 0; row < (SUPERTILE_SIZE+1); row++)
+	{
+		for (col = 0; col < (SUPERTILE_SIZE+1); col++)
+			pointList[i++] = workGrid[row][col];						// copy from other list
+	}
+
+				/* UPDATE TRIMESH DATA WITH NEW INFO */
+
+	for (row2 = 0; row2 < SUPERTILE_SIZE; row2++)
+	{
+		for (col2 = 0; col2 < SUPERTILE_SIZE; col2++)
+			splitModes[row2][col2] = gMapInfoMatrix[row2 + startRow][col2 + startCol].splitMode[layer];
+	}
+
+	SetSuperTileTriangles(layer, splitModes, triangleList);
+
+						/* CALC FACE NORMALS */
+					
+	for (i = 0; i < NUM_TRIS_IN_SUPERTILE; i++)
+	{
+		CalcFaceNormal( &pointList[triangleList[i].pointIndices[0]],
+						&pointList[triangleList[i].pointIndices[1]],
+						&pointList[triangleList[i].pointIndices[2]],
+						&faceNormal[i]);
+	}
+
+			/******************************/
+			/* CALCULATE VERTEX NORMALS   */
+			/******************************/
+
+	i = 0;
+	for (row = 0; row <= SUPERTILE_SIZE; row++)
+	{
+		for (col = 0; col <= (SUPERTILE_SIZE*2); col += 2)
+		{
+			TQ3Vector3D	*n1,*n2;
+			float		avX,avY,avZ;
+			TQ3Vector3D	nA,nB;
+			long		ro,co;
+			
+			/* SCAN 4 TILES AROUND THIS TILE TO CALC AVERAGE NORMAL FOR THIS VERTEX */
+			//
+			// We use the face normal already calculated for triangles inside the supertile,
+			// but for tiles/tris outside the supertile (on the borders), we need to calculate
+			// the face normals there.
+			//
+			
+			avX = avY = avZ = 0;									// init the normal	
+			
+			for (ro = -1; ro <= 0; ro++)
+			{
+				for (co = -2; co <= 0; co+=2)
+				{
+					long	cc = col + co;
+					long	rr = row + ro;
+					
+					if ((cc >= 0) && (cc < (SUPERTILE_SIZE*2)) && (rr >= 0) && (rr < SUPERTILE_SIZE)) // see if this vertex is in supertile bounds							 
+					{					
+						n1 = &faceNormal[rr * (SUPERTILE_SIZE*2) + cc];					// average 2 triangles...
+						n2 = n1+1;
+						avX += n1->x + n2->x;											// ...and average with current average
+						avY += n1->y + n2->y;
+						avZ += n1->z + n2->z;
+					}
+					else																// tile is out of supertile, so calc face normal & average
+					{
+						CalcTileNormals(layer, rr+startRow, (cc>>1)+startCol, &nA,&nB);	// calculate the 2 face normals for this tile
+						avX += nA.x + nB.x;												// average with current average
+						avY += nA.y + nB.y;
+						avZ += nA.z + nB.z;
+					}
+				}
+			}
+			FastNormalizeVector(avX, avY, avZ, &vertexNormalList[i++]);					// normalize the vertex normal	
+		}
+	}
+	
+	if (vertexColorList)
+	{
+			/*****************************/
+			/* CALCULATE VERTEX COLORS   */
+			/*****************************/
+				
+		i = 0;
+		for (row = 0; row <= SUPERTILE_SIZE; row++)
+		{
+			for (col = 0; col <= SUPERTILE_SIZE; col++)
+			{
+				u_short	color = gVertexColors[layer][row+startRow][col+startCol];
+				float	r,g,b,dot;
+				float	lr,lg,lb;
+				
+						/* GET VERTEX DIFFUSE COLOR */
+						
+				r = (float)(color>>11) * (1.0f/32.0f);
+				g = (float)((color>>5) & 0x3f) * (1.0f/64.0f);
+				b = (float)(color&0x1f) * (1.0f/32.0f);
+
+						/* APPLY LIGHTING TO THE VERTEX */
+				
+				lr = ambientR;												// factor in the ambient
+				lg = ambientG;
+				lb = ambientB;
+				
+				dot = vertexNormalList[i].x * fillDir0->x;					// calc dot product of fill #0
+				dot += vertexNormalList[i].y * fillDir0->y;
+				dot += vertexNormalList[i].z * fillDir0->z;
+				dot = -dot;
+
+				if (dot > 0.0f)
+				{					
+					lr += fillR0 * dot;
+					lg += fillG0 * dot;
+					lb += fillB0 * dot;					
+				}
+
+				if (numFillLights > 1)
+				{
+					dot = vertexNormalList[i].x * fillDir1->x;				// calc dot product of fill #1
+					dot += vertexNormalList[i].y * fillDir1->y;
+					dot += vertexNormalList[i].z * fillDir1->z;
+					dot = -dot;
+					
+					if (dot > 0.0f)
+					{					
+						lr += fillR1 * dot;
+						lg += fillG1 * dot;
+						lb += fillB1 * dot;					
+					}
+				}
+				
+				r *= lr;													// apply final lighting to diffuse color
+				if (r > 1.0f)
+					r = 1.0f;
+				g *= lg;
+				if (g > 1.0f)
+					g = 1.0f;
+				b *= lb;
+				if (b > 1.0f)
+					b = 1.0f;
+									
+
+						/* SAVE COLOR INTO LIST */
+						
+				vertexColorList[i].r = r;
+				vertexColorList[i].g = g;
+				vertexColorList[i].b = b;
+				i++;
+			}
+		}
+	}
+
+	*outMinY = miny;
+	*outMaxY = maxy;
+}
+
+
+/******************* SET SUPERTILE TRIANGLES *******************/
+//
+// Fills in the triangle index list of one layer of a supertile from the split mode of each of its tiles.
+//
+
+static void SetSuperTileTriangles(int layer, const Byte splitModes[SUPERTILE_SIZE][SUPERTILE_SIZE], TQ3TriMeshTriangleData *triangleList)
+{
+	int i = 0;
+
+	for (int row2 = 0; row2 < SUPERTILE_SIZE; row2++)
+	{
+		for (int col2 = 0; col2 < SUPERTILE_SIZE; col2++)
+		{
+					/* SET SPLITTING INFO */
+
+			const Byte* tri1;
+			const Byte* tri2;
+
+			if (splitModes[row2][col2] == SPLIT_BACKWARD)					// set coords & uv's based on splitting
+			{
+					/* \ */
+				tri1 = gTileTriangles1_B[row2][col2];
+				tri2 = gTileTriangles2_B[row2][col2];
+			}
+			else
+			{
+					/* / */
+				tri1 = gTileTriangles1_A[row2][col2];
+				tri2 = gTileTriangles2_A[row2][col2];
+			}
+
+			triangleList[i].pointIndices[0] 	= tri1[gTileTriangleWinding[layer][0]];
+			triangleList[i].pointIndices[1] 	= tri1[gTileTriangleWinding[layer][1]];
+			triangleList[i++].pointIndices[2] 	= tri1[gTileTriangleWinding[layer][2]];
+			triangleList[i].pointIndices[0] 	= tri2[gTileTriangleWinding[layer][0]];
+			triangleList[i].pointIndices[1] 	= tri2[gTileTriangleWinding[layer][1]];
+			triangleList[i++].pointIndices[2] 	= tri2[gTileTriangleWinding[layer][2]];
+		}
+	}
+}
+
+
+/******************* UPLOAD SUPERTILE *******************/
+//
+// Main thread only. Hands a freshly cooked supertile over to OpenGL.
+//
+
+static void UploadSuperTile(SuperTileMemoryType *superTilePtr)
+{
+	int numLayers = gDoCeiling ? 2 : 1;
+
+	for (int layer = 0; layer < numLayers; layer++)
+	{
+		Render_InvalidateStaticMesh(superTilePtr->triMeshDataPtrs[layer]);	// geometry was rewritten
+
+		for (int lod = 0; lod < GetNumEagerLODs(); lod++)
+			UploadSuperTileTexture(superTilePtr, layer, lod);
+	}
+
+	for (int lod = 0; lod < GetNumEagerLODs(); lod++)
+		superTilePtr->hasLOD[lod] = true;
+}
+
+
+/******************* GET NUM EAGER LODS *******************/
+//
+// How many LODs CookSuperTile builds up front.
+// The rest are built by DrawTerrain when they're first needed.
+//
+
+static int GetNumEagerLODs(void)
+{
+	return gCommandLine.eagerTerrainLODs ? gNumLODs : 1;
+}
+
+
+
+/********************** BUILD SUPERTILE LEVEL OF DETAIL ********************/
+//
+// Called from DrawTerrain to generate the LOD's from the source LOD=0 geometry
+//
+
+static void BuildSuperTileLOD(SuperTileMemoryType *superTilePtr, short lod)
+{
+	if (superTilePtr->hasLOD[lod])									// see if already has LOD
+		return;
+
+	GAME_ASSERT_MESSAGE(lod != 0, "Cannot use BuildSuperTileLOD for LOD 0!");
 
 	if (lod >= gNumLODs)
 		DoFatalAlert("BuildSuperTileLOD: lod overflow");
@@ -1067,17 +1413,191 @@ static void BuildSuperTileLOD(SuperTileMemoryType *superTilePtr, short lod)
 
 			/* UPDATE THE TEXTURE */
 
+		UploadSuperTileTexture(superTilePtr, j, lod);
+	}
+}
+
+
+/********************** UPLOAD SUPERTILE TEXTURE ********************/
+//
+// Sends the pixels of one layer & LOD of a supertile to its own texture or to its atlas cell.
+//
+
+static void UploadSuperTileTexture(SuperTileMemoryType *superTilePtr, int layer, int lod)
+{
+	const int		size = gTextureSizePerLOD[lod];
+	const uint16_t*	pixels = superTilePtr->textureData[layer][lod];
+
+	if (!gSuperTileAtlasActive)
+	{
 		Render_UpdateTexture(
-				superTilePtr->glTextureName[j][lod],
+				superTilePtr->glTextureName[layer][lod],
 				0,
 				0,
-				gTextureSizePerLOD[lod],
-				gTextureSizePerLOD[lod],
+				size,
+				size,
 				TILE_TEXTURE_FORMAT,
 				TILE_TEXTURE_TYPE,
-				newBuffer,
+				pixels,
 				0);
+		return;
+	}
+
+	const int gutter = gSuperTileAtlasGutter >> lod;
+	const int cellSize = size + 2 * gutter;
+
+			/* SURROUND WITH COPIES OF THE EDGE PIXELS */
+			//
+			// This keeps bilinear filtering from bleeding in neighboring cells.
+			// (Not needed for the seamless detail level, which has its own border.)
+			//
+
+	if (gutter > 0)
+	{
+		uint16_t* dst = gSuperTileAtlasUploadBuffer;
+
+		for (int y = 0; y < cellSize; y++)
+		{
+			int srcY = y - gutter;
+			if (srcY < 0)
+				srcY = 0;
+			else if (srcY >= size)
+				srcY = size - 1;
+
+			const uint16_t* srcRow = pixels + srcY * size;
+
+			for (int x = 0; x < gutter; x++)
+			{
+				dst[x] = srcRow[0];
+				dst[gutter + size + x] = srcRow[size - 1];
+			}
+			memcpy(dst + gutter, srcRow, size * sizeof(uint16_t));
+
+			dst += cellSize;
+		}
+
+		pixels = gSuperTileAtlasUploadBuffer;
+	}
+
+	Render_UpdateTexture(
+			gSuperTileAtlasTextures[lod],
+			superTilePtr->atlasCol[layer] * cellSize,
+			superTilePtr->atlasRow[layer] * cellSize,
+			cellSize,
+			cellSize,
+			TILE_TEXTURE_FORMAT,
+			TILE_TEXTURE_TYPE,
+			pixels,
+			0);
+}
+
+
+/********************** CREATE SUPERTILE ATLAS ********************/
+//
+// Lays out one cell per supertile layer in a near-square grid and creates the atlas textures for each LOD.
+// If the atlas would be too big for the GPU, each supertile gets its own textures instead.
+//
+
+static void CreateSuperTileAtlas(int numLayers)
+{
+	gSuperTileAtlasActive = false;
+	gSuperTileAtlasCols = 1;
+
+	const int numCells = gSupertileBudget * numLayers;
+
+			/* CALC CELL SIZE */
+			//
+			// The gutter halves along with each LOD, so a cell's UVs are the same at every LOD.
+			//
+
+	if (gTerrainTextureDetail == SUPERTILE_DETAIL_SEAMLESS)
+		gSuperTileAtlasGutter = 0;
+	else
+		gSuperTileAtlasGutter = 1 << (gNumLODs - 1);
+
+	const int cellSize = gTextureSizePerLOD[0] + 2 * gSuperTileAtlasGutter;
+
+			/* CALC ATLAS DIMENSIONS */
+
+	int cols = 1;
+	while (cols * cols < numCells)
+		cols++;
+	int rows = (numCells + cols - 1) / cols;
+
+	int width = cols * cellSize;
+	int height = rows * cellSize;
+
+#if OSXPPC
+	// No NPOT texture support (see SUPERTILE_DETAIL_BEST)
+	int potWidth = 1, potHeight = 1;
+	while (potWidth < width)	potWidth <<= 1;
+	while (potHeight < height)	potHeight <<= 1;
+	width = potWidth;
+	height = potHeight;
+#endif
+
+	GLint maxTextureSize = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+	if (width > maxTextureSize || height > maxTextureSize)
+	{
+		printf("Supertile atlas %dx%d too big (max %d), using separate textures\n", width, height, maxTextureSize);
+		return;
+	}
+
+			/* CREATE A TEXTURE PER LOD */
+
+	for (int lod = 0; lod < gNumLODs; lod++)
+	{
+		gSuperTileAtlasTextures[lod] = Render_LoadTexture(
+				TILE_TEXTURE_INTERNAL_FORMAT,
+				width >> lod,
+				height >> lod,
+				TILE_TEXTURE_FORMAT,
+				TILE_TEXTURE_TYPE,
+				nil,													// cells get filled in as supertiles are built
+				kRendererTextureFlags_ClampBoth
+		);
+		CHECK_GL_ERROR();
+		GAME_ASSERT(gSuperTileAtlasTextures[lod]);
+	}
+
+	gSuperTileAtlasUploadBuffer = (uint16_t*) AllocPtr(cellSize * cellSize * sizeof(uint16_t));
+	GAME_ASSERT(gSuperTileAtlasUploadBuffer);
+
+	gSuperTileAtlasCols = cols;
+	gSuperTileAtlasWidth = width;
+	gSuperTileAtlasHeight = height;
+	gSuperTileAtlasActive = true;
+
+#if _DEBUG
+	printf("Supertile atlas: %dx%d, %d cells of %d\n", width, height, numCells, cellSize);
+#endif
+}
+
+
+/********************** DISPOSE SUPERTILE ATLAS ********************/
+
+static void DisposeSuperTileAtlas(void)
+{
+	if (!gSuperTileAtlasActive)
+		return;
+
+	for (int lod = 0; lod < gNumLODs; lod++)
+	{
+		if (gSuperTileAtlasTextures[lod])
+		{
+			glDeleteTextures(1, &gSuperTileAtlasTextures[lod]);
+			gSuperTileAtlasTextures[lod] = 0;
+		}
 	}
+
+	if (gSuperTileAtlasUploadBuffer)
+	{
+		DisposePtr((Ptr) gSuperTileAtlasUploadBuffer);
+		gSuperTileAtlasUploadBuffer = nil;
+	}
+
+	gSuperTileAtlasActive = false;
 }
 
 
@@ -1116,8 +1636,39 @@ const int bufWidth
 	const int startY = row * tileSize;
 
 	buffer += (startY * bufWidth) + startX;						// get dest
+
+			/* USE PRE-ORIENTED IMAGE IF IT'S CACHED */
+
+	if (gTileCacheIndex)
+	{
+		int32_t cacheImage = gTileCacheIndex[texMapNum * TILE_CACHE_VARIANTS + (flipRotBits >> 12)];
+		if (cacheImage >= 0)
+		{
+			tileData = gTileCachePixels + cacheImage * TILE_CACHE_PIXELS;
+			for (int y = 0; y < tileSize; y++)
+			{
+				memcpy(buffer, tileData, tileSize * sizeof(uint16_t));
+				buffer += bufWidth;								// next line in dest
+				tileData += tileSize;							// next line in src
+			}
+			return;
+		}
+	}
+
 	tileData = (*gTileDataHandle) + (texMapNum * tileSize*tileSize);	// get src
 
+	OrientTile(tileData, flipRotBits, buffer, bufWidth);
+}
+
+
+/********************* ORIENT TILE *************************/
+//
+// Copies a tile image into a buffer, flipped & rotated according to flipRotBits.
+//
+
+static void OrientTile(const uint16_t *tileData, uint16_t flipRotBits, uint16_t *buffer, int bufWidth)
+{
+const int tileSize = OREOMAP_TILE_SIZE;
 
 	switch(flipRotBits)         								// set uv's based on flip & rot bits
 	{
@@ -1208,186 +1759,1195 @@ const int bufWidth
 					for (int x = 0; x < tileSize; x++)
 						buffer[bufWidth*(tileSize-1-x)] = tileData[x];		// backwards
 
-					buffer++;								// next col in dest
-					tileData += tileSize;					// next line in src
-				}
-				break;
+					buffer++;								// next col in dest
+					tileData += tileSize;					// next line in src
+				}
+				break;
+
+				/* FLIP X ROT 1 */
+				/* FLIP Y ROT 3 */
+
+		case	TILE_FLIPX_MASK | TILE_ROT1:
+		case	TILE_FLIPY_MASK | TILE_ROT3:
+				buffer += (tileSize-1);
+				for (int y = 0; y < tileSize; y++)
+				{
+					for (int x = 0; x < tileSize; x++)
+						buffer[bufWidth*(tileSize-1-x)] = tileData[x];		// backwards
+
+					buffer--;								// prev col in dest
+					tileData += tileSize;					// next line in src
+				}
+				break;
+
+				/* FLIP X ROT 3 */
+				/* FLIP Y ROT 1 */
+
+		case	TILE_FLIPX_MASK | TILE_ROT3:
+		case	TILE_FLIPY_MASK | TILE_ROT1:
+				for (int y = 0; y < tileSize; y++)			// draw to right col from top row of src
+				{
+					for (int x = 0; x < tileSize; x++)
+						buffer[bufWidth*x] = tileData[x];
+
+					buffer++;								// next col in dest
+					tileData += tileSize;					// next line in src
+				}
+				break;
+	}
+}
+
+
+#pragma mark -
+
+/********************* BUILD TILE TEXTURE CACHE *************************/
+//
+// Called after the playfield is loaded.
+// Pre-orients every (tile, flip/rotate) combination that appears in the floor & ceiling maps.
+//
+
+void BuildTileTextureCache(void)
+{
+	DisposeTileTextureCache();
+
+	GAME_ASSERT(gTileDataHandle);
+
+	const Uint64 startTicks = SDL_GetPerformanceCounter();
+	const int numKeys = gNumTerrainTextureTiles * TILE_CACHE_VARIANTS;
+
+	gTileCacheIndex = (int32_t*) AllocPtr(numKeys * sizeof(int32_t));
+	GAME_ASSERT(gTileCacheIndex);
+
+	for (int i = 0; i < numKeys; i++)
+		gTileCacheIndex[i] = -1;
+
+			/* FIND WHICH VARIANTS ARE USED */
+			//
+			// Tile 0 is always needed: it's drawn off the edges of the map.
+			//
+
+	gTileCacheNumImages = 0;
+	gTileCacheIndex[0] = gTileCacheNumImages++;
+
+	for (int layer = 0; layer < MAX_LAYERS; layer++)
+	{
+		u_short** map = (layer == 0) ? gFloorMap : gCeilingMap;
+		if (!map)
+			continue;
+
+		for (int row = 0; row < gTerrainTileDepth; row++)
+		{
+			for (int col = 0; col < gTerrainTileWidth; col++)
+			{
+				uint16_t tile = map[row][col];
+				uint16_t texMapNum = tile & TILENUM_MASK;
+				if (texMapNum >= gNumTerrainTextureTiles)				// illegal tile #s get drawn as tile 0
+					texMapNum = 0;
+
+				int key = texMapNum * TILE_CACHE_VARIANTS + ((tile & (TILE_FLIPXY_MASK|TILE_ROTATE_MASK)) >> 12);
+				if (gTileCacheIndex[key] < 0)
+					gTileCacheIndex[key] = gTileCacheNumImages++;
+			}
+		}
+	}
+
+			/* ORIENT THEM */
+
+	gTileCachePixels = (uint16_t*) AllocPtr(gTileCacheNumImages * TILE_CACHE_PIXELS * sizeof(uint16_t));
+	GAME_ASSERT(gTileCachePixels);
+
+	const Uint64 orientStartTicks = SDL_GetPerformanceCounter();
+
+	for (int key = 0; key < numKeys; key++)
+	{
+		int32_t image = gTileCacheIndex[key];
+		if (image < 0)
+			continue;
+
+		const uint16_t* tileData = (*gTileDataHandle) + (key / TILE_CACHE_VARIANTS) * TILE_CACHE_PIXELS;
+		uint16_t flipRotBits = (key % TILE_CACHE_VARIANTS) << 12;
+
+		OrientTile(tileData, flipRotBits, gTileCachePixels + image * TILE_CACHE_PIXELS, OREOMAP_TILE_SIZE);
+	}
+
+	const Uint64 endTicks = SDL_GetPerformanceCounter();
+
+	gTileCacheOrientTicks = endTicks - orientStartTicks;
+	gTileCacheBuildTicks = endTicks - startTicks;
+	gTileCacheTilesDrawn = 0;
+	gTileCacheAssemblyTicks = 0;
+
+#if _DEBUG
+	printf("Tile texture cache: %d images, %dK\n", gTileCacheNumImages, (int) (gTileCacheNumImages * TILE_CACHE_PIXELS * sizeof(uint16_t) / 1024));
+#endif
+}
+
+
+/********************* DISPOSE TILE TEXTURE CACHE *************************/
+
+void DisposeTileTextureCache(void)
+{
+	if (gTileCacheIndex)
+	{
+		DisposePtr((Ptr) gTileCacheIndex);
+		gTileCacheIndex = nil;
+	}
+
+	if (gTileCachePixels)
+	{
+		DisposePtr((Ptr) gTileCachePixels);
+		gTileCachePixels = nil;
+	}
+
+	gTileCacheNumImages = 0;
+}
+
+
+/********************* GET TILE TEXTURE CACHE STATS *************************/
+//
+// For the debug overlay.
+// The time saved is an estimate: what it would have cost to orient every tile drawn so far,
+// minus the time actually spent assembling supertile textures from the cache.
+//
+
+void GetTileTextureCacheStats(int *numImages, int *numKB, float *buildMS, float *savedMS)
+{
+	const double ticksToMS = 1000.0 / (double) SDL_GetPerformanceFrequency();
+
+	uint32_t tilesDrawn;
+	Uint64 assemblyTicks;
+
+	if (gSuperTileBuilderRunning)
+		SDL_LockMutex(gSuperTileJobMutex);
+	tilesDrawn = gTileCacheTilesDrawn;
+	assemblyTicks = gTileCacheAssemblyTicks;
+	if (gSuperTileBuilderRunning)
+		SDL_UnlockMutex(gSuperTileJobMutex);
+
+	*numImages = gTileCacheNumImages;
+	*numKB = (int) (gTileCacheNumImages * TILE_CACHE_PIXELS * sizeof(uint16_t) / 1024);
+	*buildMS = (float) (gTileCacheBuildTicks * ticksToMS);
+
+	if (gTileCacheNumImages == 0)
+	{
+		*savedMS = 0;
+		return;
+	}
+
+	double orientTicksPerTile = (double) gTileCacheOrientTicks / gTileCacheNumImages;
+	*savedMS = (float) ((tilesDrawn * orientTicksPerTile - (double) assemblyTicks) * ticksToMS - *buildMS);
+}
+
+
+#pragma mark -
+
+/********************* LOAD OR BAKE TERRAIN *************************/
+//
+// Called after the playfield is loaded, in place of BuildTileTextureCache.
+//
+// With --bake-terrain, the lit geometry of every supertile and the tile texture cache
+// are loaded from a cache file in the prefs folder. If the file is missing or was baked
+// from different source data, everything is cooked now and the file is rewritten.
+//
+
+void LoadOrBakeTerrain(const FSSpec *terrainSpec)
+{
+	DisposeBakedTerrain();
+
+	if (!gCommandLine.bakeTerrain)
+	{
+		BuildTileTextureCache();
+		return;
+	}
+
+	char cacheName[64];
+	snprintf(cacheName, sizeof(cacheName), "%s.baked", terrainSpec->cName);
+
+	FSSpec cacheSpec;
+	MakePrefsFSSpec(cacheName, true, &cacheSpec);
+
+	uint64_t sourceHash = HashBakedTerrainSource();
+
+	if (!ReadBakedTerrain(&cacheSpec, sourceHash))
+	{
+		BuildTileTextureCache();
+		BakeTerrain(&cacheSpec, sourceHash);
+	}
+}
+
+
+/********************* HASH BAKED TERRAIN SOURCE *************************/
+//
+// FNV-1a over everything that goes into a baked supertile or the tile texture cache:
+// map dimensions, tile images, tile maps, heights, vertex colors, split modes and lights.
+//
+
+static uint64_t HashBytes(uint64_t hash, const void *data, size_t size)
+{
+	const Byte *bytes = (const Byte *) data;
+
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 0x100000001b3ull;
+	}
+
+	return hash;
+}
+
+static uint64_t HashBakedTerrainSource(void)
+{
+uint64_t				hash = 0xcbf29ce484222325ull;
+int32_t					dims[4];
+SuperTileLightingType	lighting;
+
+	dims[0] = gTerrainTileWidth;
+	dims[1] = gTerrainTileDepth;
+	dims[2] = gNumTerrainTextureTiles;
+	dims[3] = gDoCeiling ? 2 : 1;
+	hash = HashBytes(hash, dims, sizeof(dims));
+
+	hash = HashBytes(hash, *gTileDataHandle, GetHandleSize((Handle) gTileDataHandle));
+
+	for (int layer = 0; layer < dims[3]; layer++)
+	{
+		u_short** map = (layer == 0) ? gFloorMap : gCeilingMap;
+
+		for (int row = 0; row < gTerrainTileDepth; row++)
+		{
+			hash = HashBytes(hash, map[row], gTerrainTileWidth * sizeof(map[0][0]));
+
+			for (int col = 0; col < gTerrainTileWidth; col++)
+				hash = HashBytes(hash, &gMapInfoMatrix[row][col].splitMode[layer], 1);
+		}
+
+		for (int row = 0; row <= gTerrainTileDepth; row++)
+		{
+			for (int col = 0; col <= gTerrainTileWidth; col++)
+				hash = HashBytes(hash, &gMapYCoords[row][col].layerY[layer], sizeof(float));
+
+			hash = HashBytes(hash, gVertexColors[layer][row], (gTerrainTileWidth+1) * sizeof(u_short));
+		}
+	}
+
+	SDL_memset(&lighting, 0, sizeof(lighting));				// zero the padding too
+	GetSuperTileLighting(&lighting);
+	hash = HashBytes(hash, &lighting, sizeof(lighting));
+
+	return hash;
+}
+
+
+/********************* READ BAKED TERRAIN *************************/
+//
+// Returns false if the cache file doesn't exist, is stale, or is corrupt.
+// On success, the tile texture cache is filled in from the file.
+// Nothing is installed until the whole file has been checked.
+//
+
+static Boolean ReadBakedTerrain(const FSSpec *cacheSpec, uint64_t sourceHash)
+{
+short				refNum;
+long				count;
+OSErr				iErr;
+BakedTerrainHeader	header;
+
+	const Uint64 startTicks = SDL_GetPerformanceCounter();
+
+	if (FSpOpenDF(cacheSpec, fsRdPerm, &refNum) != noErr)
+		return false;
+
+			/* READ & VALIDATE HEADER */
+
+	count = sizeof(header);
+	iErr = FSRead(refNum, &count, (Ptr) &header);
+
+	if (iErr != noErr
+		|| count != sizeof(header)
+		|| header.magic != BAKED_TERRAIN_MAGIC
+		|| header.version != BAKED_TERRAIN_VERSION
+		|| header.endianCheck != 0x01020304
+		|| header.recordSize != sizeof(BakedSuperTileType)
+		|| header.sourceHash != sourceHash
+		|| header.numSuperTilesWide != gNumSuperTilesWide
+		|| header.numSuperTilesDeep != gNumSuperTilesDeep
+		|| header.numLayers != (gDoCeiling ? 2 : 1)
+		|| header.numTileCacheKeys != gNumTerrainTextureTiles * TILE_CACHE_VARIANTS
+		|| header.numTileCacheImages <= 0
+		|| header.numTileCacheImages > header.numTileCacheKeys)		// at most one image per key
+	{
+		FSClose(refNum);
+		printf("Baked terrain cache %s is stale, rebaking\n", cacheSpec->cName);
+		return false;
+	}
+
+			/* READ THE REST */
+
+	const long indexSize = header.numTileCacheKeys * sizeof(int32_t);
+	const long pixelsSize = header.numTileCacheImages * TILE_CACHE_PIXELS * sizeof(uint16_t);
+	const long recordsSize = header.numLayers * gNumSuperTilesDeep * gNumSuperTilesWide * sizeof(BakedSuperTileType);
+	const long bodySize = indexSize + pixelsSize + recordsSize;
+
+	Ptr body = AllocPtr(bodySize);
+	GAME_ASSERT(body);
+
+	count = bodySize;
+	iErr = FSRead(refNum, &count, body);
+	FSClose(refNum);
+
+	if (iErr != noErr || count != bodySize)
+	{
+		DisposePtr(body);
+		printf("Baked terrain cache %s is truncated, rebaking\n", cacheSpec->cName);
+		return false;
+	}
+
+			/* DON'T TRUST THE FILE WITH OUT-OF-RANGE IMAGES */
+
+	const int32_t* fileIndex = (const int32_t*) body;
+
+	for (int i = 0; i < header.numTileCacheKeys; i++)
+	{
+		if (fileIndex[i] < -1
+			|| fileIndex[i] >= header.numTileCacheImages
+			|| (i == 0 && fileIndex[i] < 0))						// tile 0 is always cached
+		{
+			DisposePtr(body);
+			printf("Baked terrain cache %s is corrupt, rebaking\n", cacheSpec->cName);
+			return false;
+		}
+	}
+
+			/* INSTALL THE TILE TEXTURE CACHE */
+
+	DisposeTileTextureCache();
+
+	gTileCacheIndex = (int32_t*) AllocPtr(indexSize);
+	gTileCachePixels = (uint16_t*) AllocPtr(pixelsSize);
+	GAME_ASSERT(gTileCacheIndex);
+	GAME_ASSERT(gTileCachePixels);
+
+	memcpy(gTileCacheIndex, body, indexSize);
+	memcpy(gTileCachePixels, body + indexSize, pixelsSize);
+	gTileCacheNumImages = header.numTileCacheImages;
+
+	gTileCacheOrientTicks = (Uint64) ((double) header.orientNanosPerImage * gTileCacheNumImages * SDL_GetPerformanceFrequency() / 1e9);
+	gTileCacheBuildTicks = SDL_GetPerformanceCounter() - startTicks;
+	gTileCacheTilesDrawn = 0;
+	gTileCacheAssemblyTicks = 0;
+
+			/* KEEP THE SUPERTILES */
+
+	gBakedTerrainData = body;
+	gBakedSuperTiles = (const BakedSuperTileType*) (body + indexSize + pixelsSize);
+
+#if _DEBUG
+	printf("Baked terrain cache: loaded %s in %.1f ms\n", cacheSpec->cName, gTileCacheBuildTicks * 1000.0 / SDL_GetPerformanceFrequency());
+#endif
+
+	return true;
+}
+
+
+/********************* BAKE TERRAIN *************************/
+//
+// Cooks the geometry of every supertile in the level and writes it out
+// along with the tile texture cache (which must already be built).
+//
+
+static void BakeTerrain(const FSSpec *cacheSpec, uint64_t sourceHash)
+{
+BakedTerrainHeader		header;
+SuperTileLightingType	lighting;
+short					refNum;
+long					count;
+OSErr					iErr;
+
+	GAME_ASSERT(gTileCacheIndex);
+	GAME_ASSERT(gTileCachePixels);
+
+	const Uint64 startTicks = SDL_GetPerformanceCounter();
+
+	SDL_memset(&header, 0, sizeof(header));
+	header.magic				= BAKED_TERRAIN_MAGIC;
+	header.version				= BAKED_TERRAIN_VERSION;
+	header.endianCheck			= 0x01020304;
+	header.recordSize			= sizeof(BakedSuperTileType);
+	header.sourceHash			= sourceHash;
+	header.numSuperTilesWide	= gNumSuperTilesWide;
+	header.numSuperTilesDeep	= gNumSuperTilesDeep;
+	header.numLayers			= gDoCeiling ? 2 : 1;
+	header.numTileCacheKeys		= gNumTerrainTextureTiles * TILE_CACHE_VARIANTS;
+	header.numTileCacheImages	= gTileCacheNumImages;
+	header.orientNanosPerImage	= (uint32_t) (gTileCacheOrientTicks * 1e9 / SDL_GetPerformanceFrequency() / gTileCacheNumImages);
+
+	const long indexSize = header.numTileCacheKeys * sizeof(int32_t);
+	const long pixelsSize = header.numTileCacheImages * TILE_CACHE_PIXELS * sizeof(uint16_t);
+	const long recordsSize = header.numLayers * gNumSuperTilesDeep * gNumSuperTilesWide * sizeof(BakedSuperTileType);
+	const long bodySize = indexSize + pixelsSize + recordsSize;
+
+	Ptr body = AllocPtr(bodySize);
+	GAME_ASSERT(body);
+
+	memcpy(body, gTileCacheIndex, indexSize);
+	memcpy(body + indexSize, gTileCachePixels, pixelsSize);
+
+			/* COOK EVERY SUPERTILE */
+
+	BakedSuperTileType* records = (BakedSuperTileType*) (body + indexSize + pixelsSize);
+
+	TQ3TriMeshData* tmd = Q3TriMeshData_New(NUM_TRIS_IN_SUPERTILE, NUM_VERTICES_IN_SUPERTILE,
+											kQ3TriMeshDataFeatureVertexNormals | kQ3TriMeshDataFeatureVertexColors);
+	GAME_ASSERT(tmd);
+
+	SuperTileScratchType* scratch = (SuperTileScratchType*) AllocPtr(sizeof(SuperTileScratchType));	// no texture buffer needed
+	GAME_ASSERT(scratch);
+
+	SDL_memset(&lighting, 0, sizeof(lighting));
+	GetSuperTileLighting(&lighting);
+
+	for (int layer = 0; layer < header.numLayers; layer++)
+	{
+		for (int superRow = 0; superRow < gNumSuperTilesDeep; superRow++)
+		{
+			for (int superCol = 0; superCol < gNumSuperTilesWide; superCol++)
+			{
+				BakedSuperTileType* record = &records[(layer * gNumSuperTilesDeep + superRow) * gNumSuperTilesWide + superCol];
+
+				CookSuperTileGeometry(superCol * SUPERTILE_SIZE, superRow * SUPERTILE_SIZE, layer, &lighting, scratch, tmd,
+									record->splitModes, &record->minY, &record->maxY);
+
+				memcpy(record->points, tmd->points, sizeof(record->points));
+				memcpy(record->normals, tmd->vertexNormals, sizeof(record->normals));
+
+				for (int i = 0; i < NUM_VERTICES_IN_SUPERTILE; i++)
+				{
+					record->colors[i].r = tmd->vertexColors[i].r;
+					record->colors[i].g = tmd->vertexColors[i].g;
+					record->colors[i].b = tmd->vertexColors[i].b;
+				}
+			}
+		}
+	}
+
+	DisposePtr((Ptr) scratch);
+	Q3TriMeshData_Dispose(tmd);
+
+	gBakedTerrainData = body;
+	gBakedSuperTiles = records;
+
+			/* WRITE THE FILE */
+			//
+			// If this fails we just don't have a cache next time.
+			//
+
+	FSpDelete(cacheSpec);
+
+	iErr = FSpCreate(cacheSpec, 'BalZ', 'BTer', smSystemScript);
+	if (iErr == noErr)
+		iErr = FSpOpenDF(cacheSpec, fsRdWrPerm, &refNum);
+
+	if (iErr == noErr)
+	{
+		count = sizeof(header);
+		iErr = FSWrite(refNum, &count, (Ptr) &header);
+
+		if (iErr == noErr)
+		{
+			count = bodySize;
+			iErr = FSWrite(refNum, &count, body);
+		}
+
+		FSClose(refNum);
+	}
+
+	if (iErr != noErr)
+	{
+		printf("Couldn't write baked terrain cache %s (error %d)\n", cacheSpec->cName, iErr);
+		FSpDelete(cacheSpec);
+	}
+
+#if _DEBUG
+	printf("Baked terrain cache: baked %s in %.1f ms, %ldK\n", cacheSpec->cName,
+			(SDL_GetPerformanceCounter() - startTicks) * 1000.0 / SDL_GetPerformanceFrequency(),
+			(long) ((sizeof(header) + bodySize) / 1024));
+#else
+	(void) startTicks;
+#endif
+}
+
+
+/********************* APPLY BAKED SUPERTILE *************************/
+//
+// Fills in a supertile layer's points, normals, colors & triangles from the baked cache.
+// Returns false if there's no baked data for it, in which case the caller cooks it.
+// Safe to call from the builder thread: the baked data is read-only until DisposeTerrain.
+//
+
+static Boolean ApplyBakedSuperTile(long startCol, long startRow, int layer, TQ3TriMeshData *triMeshData, float *outMinY, float *outMaxY)
+{
+	if (!gBakedSuperTiles)
+		return false;
+
+	long superCol = startCol / SUPERTILE_SIZE;
+	long superRow = startRow / SUPERTILE_SIZE;
+
+	if (startCol < 0 || startRow < 0 || superCol >= gNumSuperTilesWide || superRow >= gNumSuperTilesDeep)
+		return false;
+
+	const BakedSuperTileType* record = &gBakedSuperTiles[(layer * gNumSuperTilesDeep + superRow) * gNumSuperTilesWide + superCol];
+
+	memcpy(triMeshData->points, record->points, sizeof(record->points));
+	memcpy(triMeshData->vertexNormals, record->normals, sizeof(record->normals));
+
+	for (int i = 0; i < NUM_VERTICES_IN_SUPERTILE; i++)
+	{
+		triMeshData->vertexColors[i].r = record->colors[i].r;
+		triMeshData->vertexColors[i].g = record->colors[i].g;
+		triMeshData->vertexColors[i].b = record->colors[i].b;
+	}
+
+	SetSuperTileTriangles(layer, record->splitModes, triMeshData->triangles);
+
+	*outMinY = record->minY;
+	*outMaxY = record->maxY;
+	return true;
+}
+
+
+/********************* DISPOSE BAKED TERRAIN *************************/
+
+static void DisposeBakedTerrain(void)
+{
+	if (gBakedTerrainData)
+	{
+		DisposePtr(gBakedTerrainData);
+		gBakedTerrainData = nil;
+	}
+
+	gBakedSuperTiles = nil;
+}
+
+
+/************ SHRINK SUPERTILE TEXTURE MAP ********************/
+//
+// Shrinks a 160x160 src texture to a 128x128 dest texture
+//
+
+static void	ShrinkSuperTileTextureMap(const u_short *srcPtr, u_short *dstPtr)
+{
+	_Static_assert(SUPERTILE_TEXSIZE_SHRUNK == 128, "rewrite this for new supertile texmap size!");
+	_Static_assert(SUPERTILE_SIZE * OREOMAP_TILE_SIZE == 160, "rewrite this for new oreomap tile size!");
+
+	for (int y = 0; y < 128; y++)
+	{
+		for (int x = 0; x < 128; x += 4)					// shrink a block of 5 pixels from src into 4 pixels in dst
+		{
+			u_short c1 = srcPtr[3];							// get colors to average
+			u_short c2 = srcPtr[4];
+			u_short r = ((c1>>10) + (c2>>10))>>1;			// compute average
+			u_short g = (((c1>>5)&0x1f) + ((c2>>5)&0x1f))>>1;
+			u_short b = ((c1&0x1f) + (c2&0x1f)) >> 1;
+
+			dstPtr[0] = srcPtr[0];							// save #0
+			dstPtr[1] = srcPtr[1];							// save #1
+			dstPtr[2] = srcPtr[2];							// save #2
+			dstPtr[3] = (r<<10)|(g<<5)|b;					// save #3 as average of #3 and #4
+
+			dstPtr += 4;
+			srcPtr += 5;
+		}
+
+		if (y % 4 == 3)							// skip every 4th line
+			srcPtr +=  SUPERTILE_SIZE * OREOMAP_TILE_SIZE;
+	}
+}
+
+
+#if 0	// Unused in this version of Bugdom
+/************ SHRINK SUPERTILE TEXTURE MAP TO 64 ********************/
+//
+// Shrinks a 160x160 src texture to a 64x64 dest texture
+//
+// Source port note: unused in this version of Bugdom.
+// Simplified the function, but didn't test it.
+
+static void	ShrinkSuperTileTextureMapTo64(u_short *srcPtr, u_short *dstPtr)
+{
+	_Static_assert(SUPERTILE_SIZE * OREOMAP_TILE_SIZE == 160, "rewrite this for new oreomap tile size!");
+
+	for (int y = 0; y < 64; y++)
+	{
+		for (int x = 0; x < 64; x += 2)					// shrink a block of 5 pixels from src into 2 pixels in dst
+		{
+			dstPtr[0] = srcPtr[0];
+			dstPtr[1] = srcPtr[2];
+			dstPtr += 2;
+			srcPtr += 5;
+		}
+
+		srcPtr += SUPERTILE_SIZE * OREOMAP_TILE_SIZE;	// skip every other line in src
+
+		if (y % 2 == 0)									// skip another line
+			srcPtr += SUPERTILE_SIZE * OREOMAP_TILE_SIZE;
+	}
+}
+#endif
+
+
+/************ SHRINK SQUARE TEXTURE TO HALF SIZE ******************/
+//
+// 2x2 box filter for 1-5-5-5 pixels. Alpha is dropped.
+// Does 8 output pixels at a time with SSE2/NEON, and the leftovers with ShrinkHalf_Scalar.
+//
+
+static void ShrinkHalf(const uint16_t* input, uint16_t* output, int outputSize)
+{
+	const int inputWidth = outputSize * 2;
+	int simdWidth = 0;
+
+#if SIMD4_SSE2 || SIMD4_NEON
+	simdWidth = outputSize & ~7;
+
+	for (int y = 0; y < outputSize; y++)
+	{
+		const uint16_t* line = input + (2 * y) * inputWidth;
+		const uint16_t* nextLine = line + inputWidth;
+		uint16_t* out = output + y * outputSize;
+
+		for (int x = 0; x < simdWidth; x += 8)
+		{
+	#if SIMD4_SSE2
+			const __m128i mask = _mm_set1_epi16(0x1f);
+			const __m128i ones = _mm_set1_epi16(1);
+
+			__m128i a0 = _mm_loadu_si128((const __m128i*) (line + 2*x));		// 16 pixels from this line...
+			__m128i a1 = _mm_loadu_si128((const __m128i*) (line + 2*x + 8));
+			__m128i b0 = _mm_loadu_si128((const __m128i*) (nextLine + 2*x));	// ...and 16 from the next
+			__m128i b1 = _mm_loadu_si128((const __m128i*) (nextLine + 2*x + 8));
+
+			// Sum each channel vertically, then add up horizontal pairs (madd) and pack back to 16 bits
+			#define SHRINK_CHANNEL(shift)															\
+				_mm_srli_epi16(_mm_packs_epi32(														\
+					_mm_madd_epi16(_mm_add_epi16(_mm_and_si128(_mm_srli_epi16(a0, shift), mask),	\
+												 _mm_and_si128(_mm_srli_epi16(b0, shift), mask)), ones),	\
+					_mm_madd_epi16(_mm_add_epi16(_mm_and_si128(_mm_srli_epi16(a1, shift), mask),	\
+												 _mm_and_si128(_mm_srli_epi16(b1, shift), mask)), ones)),	\
+					2)
+
+			__m128i r = SHRINK_CHANNEL(10);
+			__m128i g = SHRINK_CHANNEL(5);
+			__m128i b = SHRINK_CHANNEL(0);
+			#undef SHRINK_CHANNEL
+
+			__m128i pixels = _mm_or_si128(_mm_slli_epi16(r, 10), _mm_or_si128(_mm_slli_epi16(g, 5), b));
+			_mm_storeu_si128((__m128i*) (out + x), pixels);
+	#elif SIMD4_NEON
+			const uint16x8_t mask = vdupq_n_u16(0x1f);
+
+			uint16x8x2_t a = vld2q_u16(line + 2*x);								// even & odd pixels from this line...
+			uint16x8x2_t b = vld2q_u16(nextLine + 2*x);							// ...and from the next
+
+			#define SHRINK_CHANNEL(shift)									\
+				vshrq_n_u16(vaddq_u16(										\
+					vaddq_u16(vandq_u16(vshrq_n_u16(a.val[0], shift), mask),	\
+							  vandq_u16(vshrq_n_u16(a.val[1], shift), mask)),	\
+					vaddq_u16(vandq_u16(vshrq_n_u16(b.val[0], shift), mask),	\
+							  vandq_u16(vshrq_n_u16(b.val[1], shift), mask))),	\
+					2)
+
+			uint16x8_t r = SHRINK_CHANNEL(10);
+			uint16x8_t g = SHRINK_CHANNEL(5);
+			uint16x8_t bl = vshrq_n_u16(vaddq_u16(
+					vaddq_u16(vandq_u16(a.val[0], mask), vandq_u16(a.val[1], mask)),
+					vaddq_u16(vandq_u16(b.val[0], mask), vandq_u16(b.val[1], mask))),
+					2);															// (vshrq_n_u16 can't shift by 0)
+			#undef SHRINK_CHANNEL
+
+			vst1q_u16(out + x, vorrq_u16(vshlq_n_u16(r, 10), vorrq_u16(vshlq_n_u16(g, 5), bl)));
+	#endif
+		}
+	}
+#endif
+
+	if (simdWidth < outputSize)											// do the leftover columns
+	{
+		ShrinkHalf_Scalar(input + 2*simdWidth, output + simdWidth, inputWidth, outputSize, outputSize - simdWidth, outputSize);
+	}
+}
+
+
+/************ SHRINK HALF: SCALAR ******************/
+//
+// Reference version of ShrinkHalf, one pixel at a time.
+// Shrinks a (numCols*2) x (numRows*2) block of the input.
+//
+
+static void ShrinkHalf_Scalar(const uint16_t* input, uint16_t* output, int inputWidth, int outputWidth, int numCols, int numRows)
+{
+	for (int y = 0; y < numRows; y++)
+	{
+		const uint16_t* line = input + (2 * y) * inputWidth;
+		const uint16_t* nextLine = line + inputWidth;
+		uint16_t* out = output + y * outputWidth;
+
+		for (int x = 0; x < numCols; x++)
+		{
+			uint16_t	r,g,b;
+			uint16_t	pixel;
+
+			pixel = *line++;							// get a pixel
+			r = (pixel >> 10) & 0x1f;
+			g = (pixel >> 5) & 0x1f;
+			b = pixel & 0x1f;
+
+			pixel = *line++;							// get next pixel
+			r += (pixel >> 10) & 0x1f;
+			g += (pixel >> 5) & 0x1f;
+			b += pixel & 0x1f;
+
+
+			pixel = *nextLine++;						// get a pixel from next line
+			r += (pixel >> 10) & 0x1f;
+			g += (pixel >> 5) & 0x1f;
+			b += pixel & 0x1f;
+
+			pixel = *nextLine++;						// get next pixel from next line
+			r += (pixel >> 10) & 0x1f;
+			g += (pixel >> 5) & 0x1f;
+			b += pixel & 0x1f;
+
+			r >>= 2;									// calc average
+			g >>= 2;
+			b >>= 2;
+
+			*out++ = (r<<10) | (g<<5) | b;				// save new pixel
+		}
+	}
+}
+
+
+#if _DEBUG
+/************ CHECK SHRINK HALF ******************/
+//
+// Makes sure the SIMD ShrinkHalf is bit-exact with the scalar version,
+// on random pixels (including the alpha bit) and on sizes that don't fill a whole vector.
+//
+
+static void CheckShrinkHalf(void)
+{
+	static const int kOutputSizes[] = { SUPERTILE_TEXSIZE_SHRUNK/2, SUPERTILE_TEXSIZE_SHRUNK/4, 13, 8, 3, 1 };
+	const int maxOutputSize = SUPERTILE_TEXSIZE_SHRUNK/2;
+
+	uint16_t* input		= (uint16_t*) AllocPtr(4 * maxOutputSize * maxOutputSize * sizeof(uint16_t));
+	uint16_t* expected	= (uint16_t*) AllocPtr(maxOutputSize * maxOutputSize * sizeof(uint16_t));
+	uint16_t* actual	= (uint16_t*) AllocPtr(maxOutputSize * maxOutputSize * sizeof(uint16_t));
+	GAME_ASSERT(input && expected && actual);
+
+	uint32_t seed = 0x1555;
+
+	for (int i = 0; i < (int) (sizeof(kOutputSizes) / sizeof(kOutputSizes[0])); i++)
+	{
+		int size = kOutputSizes[i];
+
+		for (int j = 0; j < 4 * size * size; j++)
+		{
+			seed = seed * 1664525u + 1013904223u;						// LCG, so as not to disturb the game's RNG
+			input[j] = (uint16_t) (seed >> 16);
+		}
+
+		ShrinkHalf_Scalar(input, expected, 2 * size, size, size, size);
+		ShrinkHalf(input, actual, size);
+
+		GAME_ASSERT_MESSAGE(0 == memcmp(expected, actual, size * size * sizeof(uint16_t)),
+				"ShrinkHalf doesn't match ShrinkHalf_Scalar!");
+	}
+
+	DisposePtr((Ptr) input);
+	DisposePtr((Ptr) expected);
+	DisposePtr((Ptr) actual);
+}
+#endif
+
+
+/******************* RELEASE SUPERTILE OBJECT *******************/
+//
+// Deactivates the terrain object and releases its memory block
+//
+
+static inline void ReleaseSuperTileObject(int32_t superTileNum)
+{
+	GAME_ASSERT(superTileNum >= 0);
+	GAME_ASSERT(superTileNum < gSupertileBudget);
+
+	if (gSuperTileMemoryList[superTileNum].mode != SUPERTILE_MODE_FREE)
+	{
+		gSuperTileMemoryList[superTileNum].mode = SUPERTILE_MODE_FREE;		// it's free!
+		gNumFreeSupertiles++;
+	}
+
+	GAME_ASSERT(gNumFreeSupertiles <= gSupertileBudget);
+}
+
+/******************** RELEASE ALL SUPERTILES ************************/
+
+static inline void ReleaseAllSuperTiles(void)
+{
+	WaitForSuperTileBuilder();
+
+	for (int32_t i = 0; i < gSupertileBudget; i++)
+		ReleaseSuperTileObject(i);
+
+	GAME_ASSERT(gNumFreeSupertiles == gSupertileBudget);
+}
+
+#pragma mark -
+
+/******************** START SUPERTILE BUILDER ************************/
+//
+// Supertiles about to scroll on are cooked ahead of time by a background thread,
+// so that scrolling only costs a texture upload on the main thread.
+//
+// If the thread can't be started, supertiles are simply built on demand as before.
+//
+
+static void StartSuperTileBuilder(void)
+{
+	if (gSuperTileBuilderRunning)
+		return;
+
+	gSuperTileJobMutex = SDL_CreateMutex();
+	gSuperTileJobQueuedCond = SDL_CreateCond();
+	gSuperTileJobDoneCond = SDL_CreateCond();
+
+	if (!gSuperTileJobMutex || !gSuperTileJobQueuedCond || !gSuperTileJobDoneCond)
+	{
+		printf("Couldn't create supertile builder sync objects: %s\n", SDL_GetError());
+		DisposeSuperTileBuilder();
+		return;
+	}
+
+	gBuilderThreadScratch.textureBuffer = (uint16_t*) AllocPtr(SUPERTILE_TEXSIZE_MAX * SUPERTILE_TEXSIZE_MAX * sizeof(uint16_t));
+	GAME_ASSERT(gBuilderThreadScratch.textureBuffer);
+
+	SDL_Thread* thread = SDL_CreateThread(SuperTileBuilderThread, "SuperTileBuilder", NULL);
+	if (!thread)
+	{
+		printf("Couldn't start supertile builder thread: %s\n", SDL_GetError());
+		DisposeSuperTileBuilder();
+		return;
+	}
+
+	SDL_DetachThread(thread);										// lives until the app quits
+	gSuperTileBuilderRunning = true;
+}
+
+
+/******************** DISPOSE SUPERTILE BUILDER ************************/
+//
+// Undoes a StartSuperTileBuilder that couldn't finish, so that we're back to building on demand.
+// Never call this once the thread is running.
+//
+
+static void DisposeSuperTileBuilder(void)
+{
+	GAME_ASSERT(!gSuperTileBuilderRunning);
+
+	if (gBuilderThreadScratch.textureBuffer)
+	{
+		DisposePtr((Ptr) gBuilderThreadScratch.textureBuffer);
+		gBuilderThreadScratch.textureBuffer = nil;
+	}
+
+	if (gSuperTileJobDoneCond)
+	{
+		SDL_DestroyCond(gSuperTileJobDoneCond);
+		gSuperTileJobDoneCond = nil;
+	}
+
+	if (gSuperTileJobQueuedCond)
+	{
+		SDL_DestroyCond(gSuperTileJobQueuedCond);
+		gSuperTileJobQueuedCond = nil;
+	}
+
+	if (gSuperTileJobMutex)
+	{
+		SDL_DestroyMutex(gSuperTileJobMutex);
+		gSuperTileJobMutex = nil;
+	}
+}
+
+
+/******************** SUPERTILE BUILDER THREAD ************************/
+
+static int SDLCALL SuperTileBuilderThread(void *unused)
+{
+	(void) unused;
+
+	while (1)
+	{
+				/* WAIT FOR A JOB */
 
-				/* FLIP X ROT 1 */
-				/* FLIP Y ROT 3 */
+		SDL_LockMutex(gSuperTileJobMutex);
 
-		case	TILE_FLIPX_MASK | TILE_ROT1:
-		case	TILE_FLIPY_MASK | TILE_ROT3:
-				buffer += (tileSize-1);
-				for (int y = 0; y < tileSize; y++)
-				{
-					for (int x = 0; x < tileSize; x++)
-						buffer[bufWidth*(tileSize-1-x)] = tileData[x];		// backwards
+		while (gNumQueuedSuperTileJobs == 0)
+			SDL_CondWait(gSuperTileJobQueuedCond, gSuperTileJobMutex);
 
-					buffer--;								// prev col in dest
-					tileData += tileSize;					// next line in src
-				}
-				break;
+		SuperTileJobType job = gSuperTileJobQueue[gSuperTileJobQueueHead];
+		gSuperTileJobQueueHead = (gSuperTileJobQueueHead + 1) % MAX_SUPERTILES;
+		gNumQueuedSuperTileJobs--;
 
-				/* FLIP X ROT 3 */
-				/* FLIP Y ROT 1 */
+		SDL_UnlockMutex(gSuperTileJobMutex);
 
-		case	TILE_FLIPX_MASK | TILE_ROT3:
-		case	TILE_FLIPY_MASK | TILE_ROT1:
-				for (int y = 0; y < tileSize; y++)			// draw to right col from top row of src
-				{
-					for (int x = 0; x < tileSize; x++)
-						buffer[bufWidth*x] = tileData[x];
+				/* BUILD IT */
 
-					buffer++;								// next col in dest
-					tileData += tileSize;					// next line in src
-				}
-				break;
+		SuperTileMemoryType* superTilePtr = &gSuperTileMemoryList[job.superTileNum];
+		CookSuperTile(superTilePtr, &job.lighting, &gBuilderThreadScratch);
+
+				/* TELL MAIN THREAD IT'S READY */
+
+		SDL_LockMutex(gSuperTileJobMutex);
+		gTileCacheTilesDrawn += gBuilderThreadScratch.numTilesDrawn;
+		gTileCacheAssemblyTicks += gBuilderThreadScratch.assemblyTicks;
+		superTilePtr->prefetchDone = true;
+		gNumPendingSuperTileJobs--;
+		SDL_CondBroadcast(gSuperTileJobDoneCond);
+		SDL_UnlockMutex(gSuperTileJobMutex);
 	}
+
+	return 0;
 }
 
 
-/************ SHRINK SUPERTILE TEXTURE MAP ********************/
+/******************** WAIT FOR SUPERTILE BUILDER ************************/
 //
-// Shrinks a 160x160 src texture to a 128x128 dest texture
+// Blocks until the builder thread has finished all the jobs we gave it.
 //
 
-static void	ShrinkSuperTileTextureMap(const u_short *srcPtr, u_short *dstPtr)
+static void WaitForSuperTileBuilder(void)
 {
-	_Static_assert(SUPERTILE_TEXSIZE_SHRUNK == 128, "rewrite this for new supertile texmap size!");
-	_Static_assert(SUPERTILE_SIZE * OREOMAP_TILE_SIZE == 160, "rewrite this for new oreomap tile size!");
+	if (!gSuperTileBuilderRunning)
+		return;
 
-	for (int y = 0; y < 128; y++)
+	SDL_LockMutex(gSuperTileJobMutex);
+	while (gNumPendingSuperTileJobs > 0)
+		SDL_CondWait(gSuperTileJobDoneCond, gSuperTileJobMutex);
+	SDL_UnlockMutex(gSuperTileJobMutex);
+}
+
+
+/******************** QUEUE SUPERTILE PREFETCH ************************/
+//
+// Hands a free supertile to the builder thread.
+// Does nothing if that supertile was already prefetched or if we're out of free supertiles.
+//
+
+static void QueueSuperTilePrefetch(long tileCol, long tileRow)
+{
+	for (int32_t i = 0; i < gSupertileBudget; i++)
 	{
-		for (int x = 0; x < 128; x += 4)					// shrink a block of 5 pixels from src into 4 pixels in dst
+		const SuperTileMemoryType* superTilePtr = &gSuperTileMemoryList[i];
+		if (superTilePtr->mode == SUPERTILE_MODE_PREFETCHED
+			&& superTilePtr->tileCol == tileCol
+			&& superTilePtr->tileRow == tileRow)
 		{
-			u_short c1 = srcPtr[3];							// get colors to average
-			u_short c2 = srcPtr[4];
-			u_short r = ((c1>>10) + (c2>>10))>>1;			// compute average
-			u_short g = (((c1>>5)&0x1f) + ((c2>>5)&0x1f))>>1;
-			u_short b = ((c1&0x1f) + (c2&0x1f)) >> 1;
+			return;
+		}
+	}
 
-			dstPtr[0] = srcPtr[0];							// save #0
-			dstPtr[1] = srcPtr[1];							// save #1
-			dstPtr[2] = srcPtr[2];							// save #2
-			dstPtr[3] = (r<<10)|(g<<5)|b;					// save #3 as average of #3 and #4
+	if (gNumFreeSupertiles <= 0)
+		return;
 
-			dstPtr += 4;
-			srcPtr += 5;
-		}
+	int32_t superTileNum = GetFreeSuperTileMemory();
+	SuperTileMemoryType* superTilePtr = &gSuperTileMemoryList[superTileNum];
 
-		if (y % 4 == 3)							// skip every 4th line
-			srcPtr +=  SUPERTILE_SIZE * OREOMAP_TILE_SIZE;
-	}
+	superTilePtr->mode = SUPERTILE_MODE_PREFETCHED;
+	superTilePtr->tileCol = tileCol;
+	superTilePtr->tileRow = tileRow;
+
+	SuperTileJobType job;
+	job.superTileNum = superTileNum;
+	GetSuperTileLighting(&job.lighting);
+
+	SDL_LockMutex(gSuperTileJobMutex);
+
+	GAME_ASSERT(gNumQueuedSuperTileJobs < MAX_SUPERTILES);
+	gSuperTileJobQueue[(gSuperTileJobQueueHead + gNumQueuedSuperTileJobs) % MAX_SUPERTILES] = job;
+	gNumQueuedSuperTileJobs++;
+	gNumPendingSuperTileJobs++;
+	superTilePtr->prefetchDone = false;
+
+	SDL_CondSignal(gSuperTileJobQueuedCond);
+	SDL_UnlockMutex(gSuperTileJobMutex);
 }
 
 
-#if 0	// Unused in this version of Bugdom
-/************ SHRINK SUPERTILE TEXTURE MAP TO 64 ********************/
+/******************** CLAIM PREFETCHED SUPERTILE ************************/
 //
-// Shrinks a 160x160 src texture to a 64x64 dest texture
+// If the builder thread was given the supertile at tileCol/tileRow,
+// waits for it to be done and marks it as used.
+//
+// OUTPUT: index into gSuperTileMemoryList, or -1 if it wasn't prefetched
 //
-// Source port note: unused in this version of Bugdom.
-// Simplified the function, but didn't test it.
 
-static void	ShrinkSuperTileTextureMapTo64(u_short *srcPtr, u_short *dstPtr)
+static int32_t ClaimPrefetchedSuperTile(long tileCol, long tileRow)
 {
-	_Static_assert(SUPERTILE_SIZE * OREOMAP_TILE_SIZE == 160, "rewrite this for new oreomap tile size!");
+	if (!gSuperTileBuilderRunning)
+		return -1;
 
-	for (int y = 0; y < 64; y++)
+	for (int32_t i = 0; i < gSupertileBudget; i++)
 	{
-		for (int x = 0; x < 64; x += 2)					// shrink a block of 5 pixels from src into 2 pixels in dst
+		SuperTileMemoryType* superTilePtr = &gSuperTileMemoryList[i];
+
+		if (superTilePtr->mode != SUPERTILE_MODE_PREFETCHED
+			|| superTilePtr->tileCol != tileCol
+			|| superTilePtr->tileRow != tileRow)
 		{
-			dstPtr[0] = srcPtr[0];
-			dstPtr[1] = srcPtr[2];
-			dstPtr += 2;
-			srcPtr += 5;
+			continue;
 		}
 
-		srcPtr += SUPERTILE_SIZE * OREOMAP_TILE_SIZE;	// skip every other line in src
+		SDL_LockMutex(gSuperTileJobMutex);
+		while (!superTilePtr->prefetchDone)
+			SDL_CondWait(gSuperTileJobDoneCond, gSuperTileJobMutex);
+		SDL_UnlockMutex(gSuperTileJobMutex);
 
-		if (y % 2 == 0)									// skip another line
-			srcPtr += SUPERTILE_SIZE * OREOMAP_TILE_SIZE;
+		superTilePtr->mode = SUPERTILE_MODE_USED;
+		return i;
 	}
+
+	return -1;
 }
-#endif
 
 
-/************ SHRINK SQUARE TEXTURE TO HALF SIZE ******************/
+/******************** PREFETCH SUPERTILE ************************/
+//
+// Queues up the supertile at superRow/superCol for the builder thread, unless it's off the map
+// or already there. If we're out of free supertiles, makes room by recycling a finished
+// prefetch that isn't on the leading row or column anymore.
+//
 
-static void ShrinkHalf(const uint16_t* input, uint16_t* output, int outputSize)
+static Boolean IsOnPrefetchEdge(const SuperTileMemoryType* superTilePtr)
 {
-	int inputWidth = outputSize * 2;
-	const uint16_t* nextLine = input + inputWidth;
-
-	for (int y = 0; y < outputSize; y++)
-	{
-		for (int x = 0; x < outputSize; x++)
-		{
-			uint16_t	r,g,b;
-			uint16_t	pixel;
-
-			pixel = *input++;							// get a pixel
-			r = (pixel >> 10) & 0x1f;
-			g = (pixel >> 5) & 0x1f;
-			b = pixel & 0x1f;
-
-			pixel = *input++;							// get next pixel
-			r += (pixel >> 10) & 0x1f;
-			g += (pixel >> 5) & 0x1f;
-			b += pixel & 0x1f;
+	return (superTilePtr->tileRow == gPrefetchRow * SUPERTILE_SIZE)
+		|| (superTilePtr->tileCol == gPrefetchCol * SUPERTILE_SIZE);
+}
 
+static void PrefetchSuperTile(long superRow, long superCol)
+{
+	if (superRow < 0 || superRow >= gNumSuperTilesDeep || superCol < 0 || superCol >= gNumSuperTilesWide)	// check if off map
+		return;
 
-			pixel = *nextLine++;						// get a pixel from next line
-			r += (pixel >> 10) & 0x1f;
-			g += (pixel >> 5) & 0x1f;
-			b += pixel & 0x1f;
+	if (gTerrainScrollBuffer[superRow][superCol] != EMPTY_SUPERTILE)		// already there
+		return;
 
-			pixel = *nextLine++;						// get next pixel from next line
-			r += (pixel >> 10) & 0x1f;
-			g += (pixel >> 5) & 0x1f;
-			b += pixel & 0x1f;
+	if (superCol * SUPERTILE_SIZE >= gTerrainTileWidth)
+		return;
 
-			r >>= 2;									// calc average
-			g >>= 2;
-			b >>= 2;
+	if (gNumFreeSupertiles <= 0)
+	{
+		SDL_LockMutex(gSuperTileJobMutex);
+		for (int32_t i = 0; i < gSupertileBudget; i++)
+		{
+			const SuperTileMemoryType* superTilePtr = &gSuperTileMemoryList[i];
 
-			*output++ = (r<<10) | (g<<5) | b;			// save new pixel
+			if (superTilePtr->mode == SUPERTILE_MODE_PREFETCHED
+				&& superTilePtr->prefetchDone
+				&& !IsOnPrefetchEdge(superTilePtr))
+			{
+				ReleaseSuperTileObject(i);
+				break;
+			}
 		}
-		input += inputWidth;							// skip a line
-		nextLine += inputWidth;
+		SDL_UnlockMutex(gSuperTileJobMutex);
 	}
-}
 
+	QueueSuperTilePrefetch(superCol * SUPERTILE_SIZE, superRow * SUPERTILE_SIZE);
+}
 
 
-/******************* RELEASE SUPERTILE OBJECT *******************/
+/******************** PREFETCH SUPERTILES ************************/
 //
-// Deactivates the terrain object and releases its memory block
+// Guesses which row and column of supertiles will scroll on next
+// from the direction the scroll window is moving in, and queues them up for the builder thread.
+//
+// Each axis remembers the last way it moved, so that moving diagonally or along a single axis
+// keeps both leading edges prefetched. Finished prefetches are only recycled once they've
+// scrolled out of range (or when a leading edge needs the room).
+//
+// INPUT: x,y = world coords of the scroll window's far left corner this frame
 //
 
-static inline void ReleaseSuperTileObject(int32_t superTileNum)
+static void PrefetchSuperTiles(long x, long y)
 {
-	GAME_ASSERT(superTileNum >= 0);
-	GAME_ASSERT(superTileNum < gSupertileBudget);
+long	dx,dy;
 
-	if (gSuperTileMemoryList[superTileNum].mode != SUPERTILE_MODE_FREE)
+	if (!gSuperTileBuilderRunning || gDisableHiccupTimer)
+		return;
+
+	dx = x - gPrefetchPrevX;
+	dy = y - gPrefetchPrevY;
+	gPrefetchPrevX = x;
+	gPrefetchPrevY = y;
+
+	if (dx != 0)
+		gPrefetchDirX = (dx > 0) ? 1 : -1;
+	if (dy != 0)
+		gPrefetchDirY = (dy > 0) ? 1 : -1;
+
+	if (gPrefetchDirX == 0 && gPrefetchDirY == 0)					// haven't moved yet
+		return;
+
+			/* FIND THE EDGES WE'RE MOVING TOWARD */
+
+	gPrefetchRow = -1;
+	gPrefetchCol = -1;
+
+	if (gPrefetchDirY != 0)
+		gPrefetchRow = (gPrefetchDirY > 0) ? gCurrentSuperTileRow + SUPERTILE_DIST_DEEP : gCurrentSuperTileRow - 1;
+	if (gPrefetchDirX != 0)
+		gPrefetchCol = (gPrefetchDirX > 0) ? gCurrentSuperTileCol + SUPERTILE_DIST_WIDE : gCurrentSuperTileCol - 1;
+
+			/* RECYCLE FINISHED PREFETCHES THAT HAVE SCROLLED OUT OF RANGE */
+			//
+			// (i.e. that aren't in the ring of supertiles right around the scroll window)
+			//
+
+	SDL_LockMutex(gSuperTileJobMutex);
+	for (int32_t i = 0; i < gSupertileBudget; i++)
 	{
-		gSuperTileMemoryList[superTileNum].mode = SUPERTILE_MODE_FREE;		// it's free!
-		gNumFreeSupertiles++;
+		const SuperTileMemoryType* superTilePtr = &gSuperTileMemoryList[i];
+
+		if (superTilePtr->mode != SUPERTILE_MODE_PREFETCHED || !superTilePtr->prefetchDone)
+			continue;
+
+		long superRow = superTilePtr->tileRow / SUPERTILE_SIZE;
+		long superCol = superTilePtr->tileCol / SUPERTILE_SIZE;
+
+		if (superRow < gCurrentSuperTileRow - 1 || superRow > gCurrentSuperTileRow + SUPERTILE_DIST_DEEP
+			|| superCol < gCurrentSuperTileCol - 1 || superCol > gCurrentSuperTileCol + SUPERTILE_DIST_WIDE)
+		{
+			ReleaseSuperTileObject(i);
+		}
 	}
+	SDL_UnlockMutex(gSuperTileJobMutex);
 
-	GAME_ASSERT(gNumFreeSupertiles <= gSupertileBudget);
-}
+			/* QUEUE UP THE SUPERTILES ON THOSE EDGES */
 
-/******************** RELEASE ALL SUPERTILES ************************/
+	if (gPrefetchRow >= 0)
+	{
+		for (int i = 0; i < SUPERTILE_DIST_WIDE; i++)
+			PrefetchSuperTile(gPrefetchRow, gCurrentSuperTileCol + i);
+	}
 
-static inline void ReleaseAllSuperTiles(void)
-{
-	for (int32_t i = 0; i < gSupertileBudget; i++)
-		ReleaseSuperTileObject(i);
+	if (gPrefetchCol >= 0)
+	{
+		for (int i = 0; i < SUPERTILE_DIST_DEEP; i++)
+			PrefetchSuperTile(gCurrentSuperTileRow + i, gPrefetchCol);
+	}
 
-	GAME_ASSERT(gNumFreeSupertiles == gSupertileBudget);
+	if (gPrefetchRow >= 0 && gPrefetchCol >= 0)						// corner that comes on when moving diagonally
+		PrefetchSuperTile(gPrefetchRow, gPrefetchCol);
 }
 
 #pragma mark -
@@ -1401,6 +2961,8 @@ void DrawTerrain(const QD3DSetupOutputType *setupInfo)
 {
 	int numLayers = gDoCeiling? 2: 1;
 
+	Profiler_BeginZone(PROFILER_ZONE_DRAW_TERRAIN);
+
 		/* GET CURRENT CAMERA COORD */
 		
 	TQ3Point3D cameraCoord = setupInfo->currentCameraCoords;
@@ -1511,6 +3073,8 @@ void DrawTerrain(const QD3DSetupOutputType *setupInfo)
 		Render_SubmitMesh(gPauseQuad, NULL, &kDefaultRenderMods_UI, &kQ3Point3D_Zero);
 	Render_FlushQueue();
 	Render_Exit2D();
+
+	Profiler_EndZone(PROFILER_ZONE_DRAW_TERRAIN);
 }
 
 
@@ -1526,8 +3090,8 @@ void DrawTerrain(const QD3DSetupOutputType *setupInfo)
 float	GetTerrainHeightAtCoord(float x, float z, long layer)
 {
 TQ3PlaneEquation	planeEq;
-int					row,col;
-TQ3Point3D			p[4];
+const TQ3PlaneEquation	*planePtr;
+int					row,col,triangle;
 float				xi,zi;
 
 	if (!gFloorMap)														// make sure there's a terrain
@@ -1548,9 +3112,109 @@ float				xi,zi;
 				
 	xi = x - (col * TERRAIN_POLYGON_SIZE);								// calc x/z offset into the tile
 	zi = z - (row * TERRAIN_POLYGON_SIZE);
-				
-				
-				
+
+
+			/* SEE WHICH TRIANGLE WE'RE ON */
+
+	if (gMapInfoMatrix[row][col].splitMode[layer] == SPLIT_BACKWARD)	// if \ split
+		triangle = (xi < zi) ? 0 : 1;
+	else																// otherwise, / split
+		triangle = ((TERRAIN_POLYGON_SIZE-xi) > zi) ? 0 : 1;
+
+
+			/* GET ITS PLANE EQUATION */
+
+	if (gTerrainPlanes[layer])
+		planePtr = &gTerrainPlanes[layer][(row * gTerrainTileWidth + col) * 2 + triangle];
+	else
+	{
+		CalcTerrainTilePlane(layer, row, col, triangle, &planeEq);
+		planePtr = &planeEq;
+	}
+
+	gRecentTerrainNormal[layer] = planePtr->normal;						// remember the normal here
+
+	return (IntersectionOfYAndPlane(x,z,planePtr));						// calc intersection
+}
+
+
+/***************** GET TERRAIN HEIGHTS AT COORDS ******************/
+//
+// Batched version of GetTerrainHeightAtCoord for particle systems & the like.
+// Returns the same heights, but doesn't touch gRecentTerrainNormal:
+// pass an outNormals array (or nil) to get the normal under each point instead.
+//
+
+void GetTerrainHeightsAtCoords(const float *x, const float *z, float *outY, TQ3Vector3D *outNormals, int count, long layer)
+{
+static const TQ3Vector3D	up = {0, 1, 0};
+TQ3PlaneEquation			planeEq;
+const TQ3PlaneEquation		*layerPlanes;
+
+	if (!gFloorMap || (layer == CEILING && !gDoCeiling))
+	{
+		float y = gFloorMap ? 10000000 : 0;								// same as GetTerrainHeightAtCoord
+		for (int i = 0; i < count; i++)
+		{
+			outY[i] = y;
+			if (outNormals)
+				outNormals[i] = up;
+		}
+		return;
+	}
+
+	layerPlanes = gTerrainPlanes[layer];
+
+	for (int i = 0; i < count; i++)
+	{
+		const TQ3PlaneEquation* planePtr;
+		float px = x[i];
+		float pz = z[i];
+		int col = px * TERRAIN_POLYGON_SIZE_Frac;
+		int row = pz * TERRAIN_POLYGON_SIZE_Frac;
+
+		if ((col < 0) || (col >= gTerrainTileWidth) || (row < 0) || (row >= gTerrainTileDepth))
+		{
+			outY[i] = 0;
+			if (outNormals)
+				outNormals[i] = up;
+			continue;
+		}
+
+		float xi = px - (col * TERRAIN_POLYGON_SIZE);
+		float zi = pz - (row * TERRAIN_POLYGON_SIZE);
+		int triangle;
+
+		if (gMapInfoMatrix[row][col].splitMode[layer] == SPLIT_BACKWARD)
+			triangle = (xi < zi) ? 0 : 1;
+		else
+			triangle = ((TERRAIN_POLYGON_SIZE-xi) > zi) ? 0 : 1;
+
+		if (layerPlanes)
+			planePtr = &layerPlanes[(row * gTerrainTileWidth + col) * 2 + triangle];
+		else
+		{
+			CalcTerrainTilePlane(layer, row, col, triangle, &planeEq);
+			planePtr = &planeEq;
+		}
+
+		outY[i] = IntersectionOfYAndPlane(px, pz, planePtr);
+		if (outNormals)
+			outNormals[i] = planePtr->normal;
+	}
+}
+
+
+/***************** CALC TERRAIN TILE PLANE ******************/
+//
+// Calculates the plane equation of one of a tile's two triangles.
+// Triangle 0 is the left one, 1 is the right one, per the tile's split mode.
+//
+
+static void CalcTerrainTilePlane(long layer, int row, int col, int triangle, TQ3PlaneEquation *planeEq)
+{
+TQ3Point3D			p[4];
+
 					/* BUILD VERTICES FOR THE 4 CORNERS OF THE TILE */
 				
 	p[0].x = col * TERRAIN_POLYGON_SIZE;								// far left
@@ -1579,42 +3243,81 @@ float				xi,zi;
 	{
 		if (layer == 0)
 		{
-			if (xi < zi)														// which triangle are we on?
-				CalcPlaneEquationOfTriangle(&planeEq, &p[0], &p[2],&p[3]);		// calc plane equation for left triangle
+			if (triangle == 0)
+				CalcPlaneEquationOfTriangle(planeEq, &p[0], &p[2],&p[3]);		// calc plane equation for left triangle
 			else
-				CalcPlaneEquationOfTriangle(&planeEq, &p[0], &p[1], &p[2]);		// calc plane equation for right triangle
+				CalcPlaneEquationOfTriangle(planeEq, &p[0], &p[1], &p[2]);		// calc plane equation for right triangle
 		}
 		else																	// clockwise for ceiling
 		{
-			if (xi < zi)														// which triangle are we on?
-				CalcPlaneEquationOfTriangle(&planeEq, &p[3], &p[2], &p[0]);		// calc plane equation for left triangle
+			if (triangle == 0)
+				CalcPlaneEquationOfTriangle(planeEq, &p[3], &p[2], &p[0]);		// calc plane equation for left triangle
 			else
-				CalcPlaneEquationOfTriangle(&planeEq, &p[2], &p[1], &p[0]);		// calc plane equation for right triangle
+				CalcPlaneEquationOfTriangle(planeEq, &p[2], &p[1], &p[0]);		// calc plane equation for right triangle
 		}
 	}
 	else																		// otherwise, / split
 	{
-		xi = TERRAIN_POLYGON_SIZE-xi;											// flip x
 		if (layer == 0)
 		{	
-			if (xi > zi)
-				CalcPlaneEquationOfTriangle(&planeEq, &p[0], &p[1], &p[3]);		// calc plane equation for left triangle
+			if (triangle == 0)
+				CalcPlaneEquationOfTriangle(planeEq, &p[0], &p[1], &p[3]);		// calc plane equation for left triangle
 			else
-				CalcPlaneEquationOfTriangle(&planeEq, &p[1], &p[2], &p[3]);		// calc plane equation for right triangle
+				CalcPlaneEquationOfTriangle(planeEq, &p[1], &p[2], &p[3]);		// calc plane equation for right triangle
 		}
 		else																	// clockwise for ceiling
 		{			
-			if (xi > zi)
-				CalcPlaneEquationOfTriangle(&planeEq, &p[3], &p[1], &p[0]);		// calc plane equation for left triangle
+			if (triangle == 0)
+				CalcPlaneEquationOfTriangle(planeEq, &p[3], &p[1], &p[0]);		// calc plane equation for left triangle
 			else
-				CalcPlaneEquationOfTriangle(&planeEq, &p[3], &p[2], &p[1]);		// calc plane equation for right triangle
+				CalcPlaneEquationOfTriangle(planeEq, &p[3], &p[2], &p[1]);		// calc plane equation for right triangle
 		}
-			
-	}			
+	}
+}
+
+
+/***************** BUILD TERRAIN PLANE CACHE ******************/
+//
+// Called after the split mode matrix has been calculated.
+//
+
+void BuildTerrainPlaneCache(void)
+{
+int		numLayers = gDoCeiling ? 2 : 1;
+
+	DisposeTerrainPlaneCache();
+
+	for (int layer = 0; layer < numLayers; layer++)
+	{
+		gTerrainPlanes[layer] = (TQ3PlaneEquation*) AllocPtr(gTerrainTileDepth * gTerrainTileWidth * 2 * sizeof(TQ3PlaneEquation));
+		GAME_ASSERT(gTerrainPlanes[layer]);
+
+		TQ3PlaneEquation* planePtr = gTerrainPlanes[layer];
+
+		for (int row = 0; row < gTerrainTileDepth; row++)
+		{
+			for (int col = 0; col < gTerrainTileWidth; col++)
+			{
+				CalcTerrainTilePlane(layer, row, col, 0, planePtr++);
+				CalcTerrainTilePlane(layer, row, col, 1, planePtr++);
+			}
+		}
+	}
+}
+
 
-	gRecentTerrainNormal[layer] = planeEq.normal;								// remember the normal here
+/***************** DISPOSE TERRAIN PLANE CACHE ******************/
 
-	return (IntersectionOfYAndPlane(x,z,&planeEq));								// calc intersection
+void DisposeTerrainPlaneCache(void)
+{
+	for (int layer = 0; layer < MAX_LAYERS; layer++)
+	{
+		if (gTerrainPlanes[layer])
+		{
+			DisposePtr((Ptr) gTerrainPlanes[layer]);
+			gTerrainPlanes[layer] = nil;
+		}
+	}
 }
 
 
@@ -1723,6 +3426,7 @@ TQ3Vector2D	look;
 
 	CalcNewItemDeleteWindow();							// recalc item delete window
 
+	PrefetchSuperTiles(x, y);							// get the builder thread started on what's coming up next
 }
 
 
@@ -420,10 +420,10 @@ TQ3Matrix4x4	*m,m2;
 
 void CalcTileNormals(long layer, long row, long col, TQ3Vector3D *n1, TQ3Vector3D *n2)
 {
-static TQ3Point3D	p1 = {0,0,0};
-static TQ3Point3D	p2 = {TERRAIN_POLYGON_SIZE,0,0};
-static TQ3Point3D	p3 = {TERRAIN_POLYGON_SIZE,0,TERRAIN_POLYGON_SIZE};
-static TQ3Point3D	p4 = {0, 0, TERRAIN_POLYGON_SIZE};
+TQ3Point3D	p1 = {0,0,0};								// not static: the supertile builder thread calls this too
+TQ3Point3D	p2 = {TERRAIN_POLYGON_SIZE,0,0};
+TQ3Point3D	p3 = {TERRAIN_POLYGON_SIZE,0,TERRAIN_POLYGON_SIZE};
+TQ3Point3D	p4 = {0, 0, TERRAIN_POLYGON_SIZE};
 
 
 		/* MAKE SURE ROW/COL IS IN RANGE */